@@ -37,8 +37,7 @@ namespace ve {
 
 		for (int i = 0; i < num_cubes; ++i) {
 			glmvec3 cube_anchor = (bodies[i]->m_positionW + init_pos) * 0.5_real;
-			auto constraint = std::make_shared<VPEWorld::FixedJoint>(centerBody, bodies[i], cube_anchor); // Choosing the second cube as the anchor point should increase stiffness
-			m_physics->addConstraint(constraint);
+			m_physics->addConstraint(VPEWorld::FixedJoint{ centerBody, bodies[i], cube_anchor }); // Choosing the second cube as the anchor point should increase stiffness
 		}
 
 		return centerBody;
@@ -60,8 +59,7 @@ namespace ve {
 			auto body = createAndAddCube(glmvec3{ 1.0_real }, positionCamera, glmquat(1, 0, 0, 0), cubeMass, !(i == 0 || i == 9));
 
 			if (i > 0) {
-				auto constraint = std::make_shared<VPEWorld::DistanceConstraint>(body, prevBody, 2.3_real);
-				m_physics->addConstraint(constraint);
+				m_physics->addConstraint(VPEWorld::DistanceConstraint{ body, prevBody, 2.3_real });
 			}
 
 			prevBody = body;
@@ -84,8 +82,8 @@ namespace ve {
 		auto body1 = createAndAddCube(glmvec3{ 1.0_real }, cubePos1, glmquat{ 1, 0, 0, 0 }, 0.0_real, false);
 		auto body2 = createAndAddCube(glmvec3{ 1.0_real }, cubePos2, glmquat{ 1, 0, 0, 0 }, 1.0_real / 100.0_real, true);
 
-		auto constraint = std::make_shared<VPEWorld::HingeJoint>(body1, body2, jointAnchor, jointAxis);
-		constraint->enableLimit(-pi2/3.0_real, pi2/3.0_real);
+		VPEWorld::HingeJoint constraint{ body1, body2, jointAnchor, jointAxis };
+		constraint.enableLimit(-pi2/3.0_real, pi2/3.0_real);
 		m_physics->addConstraint(constraint);
 	}
 
@@ -102,8 +100,7 @@ namespace ve {
 		auto body1 = createAndAddCube(glmvec3{ 1.0_real }, cubePos1, glmquat{ 1, 0, 0, 0 }, 0.0_real, false);
 		auto body2 = createAndAddCube(glmvec3{ 1.0_real }, cubePos2, glmquat{ 1, 0, 0, 0 }, 1.0_real / 100.0_real, true);
 
-		auto constraint = std::make_shared<VPEWorld::BallSocketJoint>(body1, body2, jointAnchor);
-		m_physics->addConstraint(constraint);
+		m_physics->addConstraint(VPEWorld::BallSocketJoint{ body1, body2, jointAnchor });
 	}
 
 	void ConstraintDemos::wheel() {
@@ -124,25 +121,26 @@ namespace ve {
 		real constexpr motor_max_force = 30.0_real;
 
 		glmvec3 jointAxis{ 0.0_real, 0.0_real, 1.0_real };
-		auto constraint1 = std::make_shared<VPEWorld::HingeJoint>(centerBody, center1, centerPos, jointAxis);
-		m_physics->addConstraint(constraint1);
-		constraint1->enableMotor(motor_speed, motor_max_force);
-		constraint1->setBody1MotorEnabled(false);
+		VPEWorld::HingeJoint constraint1{ centerBody, center1, centerPos, jointAxis };
+		constraint1.enableMotor(motor_speed, motor_max_force);
+		constraint1.setBody1MotorEnabled(false);
+		auto handle1 = m_physics->addConstraint(constraint1);
 
-		auto constraint2 = std::make_shared<VPEWorld::HingeJoint>(centerBody, center2, centerPos, jointAxis);
-		m_physics->addConstraint(constraint2);
-		constraint2->enableMotor(motor_speed, motor_max_force);
-		constraint2->setBody1MotorEnabled(false);
+		VPEWorld::HingeJoint constraint2{ centerBody, center2, centerPos, jointAxis };
+		constraint2.enableMotor(motor_speed, motor_max_force);
+		constraint2.setBody1MotorEnabled(false);
+		auto handle2 = m_physics->addConstraint(constraint2);
 
+		auto physics = m_physics;
 		// We capture copies here, otherwise this stuff will be undefined when the function terminates and it goes out of scope
-		std::thread flipMotorThread([constraint1, constraint2, motor_speed, motor_max_force]() {
+		std::thread flipMotorThread([physics, handle1, handle2, motor_speed, motor_max_force]() {
 			int sign = 1;
 
 			while (true) {
 				std::this_thread::sleep_for(std::chrono::milliseconds(10000));
 				sign *= -1;
-				constraint1->enableMotor(sign * motor_speed, motor_max_force);
-				constraint2->enableMotor(sign * motor_speed, motor_max_force);
+				if (auto* constraint1 = physics->getConstraint<VPEWorld::HingeJoint>(handle1)) constraint1->enableMotor(sign * motor_speed, motor_max_force);
+				if (auto* constraint2 = physics->getConstraint<VPEWorld::HingeJoint>(handle2)) constraint2->enableMotor(sign * motor_speed, motor_max_force);
 			}
 			});
 
@@ -163,8 +161,7 @@ namespace ve {
 		auto body1 = createAndAddCube(glmvec3{ 1.0_real }, cubePos1, glmquat{ 1, 0, 0, 0 }, 1.0_real / 100.0_real, true);
 		auto body2 = createAndAddCube(glmvec3{ 1.0_real }, cubePos2, glmquat{ 1, 0, 0, 0 }, 1.0_real / 100.0_real, true);
 
-		auto constraint = std::make_shared<VPEWorld::FixedJoint>(body1, body2, jointAnchor);
-		m_physics->addConstraint(constraint);
+		m_physics->addConstraint(VPEWorld::FixedJoint{ body1, body2, jointAnchor });
 	}
 
 	void ConstraintDemos::sliderCannon() {
@@ -193,13 +190,13 @@ namespace ve {
 		stackPos[1] += 1.0_real;
 
 		glmvec3 jointAxis{ 0.0_real, 1.0_real, 1.0_real };
-		auto constraint = std::make_shared<VPEWorld::SliderJoint>(body1, body2, jointAnchor, jointAxis);
-		m_physics->addConstraint(constraint);
-		constraint->enableLimit(-1, 10);
+		VPEWorld::SliderJoint constraint{ body1, body2, jointAnchor, jointAxis };
+		constraint.enableLimit(-1, 10);
+		auto handle = m_physics->addConstraint(constraint);
 
 		auto physics = m_physics;
 		// We capture copies here, otherwise this stuff will be undefined when the function terminates and it goes out of scope
-		std::thread motorThread([this, constraint, stackPos, physics]() {
+		std::thread motorThread([this, handle, stackPos, physics]() {
 			auto stackPosLeft = stackPos; stackPosLeft[0] -= 2;
 			auto stackPosRight = stackPos; stackPosRight[0] += 2;
 
@@ -213,17 +210,15 @@ namespace ve {
 				auto stackLeft = createAndAddCube(glmvec3{ 1.0_real }, stackPosLeft, glmquat{ 1, 0, 0, 0 }, 6.0_real / 100.0_real, true);
 				auto stackRight = createAndAddCube(glmvec3{ 1.0_real }, stackPosRight, glmquat{ 1, 0, 0, 0 }, 6.0_real / 100.0_real, true);
 
-				auto constraint1 = std::make_shared<VPEWorld::FixedJoint>(stackCenter, stackLeft, (stackPos + stackPosLeft) * 0.5_real);
-				auto constraint2 = std::make_shared<VPEWorld::FixedJoint>(stackCenter, stackRight, (stackPos + stackPosRight) * 0.5_real);
-				m_physics->addConstraint(constraint1);
-				m_physics->addConstraint(constraint2);
+				m_physics->addConstraint(VPEWorld::FixedJoint{ stackCenter, stackLeft, (stackPos + stackPosLeft) * 0.5_real });
+				m_physics->addConstraint(VPEWorld::FixedJoint{ stackCenter, stackRight, (stackPos + stackPosRight) * 0.5_real });
 				*/
 
 				std::this_thread::sleep_for(std::chrono::milliseconds(700));
-				constraint->enableMotor(5000, 100000);
+				if (auto* constraint = physics->getConstraint<VPEWorld::SliderJoint>(handle)) constraint->enableMotor(5000, 100000);
 				// Disabling the motor does not remove the velocity (neither does hitting the limit point), so go backwards here
 				std::this_thread::sleep_for(std::chrono::milliseconds(400));
-				constraint->enableMotor(-200, 5000);;
+				if (auto* constraint = physics->getConstraint<VPEWorld::SliderJoint>(handle)) constraint->enableMotor(-200, 5000);
 			}
 		});
 
@@ -251,21 +246,21 @@ namespace ve {
 			pos[2] += 1.5_real;
 		}
 
-		std::shared_ptr<VPEWorld::HingeJoint> mainConstraint;
+		VPEWorld::ConstraintHandle mainConstraint;
 		glmvec3 hinge_axis(1, 0, 0);
 		for (int i = 1; i < num_cubes; ++i) {
 			auto body1 = bodies[i - 1];
 			auto body2 = bodies[i];
 			glmvec3 position = body1->m_positionW;
-			auto constraint = std::make_shared<VPEWorld::HingeJoint>(body1, body2, position, hinge_axis);
-			if (i == 1) mainConstraint = constraint;
-			m_physics->addConstraint(constraint);
+			auto handle = m_physics->addConstraint(VPEWorld::HingeJoint{ body1, body2, position, hinge_axis });
+			if (i == 1) mainConstraint = handle;
 		}
 
-		std::thread enableMotorThread([mainConstraint]() {
+		auto physics = m_physics;
+		std::thread enableMotorThread([physics, mainConstraint]() {
 			while (true) {
 				std::this_thread::sleep_for(std::chrono::milliseconds(10000));
-				mainConstraint->enableMotor(7.0_real, 25.0_real);
+				if (auto* constraint = physics->getConstraint<VPEWorld::HingeJoint>(mainConstraint)) constraint->enableMotor(7.0_real, 25.0_real);
 			}
 			});
 
@@ -285,8 +280,8 @@ namespace ve {
 		auto body2 = createAndAddCube(glmvec3{ 1.0_real }, cubePos2, glmquat{ 1, 0, 0, 0 }, 1.0_real / 100.0_real, true);
 
 		glmvec3 jointAxis{ 0.0_real, 0.0_real, 1.0_real };
-		auto constraint = std::make_shared<VPEWorld::SliderJoint>(body1, body2, jointAnchor, jointAxis);
-		constraint->enableLimit(-3.0_real, 15.0_real);
+		VPEWorld::SliderJoint constraint{ body1, body2, jointAnchor, jointAxis };
+		constraint.enableLimit(-3.0_real, 15.0_real);
 		m_physics->addConstraint(constraint);
 	}
 
@@ -314,19 +309,14 @@ namespace ve {
 		cubePos = centerPos; cubePos[1] += 0.9_real;
 		auto head = createAndAddCube(glmvec3{ 0.6_real, 0.6_real, 0.4_real }, cubePos, glmquat{ 1, 0, 0, 0 }, 3.0_real / 100.0_real, true, 0.2_real);
 
-		auto torsoHead = std::make_shared<VPEWorld::FixedJoint>(torso, head, head->m_positionW);
-		m_physics->addConstraint(torsoHead);
+		m_physics->addConstraint(VPEWorld::FixedJoint{ torso, head, head->m_positionW });
 
-		auto torsoArm1 = std::make_shared<VPEWorld::BallSocketJoint>(torso, arm1, centerPos + glmvec3(-0.4_real, 0.5_real, 0.0_real));
-		m_physics->addConstraint(torsoArm1);
+		m_physics->addConstraint(VPEWorld::BallSocketJoint{ torso, arm1, centerPos + glmvec3(-0.4_real, 0.5_real, 0.0_real) });
 
-		auto torsoArm2 = std::make_shared<VPEWorld::BallSocketJoint>(torso, arm2, centerPos + glmvec3(0.4_real, 0.5_real, 0.0_real));
-		m_physics->addConstraint(torsoArm2);
+		m_physics->addConstraint(VPEWorld::BallSocketJoint{ torso, arm2, centerPos + glmvec3(0.4_real, 0.5_real, 0.0_real) });
 
-		auto torsoLeg1 = std::make_shared<VPEWorld::BallSocketJoint>(torso, leg1, centerPos + glmvec3(-0.2_real, -0.45_real, 0.0_real));
-		m_physics->addConstraint(torsoLeg1);
+		m_physics->addConstraint(VPEWorld::BallSocketJoint{ torso, leg1, centerPos + glmvec3(-0.2_real, -0.45_real, 0.0_real) });
 
-		auto torsoLeg2 = std::make_shared<VPEWorld::BallSocketJoint>(torso, leg2, centerPos + glmvec3(0.2_real, -0.45_real, 0.0_real));
-		m_physics->addConstraint(torsoLeg2);
+		m_physics->addConstraint(VPEWorld::BallSocketJoint{ torso, leg2, centerPos + glmvec3(0.2_real, -0.45_real, 0.0_real) });
 	}
 }
\ No newline at end of file
@@ -39,13 +39,13 @@ namespace ve {
 
 	/// <summary>
 	/// This callback is used for updating the visual body whenever a physics body moves.
-	/// It is also used for extrapolating the new position between two simulation slots.
+	/// It interpolates the position between the previous and the current simulation slot.
 	/// </summary>
 	inline VPEWorld::callback_move onMove = [&](double dt, std::shared_ptr<VPEWorld::Body> body) {
 		VESceneNode* cube = static_cast<VESceneNode*>(body->m_owner);								// Owner is a pointer to a scene node
-		glmvec3 pos = body->m_positionW;															// New position of the scene node
-		glmquat orient = body->m_orientationLW;														// New orientation of the scende node
-		body->stepPosition(dt, pos, orient, false);													// Extrapolate
+		glmvec3 pos;																				// New position of the scene node
+		glmquat orient;																				// New orientation of the scende node
+		body->interpolate((real)(dt / body->m_physics->m_sim_delta_time), pos, orient);				// Interpolate
 		cube->setTransform(VPEWorld::Body::computeModel(pos, orient, body->m_scale));				// Set the scene node data
 	};
 
@@ -60,13 +60,14 @@ namespace ve {
 	};
 
 	/// <summary>
-	/// This is an example callback that is called if a body collides with another body.
-	/// The first parameter is the body for which this collides was set, the second body
-	/// is the body that collided with it.
+	/// This is an example for reading the contact events of the last tick. Events are only 
+	/// reported for bodies whose m_event_flags have been set.
 	/// </summary>
-	inline VPEWorld::callback_collide onCollide =
-		[](std::shared_ptr<VPEWorld::Body> body1, std::shared_ptr<VPEWorld::Body> body2) {
-		std::cout << "Collision " << body1->m_name << " " << body2->m_name << "\n";
+	inline void onContactEvents(VPEWorld* physics) {
+		for (auto& event : physics->m_contact_events) {
+			if (event.m_type == VPEWorld::CONTACT_EVENT_BEGIN)
+				std::cout << "Collision " << event.m_body_ref->m_name << " " << event.m_body_inc->m_name << "\n";
+		}
 	};
 
 	//--------------------------------Begin-Cloth-Simulation-Stuff----------------------------------
@@ -110,6 +111,7 @@ namespace ve {
 		/// </summary>
 		void onFrameStarted(veEvent event) {
 			m_physics->tick(event.dt);
+			onContactEvents(m_physics);
 		}
 
 		VPEWorld* m_physics;																		//Pointer to the physics world
@@ -425,10 +427,10 @@ namespace ve {
 				}
 				if (nk_button_label(ctx, "Add collider")) {
 					if (m_physics->m_body)
-						m_physics->addCollider(m_physics->m_body, onCollide);
+						m_physics->m_body->m_event_flags = VPEWorld::CONTACT_EVENT_BEGIN;
 				}
 				if (nk_button_label(ctx, "Remove colliders")) {
-					m_physics->clearCollider();
+					for (auto& body : m_physics->m_bodies) body.second->m_event_flags = VPEWorld::CONTACT_EVENT_NONE;
 				}
 
 				real vel = 5.0;
@@ -465,6 +467,9 @@ namespace ve {
 						m_physics->m_body->m_orientationLW;
 
 					m_physics->m_body->updateMatrices();
+					if (m_dx != 0 || m_dy != 0 || m_dz != 0 || m_da != 0 || m_db != 0 || m_dc != 0) {
+						m_physics->wakeBody(m_physics->m_body.get());										// A sleeping body must move again
+					}
 					m_dx = m_dy = m_dz = m_da = m_db = m_dc = 0.0_real;
 				}
 
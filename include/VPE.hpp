@@ -22,6 +22,16 @@
 #include <array>
 #include <map>
 #include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <limits>
+#include <cassert>
+#include <stdexcept>
+#include <numeric>
+#include <span>
+#include <memory_resource>
+#include <thread>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #define GLM_FORCE_LEFT_HANDED
@@ -32,8 +42,9 @@
 #include "glm/gtx/matrix_cross_product.hpp"
 
 
-//If DOUBLE_ACCURACY is defined then computations are done with double accuracy. 
-//If SINGLE_ACCURACY is defined then use single accuracy
+//If DOUBLE_ACCURACY is defined then the default world VPEWorld computes with double accuracy. 
+//If SINGLE_ACCURACY is defined then use single accuracy.
+//Other precisions can be used side by side through BasicVPEWorld<float> and BasicVPEWorld<double>.
 //Time is always in double.
 
 #define VPE_SINGLE_ACCURACY
@@ -43,14 +54,16 @@
 using real = double;
 using int_t = int64_t;
 using uint_t = uint64_t;
-using glmvec2 = glm::dvec2
-using glmvec3 = glm::dvec3
-using glmmat2 = glm::dmat2
-using glmmat3 = glm::dmat3
-using glmvec4 = glm::dvec4
-using glmmat4 = glm::dmat4
-using glmquat = glm::dquat
+using glmvec2 = glm::dvec2;
+using glmvec3 = glm::dvec3;
+using glmmat2 = glm::dmat2;
+using glmmat3 = glm::dmat3;
+using glmvec4 = glm::dvec4;
+using glmmat4 = glm::dmat4;
+using glmquat = glm::dquat;
 const real c_eps = 1.0e-12;
+const real pi = glm::pi<real>();
+const real pi2 = 2.0 * pi;
 #else
 #ifdef VPE_SINGLE_ACCURACY
 using real = float;
@@ -80,15 +93,23 @@ using voidppair_t = std::pair<void*, void*>;	//Pair of void pointers
 
 //Algorithms from namespace geometry, defined below this file
 namespace geometry {
-	void computeBasis(const glmvec3& a, glmvec3& b, glmvec3& c);
-	void SutherlandHodgman(auto& subjectPolygon, auto& clipPolygon, auto& newPolygon);
-	glmvec3 orthoUnitVector(const glmvec3& vec);
+	template<typename T> void computeBasis(const glm::vec<3, T>& a, glm::vec<3, T>& b, glm::vec<3, T>& c);
+	// Feature of a clipped point: the two polygon edges that meet at the point.
+	// Edge i of the subject polygon runs from point i to i+1 and has the label i,
+	// edge j of the clip polygon has the label c_clip_edge + j.
+	struct clip_feature_t {
+		uint16_t m_in;		//edge along which the polygon enters the point
+		uint16_t m_out;		//edge along which the polygon leaves the point
+	};
+	constexpr uint16_t c_clip_edge = 0x8000;
+	void SutherlandHodgman(auto& subjectPolygon, auto& clipPolygon, auto& newPolygon, std::vector<clip_feature_t>& newFeatures);
+	template<typename T> glm::vec<3, T> orthoUnitVector(const glm::vec<3, T>& vec);
 
 	//----------------------------------Cloth-Simulation-Stuff--------------------------------------
 	// by Felix Neumann
 	// Defintion and source below this file
-	real alphaMaxPlusBetaMin(real a, real b);
-	real alphaMaxPlusBetaMedPlusGammaMin(real a, real b, real c);
+	template<typename T> T alphaMaxPlusBetaMin(T a, T b);
+	template<typename T> T alphaMaxPlusBetaMedPlusGammaMin(T a, T b, T c);
 }
 
 
@@ -141,30 +162,35 @@ namespace std {
 	};
 
 	//For outputting vectors/matrices to a string stream
-	inline ostream& operator<<(ostream& os, const glmvec3& v) {
+	template<typename T>
+	inline ostream& operator<<(ostream& os, const glm::vec<3, T>& v) {
 		os << "(" << v.x << ',' << v.y << ',' << v.z << ")";				//output 3D vector
 		return os;
 	}
 
 	//For outputting vectors/matrices to a string stream
-	inline ostream& operator<<(ostream& os, const glmvec2& v) {
+	template<typename T>
+	inline ostream& operator<<(ostream& os, const glm::vec<2, T>& v) {
 		os << "(" << v.x << ',' << v.y << ")";								//output 2D vector
 		return os;
 	}
 
-	inline ostream& operator<<(ostream& os, const glmquat& q) {
+	template<typename T>
+	inline ostream& operator<<(ostream& os, const glm::qua<T>& q) {
 		os << "(" << q.x << ',' << q.y << ',' << q.z << ',' << q.w << ")";	//output quaternion
 		return os;
 	}
 
-	inline ostream& operator<<(ostream& os, const glmmat3& m) {
+	template<typename T>
+	inline ostream& operator<<(ostream& os, const glm::mat<3, 3, T>& m) {
 		os << "(" << m[0][0] << ',' << m[0][1] << ',' << m[0][2] << ")\n";	//Output a 3x3 matrix
 		os << "(" << m[1][0] << ',' << m[1][1] << ',' << m[1][2] << ")\n";
 		os << "(" << m[2][0] << ',' << m[2][1] << ',' << m[2][2] << ")\n";
 		return os;
 	}
 
-	inline ostream& operator<<(ostream& os, const glmmat4& m) {
+	template<typename T>
+	inline ostream& operator<<(ostream& os, const glm::mat<4, 4, T>& m) {
 		os << "(" << m[0][0] << ',' << m[0][1] << ',' << m[0][2] << ',' << m[0][3] << ")\n";	//Output a 4x4 matrix
 		os << "(" << m[1][0] << ',' << m[1][1] << ',' << m[1][2] << ',' << m[1][3] << ")\n";
 		os << "(" << m[2][0] << ',' << m[2][1] << ',' << m[2][2] << ',' << m[2][3] << ")\n";
@@ -172,7 +198,8 @@ namespace std {
 		return os;
 	}
 
-	inline std::string to_string(const glmvec3 v) {
+	template<typename T>
+	inline std::string to_string(const glm::vec<3, T> v) {
 		return std::to_string(v.x) + ", " + std::to_string(v.y) + ", " + std::to_string(v.z);	//Turn vector into a string
 	}
 }
@@ -188,27 +215,27 @@ namespace std {
 //P...point
 //V...vector
 //N...normal vector
-#define ITORP(X) glmvec3{contact.m_body_inc.m_to_other * glmvec4{X, 1.0_real}}
-#define ITORV(X) glmmat3{contact.m_body_inc.m_to_other} * (X)
-#define ITORN(X) contact.m_body_inc.m_to_other_it * (X)
-#define ITORTP(X) glmvec3{face_ref->m_LtoT * contact.m_body_inc.m_to_other * glmvec4{X, 1.0_real}}
-#define ITTOWP(X) glmvec3{contact.m_body_inc.m_body->m_model * face_inc->m_TtoL * glmvec4{X, 1.0_real}}
+#define ITORP(X) contact.m_body_inc.m_to_other.point(X)
+#define ITORV(X) contact.m_body_inc.m_to_other.vector(X)
+#define ITORN(X) contact.m_body_inc.m_to_other.normal(X)
+#define ITORTP(X) face_ref->m_LtoT.point(contact.m_body_inc.m_to_other.point(X))
+#define ITTOWP(X) contact.m_body_inc.m_body->m_model.point(face_inc->m_TtoL.point(X))
 
-#define ITOWP(X) glmvec3{contact.m_body_inc.m_body->m_model * glmvec4{X, 1.0_real}}
+#define ITOWP(X) contact.m_body_inc.m_body->m_model.point(X)
 #define ITOWN(X) contact.m_body_inc.m_body->m_model_it * (X)
 
-#define RTOIP(X) glmvec3{contact.m_body_ref.m_to_other * glmvec4{X, 1.0_real}}
-#define RTOIN(X) contact.m_body_ref.m_to_other_it*(X)
-#define RTOWP(X) glmvec3{contact.m_body_ref.m_body->m_model * glmvec4{X,1.0_real}}
-#define RTOWN(X) contact.m_body_ref.m_body->m_model_it*(X)
-#define RTORTP(X) glmvec3{face_ref->m_LtoT * glmvec4{X, 1.0_real}}
+#define RTOIP(X) contact.m_body_ref.m_to_other.point(X)
+#define RTOIN(X) contact.m_body_ref.m_to_other.normal(X)
+#define RTOWP(X) contact.m_body_ref.m_body->m_model.point(X)
+#define RTOWN(X) glm::normalize(contact.m_body_ref.m_body->m_model.normal(X))
+#define RTORTP(X) face_ref->m_LtoT.point(X)
 
-#define WTOTIP(X) glmvec3{face_inc->m_LtoT * contact.m_body_inc.m_body->m_model_inv * glmvec4{X, 1.0_real} }
-#define WTORN(X)  glmmat3{ contact.m_body_ref.m_body->m_model_inv } * (X)
-#define WTOIN(X)  glmmat3{ contact.m_body_inc.m_body->m_model_inv } * (X)
+#define WTOTIP(X) face_inc->m_LtoT.point(contact.m_body_inc.m_body->m_model_inv.point(X))
+#define WTORN(X)  glm::transpose(contact.m_body_ref.m_body->m_model.m_linear) * (X)
+#define WTOIN(X)  contact.m_body_inc.m_body->m_model_inv.vector(X)
 
-#define RTTORP(X) glmvec3{face_ref->m_TtoL * glmvec4{(X), 1.0_real}}
-#define RTTOWP(X) glmvec3{contact.m_body_ref.m_body->m_model * face_ref->m_TtoL * glmvec4{(X), 1.0_real}}
+#define RTTORP(X) face_ref->m_TtoL.point(X)
+#define RTTOWP(X) contact.m_body_ref.m_body->m_model.point(face_ref->m_TtoL.point(X))
 
 
 //-------------------------------------------------------------------------------------------------------------
@@ -218,16 +245,35 @@ namespace vpe {
 
 	/// <summary>
 	/// This class  implements a simple rigid body physics engine.
+	/// The scalar type T selects the accuracy of the world, so float and double worlds can be used side by side.
 	/// </summary>
-	class VPEWorld {
+	/// <typeparam name="T">Scalar type used for all computations, float or double.</typeparam>
+	template<typename T>
+	class BasicVPEWorld {
 
 	public:
 
+		//--------------------------------------------------------------------------------------------------
+		//types depending on the accuracy of this world
+
+		using real = T;
+		using glmvec2 = glm::vec<2, real>;
+		using glmvec3 = glm::vec<3, real>;
+		using glmvec4 = glm::vec<4, real>;
+		using glmmat2 = glm::mat<2, 2, real>;
+		using glmmat3 = glm::mat<3, 3, real>;
+		using glmmat4 = glm::mat<4, 4, real>;
+		using glmquat = glm::qua<real>;
+
+		static constexpr real c_eps = sizeof(real) > sizeof(float) ? (real)1.0e-12 : (real)1.0e-8;	//Accuracy dependent epsilon
+		static constexpr real pi = glm::pi<real>();
+		static constexpr real pi2 = (real)2.0 * pi;
+
 		//--------------------------------------------------------------------------------------------------
 		//constants
-		const real		c_gravity = -9.81_real;				//Gravity acceleration
-		const double	c_small = 0.01_real;				//A small value
-		const double	c_very_small = c_small / 50.0_real;	//Even smaller value
+		const real		c_gravity = -(real)9.81;				//Gravity acceleration
+		const double	c_small = (real)0.01;				//A small value
+		const double	c_very_small = c_small / (real)50.0;	//Even smaller value
 
 		//--------------------------------------------------------------------------------------------------
 		//Basic geometric objects
@@ -242,6 +288,71 @@ namespace vpe {
 			glmvec3 m_forceW{ 0,0,0 };	//Force vector in world space 
 		};
 
+		/// <summary>
+		/// An affine transform made of a 3x3 linear part and a translation. Since bodies and faces only
+		/// use rotation, scale and translation, the inverse transpose of the linear part (for normal vectors)
+		/// is known in closed form and carried along. This way inverse() and composition never need a 
+		/// generic matrix inverse, and applying the transform costs a 3x3 product instead of a 4x4 product.
+		/// </summary>
+		struct Transform {
+			glmmat3 m_linear{ (real)1.0 };		//linear part (rotation and scale)
+			glmmat3 m_normal{ (real)1.0 };		//inverse transpose of linear part, for normal vectors
+			glmvec3 m_translation{ (real)0.0 };	//translation
+
+			/// <summary>
+			/// Create a transform that first scales, then rotates, then translates.
+			/// </summary>
+			/// <param name="pos">Translation.</param>
+			/// <param name="orient">Rotation.</param>
+			/// <param name="scale">Scale along the local axes, must not be zero.</param>
+			/// <returns>The transform.</returns>
+			static Transform fromTRS(const glmvec3& pos, const glmquat& orient, const glmvec3& scale) {
+				glmmat3 rot3{ glm::mat3_cast(orient) };
+				glmvec3 scale_inv = (real)1.0 / scale;
+				return { glmmat3{ rot3[0] * scale.x, rot3[1] * scale.y, rot3[2] * scale.z }
+					, glmmat3{ rot3[0] * scale_inv.x, rot3[1] * scale_inv.y, rot3[2] * scale_inv.z }, pos };
+			}
+
+			/// <summary>
+			/// Create a transform from an orthonormal basis and an origin.
+			/// </summary>
+			/// <param name="basis">Orthonormal basis.</param>
+			/// <param name="origin">Translation.</param>
+			/// <returns>The transform.</returns>
+			static Transform fromBasis(const glmmat3& basis, const glmvec3& origin) {
+				return { basis, basis, origin };
+			}
+
+			/// <summary>
+			/// Closed form inverse, no generic matrix inverse is needed.
+			/// </summary>
+			/// <returns>The inverse transform.</returns>
+			Transform inverse() const {
+				glmmat3 linear_inv = glm::transpose(m_normal);
+				return { linear_inv, glm::transpose(m_linear), -(linear_inv * m_translation) };
+			}
+
+			/// <summary>
+			/// Composition, the result first applies other, then this transform.
+			/// </summary>
+			Transform operator*(const Transform& other) const {
+				return { m_linear * other.m_linear, m_normal * other.m_normal, m_linear * other.m_translation + m_translation };
+			}
+
+			glmvec3 point(const glmvec3& p) const { return m_linear * p + m_translation; }	//transform a point
+			glmvec3 vector(const glmvec3& v) const { return m_linear * v; }					//transform a direction vector
+			glmvec3 normal(const glmvec3& n) const { return m_normal * n; }					//transform a normal vector (not normalized)
+
+			/// <summary>
+			/// Get the transform as 4x4 matrix, e.g. for handing it to a render engine.
+			/// </summary>
+			glmmat4 matrix() const {
+				glmmat4 result{ m_linear };
+				result[3] = glmvec4{ m_translation, (real)1.0 };
+				return result;
+			}
+		};
+
 		struct Face;
 		struct Edge;
 
@@ -273,7 +384,7 @@ namespace vpe {
 		/// </summary>
 		struct signed_edge_t {
 			uint32_t m_edge_idx;
-			real	 m_factor{ 1.0_real };
+			real	 m_factor{ (real)1.0 };
 		};
 
 		/// <summary>
@@ -291,8 +402,8 @@ namespace vpe {
 			std::vector<glmvec2>	m_face_vertex2D_T{};	//vertex 2D coordinates in tangent space
 			std::vector<SignedEdge>	m_face_edge_ptrs{};			//pointers to the edges of this face and orientation factors
 			glmvec3					m_normalL{};				//normal vector in local space
-			glmmat4					m_LtoT;						//local to face tangent space
-			glmmat4					m_TtoL;						//face tangent to local space
+			Transform				m_LtoT;						//local to face tangent space
+			Transform				m_TtoL;						//face tangent to local space
 		};
 
 		/// <summary>
@@ -301,19 +412,40 @@ namespace vpe {
 		/// are interested into the true values. To decide this you can specify a function 
 		/// for cvalculating this.
 		/// </summary>
-		/// <typeparam name="T">C++ class holding alist of faces. Can be face or edge.</typeparam>
+		/// <typeparam name="C">C++ class holding alist of faces. Can be face or edge.</typeparam>
 		/// <param name="dirL">Direction of vector in local space</param>
 		/// <param name="faces">A vector of pointers to faces.</param>
 		/// <param name="fct">Can either be f(x)=x (default) or f(x)=fabs(x).</param>
 		/// <returns></returns>
-		template<typename T>
-		Face* maxFaceAlignment(const glmvec3 dirL, const T& faces, real(*fct)(real) = [](real x) { return x; }) {
+		template<typename C>
+		Face* maxFaceAlignment(const glmvec3 dirL, const C& faces, real(*fct)(real) = [](real x) { return x; }) {
 			assert(faces.size() > 0);
 			auto compare = [&](Face* a, Face* b) { return fct(glm::dot(dirL, a->m_normalL)) < fct(glm::dot(dirL, b->m_normalL)); };
 			return *std::ranges::max_element(faces, compare);
 		}
 
-		struct Collider {};		//Base class for all classes that can collide
+		/// <summary>
+		/// Type of the shape of a collider. The narrow phase selects the collision function by the shape types of both bodies.
+		/// </summary>
+		enum shape_t : uint32_t {
+			SHAPE_POLYTOPE,		//Convex polyhedron, collides with SAT
+			SHAPE_SPHERE,		//Sphere around the local origin
+			SHAPE_CAPSULE,		//Sphere swept along the local y axis
+			SHAPE_COMPOUND,		//Several child shapes in one rigid body
+			SHAPE_MESH,			//Static triangle mesh, e.g. level geometry
+			SHAPE_NUM			//Number of shape types
+		};
+
+		using inertia_tensor_t = std::function<glmmat3(real, glmvec3&)>;	//computes the inertia tensor from mass and scale
+
+		/// <summary>
+		/// Base class for all classes that can collide.
+		/// </summary>
+		struct Collider {
+			shape_t				m_shape;								//Type of the shape
+			real				m_bounding_sphere_radius{ (real)1.0 };	//Bounding sphere radius for a quick contact test
+			inertia_tensor_t	inertiaTensor;							//Function for computing the inertia tensor of this shape
+		};
 
 		/// <summary>
 		/// A polytope is a convex polyhedron. It consists of faces, made of edges, with each edge connecting two vertices.
@@ -322,11 +454,29 @@ namespace vpe {
 			std::vector<Vertex>	m_vertices{};		//positions of vertices in local space
 			std::vector<Edge>	m_edges{};			//list of edges
 			std::vector<Face>	m_faces{};			//list of faces
+			real				m_volume{ (real)0.0 };			//volume in local space
+			glmvec3				m_center_of_massL{ (real)0.0 };	//center of mass in the coordinates the polytope was built from, see fromFaces()
+
+			/// <summary>
+			/// Algorithm that finds the contact normal between two polytopes. SAT tests all face normals and all
+			/// edge pairs, GJK/EPA only needs support points and is faster for polytopes with many vertices.
+			/// </summary>
+			enum narrow_phase_t : uint32_t {
+				NARROW_PHASE_AUTO,	//Decide by the number of faces and edges, see m_gjk_cost
+				NARROW_PHASE_SAT,	//Separating axis test
+				NARROW_PHASE_GJK	//GJK distance and EPA penetration depth
+			};
+			narrow_phase_t		m_narrow_phase{ NARROW_PHASE_AUTO };	//GJK is used if one of the two polytopes selects it
 
-			real m_bounding_sphere_radius{ 1.0_real };	//Bounding sphere radius for a quick contact test
+			static constexpr size_t c_lanes = 8;	//face planes are processed in blocks of this size
 
-			using inertia_tensor_t = std::function<glmmat3(real, glmvec3&)>;
-			inertia_tensor_t inertiaTensor;			//Function for computing the inertia tensor of this polytope
+			/// <summary>
+			/// Face planes n*x = d in structure of arrays layout, padded to a multiple of c_lanes with planes 
+			/// that never clip anything. This allows testing many planes at once in SIMD lanes.
+			/// </summary>
+			struct FacePlanes {
+				std::vector<real> m_nx, m_ny, m_nz, m_d;
+			} m_planes;
 
 			/// <summary>
 			/// Constructor for Polytope. Take in a list of vector positions and indices and create the polygon data struct.
@@ -339,14 +489,14 @@ namespace vpe {
 				const std::vector<std::pair<uint_t, uint_t>>&& edgeindices,
 				const std::vector < std::vector<signed_edge_t> >&& face_edge_indices,
 				inertia_tensor_t inertia_tensor)
-				: Collider{}, m_vertices{}, m_edges{}, m_faces{}, inertiaTensor{ inertia_tensor } {
+				: Collider{ SHAPE_POLYTOPE, (real)1.0, inertia_tensor }, m_vertices{}, m_edges{}, m_faces{} {
 
 				//add vertices
 				uint_t id = 0;
 				m_vertices.reserve(vertices.size());
 				std::ranges::for_each(vertices, [&](const glmvec3& v) {
 					m_vertices.emplace_back(id++, v);
-					if (real l = glm::length(v) > m_bounding_sphere_radius) m_bounding_sphere_radius = l;
+					if (real l = glm::length(v); l > this->m_bounding_sphere_radius) this->m_bounding_sphere_radius = l;
 					}
 				);
 
@@ -376,265 +526,1273 @@ namespace vpe {
 						m_edges[edge.m_edge_idx].m_first_vertexL.m_vertex_face_ptrs.insert(&face);	//sets cannot hold duplicates
 						m_edges[edge.m_edge_idx].m_second_vertexL.m_vertex_face_ptrs.insert(&face);
 					}
-					glmvec3 edge0 = m_edges[face_edge_idx[0].m_edge_idx].m_edgeL * face_edge_idx[0].m_factor;
-					glmvec3 edge1 = m_edges[face_edge_idx[1].m_edge_idx].m_edgeL * face_edge_idx[1].m_factor;
-
-					glmvec3 tangent = glm::normalize(edge0);						//tangent space coordinate axes
-					face.m_normalL = glm::normalize(glm::cross(tangent, edge1));	//for clipping this face againts another face
-					glmvec3 bitangent = glm::cross(face.m_normalL, tangent);
-
-					//Transform from local space to tangent space and back
-					face.m_TtoL = glm::translate(glmmat4(1), face.m_face_vertex_ptrs[0]->m_positionL) * glmmat4 { glmmat3{ bitangent, face.m_normalL, tangent } };
-					face.m_LtoT = glm::inverse(face.m_TtoL);
+					updateFace(face);
+				}
+				updatePlanes();
 
-					for (auto& vertex : face.m_face_vertex_ptrs) {	//precompute tangent space coordinates of face's vertices
-						glmvec4 pt = face.m_LtoT * glmvec4{ vertex->m_positionL, 1.0_real };
-						face.m_face_vertex2D_T.emplace_back(pt.x, pt.z);
+				for (auto& face : m_faces) {	//volume as sum of tetrahedra between the origin and a triangle fan of each face
+					auto& fv = face.m_face_vertex_ptrs;
+					for (size_t i = 1; i + 1 < fv.size(); ++i) {
+						m_volume += glm::dot(fv[0]->m_positionL, glm::cross(fv[i]->m_positionL, fv[i + 1]->m_positionL)) / (real)6.0;
 					}
 				}
 			};
-		};
-
-		/// <summary>
-		/// This is the template for each cube. It contains the basic geometric properties of a cube:
-		/// Vertices, edges and faces. We use a left handed space. Edges can have signs, meaning
-		/// their vectors are multiplied with this factor (1 or -1). 
-		/// </summary>
-		inline static Polytope g_cube {
-			{ { -0.5_real,-0.5_real,-0.5_real }, { -0.5_real,-0.5_real,0.5_real }, { -0.5_real,0.5_real,0.5_real }, { -0.5_real,0.5_real,-0.5_real },
-			{ 0.5_real,-0.5_real,0.5_real }, { 0.5_real,-0.5_real,-0.5_real }, { 0.5_real,0.5_real,-0.5_real }, { 0.5_real,0.5_real,0.5_real } },
-			{ {0,1}, {1,2}, {2,3}, {3,0}, {4,5}, {5,6}, {6,7}, {7,4}, {5,0}, {1,4}, {3,6}, {7,2} }, //edges
-			{	{ {0, 1}, {1, 1},  {2, 1}, {3, 1} },	//face 0
-				{ {4, 1}, {5, 1},  {6, 1}, {7, 1} },	//face 1
-				{ {0,-1}, {8,-1},  {4,-1}, {9,-1} },	//face 2
-				{ {2,-1}, {11,-1}, {6,-1}, {10,-1} },	//face 3
-				{ {3,-1}, {10, 1}, {5,-1}, {8, 1} },	//face 4
-				{ {1,-1}, {9, 1},  {7,-1}, {11, 1} }	//face 5
-			},
-			[](real mass, glmvec3& s) { //callback for calculating the inertia tensor of this polytope
-				return mass * glmmat3{ {s.y * s.y + s.z * s.z,0,0}, {0,s.x * s.x + s.z * s.z,0}, {0,0,s.x * s.x + s.y * s.y} } / 12.0_real;
-			}
-		};
-
-		//--------------------------------------------------------------------------------------------------
-		//Physics engine stuff
-
-		class Body;
-		using callback_move = std::function<void(double, std::shared_ptr<Body>)>; //call this function when the body moves
-		using callback_erase = std::function<void(std::shared_ptr<Body>)>; //call this function when the body moves
-		using callback_collide = std::function<void(std::shared_ptr<Body>, std::shared_ptr<Body>)>; //call this function when the body moves
-
-		/// <summary>
-		/// This class implements the basic physics properties of a rigid body.
-		/// </summary>
-		class Body {
-
-		public:
-			VPEWorld* m_physics;			//Pointer to the physics world to access parameters
-			std::string	m_name;							//The name of this body
-
-			//-----------------------------------------------------------------------------
-			//Physics parameters of the body
 
-			void*		m_owner = nullptr;				//pointer to owner of this body, must be unique (owner is called if body moves)
-			Polytope*	m_polytope = nullptr;			//geometric shape
-			glmvec3		m_scale{ 1,1,1 };				//scale factor in local space
-			glmvec3		m_positionW{ 0, 0, 0 };			//current position at time slot in world space
-			glmquat		m_orientationLW{ 1, 0, 0, 0 };	//current orientation at time slot Local -> World
-			glmvec3		m_linear_velocityW{ 0,0,0 };	//linear velocity at time slot in world space
-			glmvec3		m_angular_velocityW{ 0,0,0 };	//angular velocity at time slot in world space
-			callback_move  m_on_move = nullptr;			//called if the body moves
-			callback_erase m_on_erase = nullptr;			//called if the body is erased
-			real		m_mass_inv{ 0 };				//1 over mass
-			real		m_restitution{ 0 };				//coefficient of restitution eps
-			real		m_friction{ 1 };				//coefficient of friction mu
-			uint64_t	m_loop_last_active{ 0 };		//The loop number in which this body was last time active
+			Polytope(const Polytope&) = delete;				//vertices, edges and faces point to each other, a copy would point into the original
+			Polytope& operator=(const Polytope&) = delete;
+			Polytope(Polytope&&) = default;					//moved vectors keep their elements in place, so the pointers stay valid
+			Polytope& operator=(Polytope&&) = default;
 
-			std::unordered_map<uint64_t, Force> m_forces;//forces acting on this body
+			/// <summary>
+			/// Compute the normal vector and the tangent space of a face from its first two edges.
+			/// </summary>
+			/// <param name="face">The face, its edges and vertices must be set.</param>
+			static void updateFace(Face& face) {
+				glmvec3 edge0 = face.m_face_edge_ptrs[0].first->m_edgeL * face.m_face_edge_ptrs[0].second;
+				glmvec3 edge1 = face.m_face_edge_ptrs[1].first->m_edgeL * face.m_face_edge_ptrs[1].second;
+
+				glmvec3 tangent = glm::normalize(edge0);						//tangent space coordinate axes
+				face.m_normalL = glm::normalize(glm::cross(tangent, edge1));	//for clipping this face againts another face
+				glmvec3 bitangent = glm::cross(face.m_normalL, tangent);
+
+				//Transform from local space to tangent space and back
+				face.m_TtoL = Transform::fromBasis(glmmat3{ bitangent, face.m_normalL, tangent }, face.m_face_vertex_ptrs[0]->m_positionL);
+				face.m_LtoT = face.m_TtoL.inverse();
+
+				face.m_face_vertex2D_T.clear();
+				for (auto& vertex : face.m_face_vertex_ptrs) {	//precompute tangent space coordinates of face's vertices
+					glmvec3 pt = face.m_LtoT.point(vertex->m_positionL);
+					face.m_face_vertex2D_T.emplace_back(pt.x, pt.z);
+				}
+			}
 
-			//-----------------------------------------------------------------------------
-			//These members are computed by the class, only change if you know what you are doing
+			/// <summary>
+			/// Compute the face planes for ray casts from the faces.
+			/// </summary>
+			void updatePlanes() {
+				size_t num_planes = (m_faces.size() + c_lanes - 1) / c_lanes * c_lanes;
+				m_planes.m_nx.assign(num_planes, (real)0.0);
+				m_planes.m_ny.assign(num_planes, (real)0.0);
+				m_planes.m_nz.assign(num_planes, (real)0.0);
+				m_planes.m_d.assign(num_planes, (real)1.0);	//padding: 0*x = 1 is parallel to every ray and contains the origin
+				for (size_t i = 0; i < m_faces.size(); ++i) {
+					m_planes.m_nx[i] = m_faces[i].m_normalL.x;
+					m_planes.m_ny[i] = m_faces[i].m_normalL.y;
+					m_planes.m_nz[i] = m_faces[i].m_normalL.z;
+					m_planes.m_d[i] = glm::dot(m_faces[i].m_normalL, m_faces[i].m_face_vertex_ptrs[0]->m_positionL);
+				}
+			}
 
-			glmmat3		m_inertiaL{ 1 };				//computed when the body is created
-			glmmat3		m_inertia_invL{ 1 };			//computed when the body is created
+			/// <summary>
+			/// Create a polytope from planar convex faces, e.g. the faces of an imported convex mesh. Each face is a list of vertex indices,
+			/// counter clockwise seen from outside, so that the cross product of its first two edges points outwards. All vertices must be 
+			/// used by faces. Edges and their orientation factors are derived from the faces. Volume, center of mass and inertia tensor are 
+			/// computed by exact integration over the polyhedron. The vertices are moved so that the center of mass becomes the local origin, 
+			/// and m_center_of_massL keeps it in the input coordinates. So a render mesh made from the same vertices must be offset by -m_center_of_massL.
+			/// The polytope must outlive all bodies using it.
+			/// </summary>
+			/// <param name="vertices">Vertex positions.</param>
+			/// <param name="faces">For each face the vertex indices in counter clockwise order.</param>
+			/// <returns>The new polytope.</returns>
+			static Polytope fromFaces(const std::vector<glmvec3>& vertices, const std::vector<std::vector<uint_t>>& faces) {
+				real volume{ (real)0.0 };
+				glmvec3 moment{ (real)0.0 };		//first moment, volume times center of mass
+				glmmat3 covariance{ (real)0.0 };	//second moment about the origin
+				for (auto& face : faces) {			//sum up signed tetrahedra between the origin and a triangle fan of each face
+					for (size_t i = 1; i + 1 < face.size(); ++i) {
+						const glmvec3& a = vertices[face[0]];
+						const glmvec3& b = vertices[face[i]];
+						const glmvec3& c = vertices[face[i + 1]];
+						real det = glm::dot(a, glm::cross(b, c));	//six times the signed volume
+						glmvec3 sum = a + b + c;
+						volume += det / (real)6.0;
+						moment += det / (real)24.0 * sum;
+						covariance += det / (real)120.0 * (glm::outerProduct(a, a) + glm::outerProduct(b, b) + glm::outerProduct(c, c) + glm::outerProduct(sum, sum));
+					}
+				}
+				assert(volume > (real)0.0);
+				glmvec3 com = moment / volume;
+				covariance = covariance / volume - glm::outerProduct(com, com);	//per unit mass, about the center of mass
 
-			//-----------------------------------------------------------------------------
-			//computed when the body moves
+				auto inertia_tensor = [=](real mass, glmvec3& s) {	//scaling maps x to S*x, so the covariance becomes S*C*S
+					glmmat3 c = glm::diagonal3x3(s) * covariance * glm::diagonal3x3(s);
+					return mass * (glmmat3{ c[0][0] + c[1][1] + c[2][2] } - c);
+				};
 
-			glmmat4		m_model{ glmmat4{1} };			//model matrix at time slots
-			glmmat4		m_model_inv{ glmmat4{1} };		//model inverse matrix at time slots
-			glmmat3		m_model_it;						//orientation inverse transpose for bringing normal vector to world
-			glmmat3		m_inertiaW{ glmmat4{1} };		//inertia tensor in world frame
-			glmmat3		m_inertia_invW{ glmmat4{1} };	//inverse inertia tensor in world frame
-			int_t		m_grid_x{ 0 };					//grid coordinates for broadphase
-			int_t		m_grid_z{ 0 };
-			glmvec3		m_pbias{ 0, 0, 0 };				//extra energy if body overlaps with another body
-			uint32_t	m_num_resting{ 0 };				//number resting contact points 
-			real		m_damping{ 0 };					//damping velocity of resting contact points
+				std::vector<glmvec3> verticesL;
+				verticesL.reserve(vertices.size());
+				for (auto& v : vertices) verticesL.push_back(v - com);
+
+				std::vector<std::pair<uint_t, uint_t>> edges;
+				std::vector<std::vector<signed_edge_t>> face_edges;
+				std::map<std::pair<uint_t, uint_t>, uint32_t> edge_map;	//undirected edge -> edge index
+				for (auto& face : faces) {
+					auto& signed_edges = face_edges.emplace_back();
+					for (size_t i = 0; i < face.size(); ++i) {
+						uint_t a = face[i], b = face[(i + 1) % face.size()];
+						auto [it, inserted] = edge_map.try_emplace({ std::min(a, b), std::max(a, b) }, (uint32_t)edges.size());
+						if (inserted) edges.emplace_back(a, b);	//the first face defines the direction, the second face uses it inverted
+						signed_edges.push_back({ it->second, edges[it->second].first == a ? (real)1.0 : -(real)1.0 });
+					}
+				}
 
-			/// <summary>
-			/// Constructor of class Body. Uses ony default parameters.
-			/// </summary>
-			/// <param name="physics">Pointer to the physics world.</param>
-			Body(VPEWorld* physics) : m_physics{ physics } { m_polytope = &m_physics->g_cube; inertiaTensorL(); updateMatrices(); };
+				Polytope polytope{ verticesL, std::move(edges), std::move(face_edges), inertia_tensor };
+				polytope.m_center_of_massL = com;
+				return polytope;
+			}
 
 			/// <summary>
-			/// Constructor of class Body
+			/// Parameters for cooking a convex hull from a point cloud. Merged faces are moved outwards until they touch the hull, 
+			/// so the cooked polytope always contains all points.
 			/// </summary>
-			/// <param name="physics">Pointer to the physics world.</param>
-			/// <param name="name">Name of the body.</param>
-			/// <param name="owner">Pointer to the owner. The callback knows how to use this pointer.</param>
-			/// <param name="polytope">Pointer to the polytope.</param>
-			/// <param name="scale">3D scaling.</param>
-			/// <param name="positionW">3D position of the body.</param>
-			/// <param name="orientationLW">Body orientation as quaternion.</param>
-			/// <param name="on_move">Callback that is called when the body moves.</param>
-			/// <param name="on_erase">Callback that is called when the body is erased.</param>
-			/// <param name="linear_velocityW">Starting linear velocity.</param>
-			/// <param name="angular_velocityW">Starting angular velovity as axis vector. Length of vector is the speed.</param>
-			/// <param name="mass_inv">1 / mass. If zero, then mass is infinite.</param>
-			/// <param name="restitution">Bounciness, between 0 and 1.</param>
-			/// <param name="friction">Friction coefficient, usually larger than 0.5.</param>
-			Body(VPEWorld* physics, std::string name, void* owner, Polytope* polytope,
-				glmvec3 scale, glmvec3 positionW, glmquat orientationLW = { 1,0,0,0 },
-				glmvec3 linear_velocityW = glmvec3{ 0,0,0 }, glmvec3 angular_velocityW = glmvec3{ 0,0,0 },
-				real mass_inv = 0, real restitution = 0.2_real, real friction = 1) :
-				m_physics{ physics }, m_name{ name }, m_owner{ owner }, m_polytope{ polytope },
-				m_scale{ scale }, m_positionW{ positionW }, m_orientationLW{ orientationLW },
-				m_linear_velocityW{ linear_velocityW }, m_angular_velocityW{ angular_velocityW },
-				m_mass_inv{ mass_inv }, m_restitution{ restitution }, m_friction{ friction } {
-					m_scale *= m_physics->m_collision_margin_factor;
-					inertiaTensorL();
-					updateMatrices();
-					m_loop_last_active = m_physics->m_loop;
+			struct HullDesc {
+				real	m_weld_distance{ (real)0.0 };	//points closer than this are welded into one
+				real	m_merge_angle{ (real)0.0 };		//merge neighboring faces whose normals differ less than this angle (radians), 0 merges only coplanar faces
+				uint_t	m_max_vertices{ 0 };				//vertex budget, 0 means no limit
+				uint_t	m_max_faces{ 0 };					//face budget, 0 means no limit
 			};
 
+			static constexpr real c_max_merge_angle = pi / (real)4.0;	//the merge angle is not raised above this to meet a budget
+
 			/// <summary>
-			/// Attach a force to the body or change it.
+			/// Create a polytope as the convex hull of a point cloud, e.g. the vertices of an imported mesh. Welds close points, runs quickhull, 
+			/// merges coplanar triangles into polygonal faces and drops vertices lying on an edge. If a merge angle is set, or the result is over 
+			/// the vertex or face budget, faces within the merge angle are replaced by a single plane touching the hull, and the hull is rebuilt
+			/// from these planes. The merge angle is raised until the budget is met or c_max_merge_angle is reached, so the budget is a goal,
+			/// not a guarantee. See fromFaces() for mass properties and the center of mass. Throws std::invalid_argument if there are fewer than
+			/// four points, a point is not finite, or the points are too close to a plane or to each other to enclose a volume.
 			/// </summary>
-			/// <param name="id">The force ID.</param>
-			/// <param name="force">The force itself.</param>
-			template<typename F>
-			void setForce(uint64_t id, F&& force) {
-				m_forces[id] = std::forward<F>(force);
+			/// <param name="points">The point cloud.</param>
+			/// <param name="desc">Cooking parameters.</param>
+			/// <returns>The new polytope.</returns>
+			static Polytope fromPointCloud(const std::vector<glmvec3>& points, const HullDesc& desc = {}) {
+				glmvec3 max_abs{ (real)0.0 };
+				for (auto& p : points) max_abs = glm::max(max_abs, glm::abs(p));
+				real eps = (real)3.0 * std::numeric_limits<real>::epsilon() * (max_abs.x + max_abs.y + max_abs.z);	//rounding error of plane distances
+
+				std::vector<glmvec3> welded = desc.m_weld_distance > (real)0.0 ? weld(points, desc.m_weld_distance) : points;
+				auto triangles = quickhull(welded, eps);
+				std::vector<glmvec3> vertices;
+				auto faces = mergeFaces(welded, triangles, (real)4.0 * eps, vertices);
+				if (faces.size() < 4) throw std::invalid_argument("The points of a convex hull must not lie in a plane.");	//thinner than the merge tolerance
+
+				auto overBudget = [&](auto& v, auto& f) {
+					return (desc.m_max_vertices > 0 && v.size() > desc.m_max_vertices) || (desc.m_max_faces > 0 && f.size() > desc.m_max_faces);
+				};
+				if (desc.m_merge_angle <= (real)0.0 && !overBudget(vertices, faces)) return fromFaces(vertices, faces);
+
+				//raise the merge angle until the budget is met, then bisect for the smallest angle meeting it
+				real lo = desc.m_merge_angle;	//largest angle known to miss the budget
+				real hi = (real)0.0;			//smallest angle known to meet the budget, 0 if none yet
+				real angle = desc.m_merge_angle > (real)0.0 ? desc.m_merge_angle : pi / (real)180.0;
+				std::vector<glmvec3> merged_vertices;
+				std::vector<std::vector<uint_t>> merged_faces;
+				for (int i = 0; i < 16 && mergePlanes(welded, triangles, angle, merged_vertices, merged_faces); ++i) {
+					bool met = !overBudget(merged_vertices, merged_faces);
+					if (met || hi == (real)0.0) {	//keep the best result so far
+						vertices = std::move(merged_vertices);
+						faces = std::move(merged_faces);
+					}
+					if (met) hi = angle; else lo = angle;
+					if (hi > (real)0.0 && hi - lo <= (real)0.1 * hi) break;
+					if (hi == (real)0.0 && angle >= c_max_merge_angle) break;
+					angle = hi > (real)0.0 ? (lo + hi) / (real)2.0 : std::min(angle * (real)1.5, c_max_merge_angle);
+				}
+				return fromFaces(vertices, faces);
 			}
 
 			/// <summary>
-			/// Remove a force.
+			/// Weld points that are closer than a given distance. The first point of a cluster is kept. Uses a hash grid with the 
+			/// weld distance as cell size, so only the neighboring cells of a point are searched.
 			/// </summary>
-			/// <param name="id">Force id.</param>
-			void removeForce(uint64_t id) {
-				m_forces.erase(id);
+			/// <param name="points">The point cloud.</param>
+			/// <param name="distance">Weld distance.</param>
+			/// <returns>The welded points.</returns>
+			static std::vector<glmvec3> weld(const std::vector<glmvec3>& points, real distance) {
+				std::unordered_map<uint64_t, std::vector<uint_t>> grid;	//cell -> indices of welded points
+				std::vector<glmvec3> welded;
+				auto key = [](glm::ivec3 c) { return ((uint64_t)(c.x & 0x1FFFFF) << 42) | ((uint64_t)(c.y & 0x1FFFFF) << 21) | (uint64_t)(c.z & 0x1FFFFF); };
+				for (auto& p : points) {
+					glm::ivec3 cell{ glm::floor(p / distance) };
+					bool found = false;
+					for (int dx = -1; dx <= 1 && !found; ++dx) for (int dy = -1; dy <= 1 && !found; ++dy) for (int dz = -1; dz <= 1 && !found; ++dz) {
+						if (auto it = grid.find(key(cell + glm::ivec3{ dx, dy, dz })); it != grid.end()) {
+							found = std::ranges::any_of(it->second, [&](uint_t i) { return glm::distance(welded[i], p) <= distance; });
+						}
+					}
+					if (found) continue;
+					grid[key(cell)].push_back((uint_t)welded.size());
+					welded.push_back(p);
+				}
+				return welded;
 			}
 
+			static uint64_t edgeKey(uint_t a, uint_t b) { return ((uint64_t)a << 32) | (uint64_t)b; }	//key of a directed edge
+
 			/// <summary>
-			/// Euler step for position. Can be used for integration or extrapolation in between time steps.
+			/// Compute the convex hull of a point cloud with the quickhull algorithm. Points closer than eps to the hull are treated as inside.
+			/// Throws std::invalid_argument for degenerate clouds, see fromPointCloud().
 			/// </summary>
-			/// <param name="dt">Delta time step.</param>
-			/// <param name="pos">Current position that is updated.</param>
-			/// <param name="quat">Current orientation that is updated.</param>
-			/// <returns></returns>
-			bool stepPosition(double dt, glmvec3& pos, glmquat& quat, bool use_pbias = true) {
-				bool active = !m_physics->m_deactivate;
-
-				bool dx = fabs(m_linear_velocityW.x) > m_physics->c_small;
-				bool dy = fabs(m_linear_velocityW.y) > -m_physics->m_resting_factor * m_physics->c_gravity * m_physics->m_sim_delta_time;
-				bool dz = fabs(m_linear_velocityW.z) > m_physics->c_small;
-
-				if (dx || dy || dz || m_num_resting < 3) {
-					if (m_physics->m_clamp_position == 1) pos += m_linear_velocityW * (real)dt;
-					active = true;
-				}
-				if (m_physics->m_clamp_position == 0) pos += m_linear_velocityW * (real)dt;
-				pos += m_physics->m_pbias_factor * m_pbias * (real)dt;
-				if (use_pbias) { m_pbias = glmvec3{ 0,0,0 }; }
+			/// <param name="points">The point cloud.</param>
+			/// <param name="eps">Distance tolerance.</param>
+			/// <returns>Hull triangles as point indices, counter clockwise seen from outside.</returns>
+			static std::vector<std::array<uint_t, 3>> quickhull(const std::vector<glmvec3>& points, real eps) {
+				struct HullFace {
+					std::array<uint_t, 3>	m_v;				//point indices
+					glmvec3					m_normal;			//outward normal
+					real					m_d;				//plane is m_normal*x = m_d
+					std::vector<uint_t>		m_outside{};		//points in front of this face that are not yet on the hull
+					bool					m_alive{ true };	//false if replaced by other faces
+					uint_t					m_visit{ 0 };		//last iteration in which the face was found visible
+				};
+				std::vector<HullFace> faces;
+				std::unordered_map<uint64_t, uint_t> edge_face;	//directed edge -> face it belongs to, the twin is the neighbor
+				auto dist = [&](const HullFace& f, uint_t p) { return glm::dot(f.m_normal, points[p]) - f.m_d; };
+				auto addFace = [&](uint_t a, uint_t b, uint_t c) {
+					glmvec3 n = glm::normalize(glm::cross(points[b] - points[a], points[c] - points[a]));
+					std::array<uint_t, 3> v{ a, b, c };
+					for (int e = 0; e < 3; ++e) edge_face[edgeKey(v[e], v[(e + 1) % 3])] = (uint_t)faces.size();
+					faces.push_back({ v, n, glm::dot(n, points[a]) });
+				};
+				auto farthest = [&](auto&& distance) {
+					std::pair<uint_t, real> best{ 0, -(real)1.0 };
+					for (uint_t i = 0; i < points.size(); ++i) if (real d = distance(points[i]); d > best.second) best = { i, d };
+					return best;
+				};
 
-				auto avL = glmmat3{ m_model_inv } *m_angular_velocityW;	//The same for orientation
-				real len = glm::length(avL);
-				if (len > m_physics->c_small) {
-					if (m_physics->m_clamp_position == 1) quat = glm::rotate(quat, len * (real)dt, avL / len);	//Euler step
-					active = true;
+				//initial tetrahedron: the two axis extreme points farthest apart, the point farthest from their line, and the point farthest from that plane
+				if (points.size() < 4) throw std::invalid_argument("A convex hull needs at least four points.");
+				if (!std::ranges::all_of(points, [](const glmvec3& p) { return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z); })) throw std::invalid_argument("The points of a convex hull must be finite.");
+				std::array<uint_t, 6> extremes{};
+				for (uint_t i = 0; i < points.size(); ++i) {
+					for (int k = 0; k < 3; ++k) {
+						if (points[i][k] < points[extremes[2 * k]][k]) extremes[2 * k] = i;
+						if (points[i][k] > points[extremes[2 * k + 1]][k]) extremes[2 * k + 1] = i;
+					}
 				}
-				if (m_physics->m_clamp_position == 0 && len != 0.0_real) quat = glm::rotate(quat, len * (real)dt, avL / len); //Euler step
-
-				if (active) {
-					m_damping = 0.0_real;						//If the body moves then no damping
-					m_loop_last_active = m_physics->m_loop;		//remember that the body is now active
+				uint_t i0 = 0, i1 = 0;
+				for (auto a : extremes) for (auto b : extremes) {
+					if (glm::distance(points[a], points[b]) > glm::distance(points[i0], points[i1])) { i0 = a; i1 = b; }
 				}
-				else {
-					m_damping = std::clamp(m_damping + m_physics->m_damping_incr, 0.0_real, 600.0_real);	//If no motion, increase damping
+				if (glm::distance(points[i0], points[i1]) <= eps) throw std::invalid_argument("The points of a convex hull must not lie in a plane.");
+				glmvec3 dir = glm::normalize(points[i1] - points[i0]);
+				auto [i2, d2] = farthest([&](const glmvec3& p) { return glm::length(glm::cross(p - points[i0], dir)); });
+				if (d2 <= eps) throw std::invalid_argument("The points of a convex hull must not lie in a plane.");
+				glmvec3 n = glm::normalize(glm::cross(points[i1] - points[i0], points[i2] - points[i0]));
+				auto [i3, d3] = farthest([&](const glmvec3& p) { return std::abs(glm::dot(n, p - points[i0])); });
+				if (d3 <= eps) throw std::invalid_argument("The points of a convex hull must not lie in a plane.");
+
+				if (glm::dot(n, points[i3] - points[i0]) > 0) std::swap(i1, i2);	//i3 must be behind the first face
+				addFace(i0, i1, i2);
+				addFace(i0, i3, i1);
+				addFace(i1, i3, i2);
+				addFace(i2, i3, i0);
+				for (uint_t p = 0; p < points.size(); ++p) {
+					for (auto& f : faces) if (dist(f, p) > eps) { f.m_outside.push_back(p); break; }
 				}
 
-				return active;
-			};
+				//add the farthest outside point of each face, new faces are appended and visited later in this loop
+				std::vector<uint_t> visible;
+				std::vector<uint_t> orphans;
+				std::vector<std::pair<uint_t, uint_t>> horizon;
+				for (uint_t fi = 0; fi < faces.size(); ++fi) {
+					if (!faces[fi].m_alive || faces[fi].m_outside.empty()) continue;
+					uint_t eye = *std::ranges::max_element(faces[fi].m_outside, {}, [&](uint_t p) { return dist(faces[fi], p); });
+
+					visible.assign(1, fi);
+					horizon.clear();
+					orphans.clear();
+					faces[fi].m_visit = fi + 1;
+					for (size_t k = 0; k < visible.size(); ++k) {	//flood fill the faces seeing the eye, their border is the horizon
+						std::array<uint_t, 3> v = faces[visible[k]].m_v;
+						for (int e = 0; e < 3; ++e) {
+							auto twin = edge_face.find(edgeKey(v[(e + 1) % 3], v[e]));
+							if (twin == edge_face.end()) throw std::invalid_argument("The points of a convex hull are too close to a plane or to each other.");	//rounding broke the hull
+							uint_t neighbor = twin->second;
+							if (faces[neighbor].m_visit == fi + 1) continue;
+							if (dist(faces[neighbor], eye) > eps) {
+								faces[neighbor].m_visit = fi + 1;
+								visible.push_back(neighbor);
+							}
+							else horizon.emplace_back(v[e], v[(e + 1) % 3]);
+						}
+					}
 
-			/// <summary>
-			/// Euler step for velocity.
-			/// </summary>
-			/// <param name="dt">Delta time step.</param>
-			/// <returns></returns>
-			void stepVelocity(double dt) {
-				glmvec3 sum_accelW{ 0 };	//sum of all accelerations
-				glmvec3 sum_forcesW{ 0 };	//sum of all forces in world coordinates
-				glmvec3 sum_torquesW{ 0 };	//sum of all torques in world coordinates
-				for (auto& force : m_forces) {
-					sum_accelW += force.second.m_accelW;
-					sum_forcesW += glmmat3{ m_model } *force.second.m_forceL + force.second.m_forceW;	//forces in local and world coordinates
-					sum_torquesW += glm::cross(glmmat3{ m_model } *force.second.m_positionL, glmmat3{ m_model } *force.second.m_forceL);
+					for (auto vi : visible) {	//remove the visible faces
+						auto& f = faces[vi];
+						f.m_alive = false;
+						for (int e = 0; e < 3; ++e) edge_face.erase(edgeKey(f.m_v[e], f.m_v[(e + 1) % 3]));
+						for (auto p : f.m_outside) if (p != eye) orphans.push_back(p);
+						f.m_outside = {};
+					}
+
+					uint_t first_new = (uint_t)faces.size();
+					for (auto [a, b] : horizon) addFace(a, b, eye);	//connect the horizon to the eye
+					for (auto p : orphans) {
+						for (uint_t ni = first_new; ni < faces.size(); ++ni) {
+							if (dist(faces[ni], p) > eps) { faces[ni].m_outside.push_back(p); break; }
+						}
+					}
 				}
-				m_linear_velocityW += (real)dt * (m_mass_inv * sum_forcesW + sum_accelW);
-				m_angular_velocityW += (real)dt * (m_inertia_invW * (sum_torquesW - glm::cross(m_angular_velocityW, m_inertiaW * m_angular_velocityW)));
 
-				m_linear_velocityW.x *= 1.0_real / (1.0_real + (real)m_physics->m_sim_delta_time * m_damping);	//apply sideways damping if any
-				m_linear_velocityW.z *= 1.0_real / (1.0_real + (real)m_physics->m_sim_delta_time * m_damping);
-				m_angular_velocityW *= 1.0_real / (1.0_real + (real)m_physics->m_sim_delta_time * m_damping);
+				std::vector<std::array<uint_t, 3>> triangles;
+				for (auto& f : faces) if (f.m_alive) triangles.push_back(f.m_v);
+				return triangles;
 			}
 
 			/// <summary>
-			/// Compute total velocity of object at a certain point.
+			/// Find the neighbors of the triangles of a closed triangle mesh.
 			/// </summary>
-			/// <param name="positionW">Position of interest in world coordinates.</param>
-			/// <returns></returns>
-			glmvec3 totalVelocityW(glmvec3 positionW) {
-				return m_linear_velocityW + glm::cross(m_angular_velocityW, positionW - m_positionW);
+			/// <param name="triangles">Closed triangle mesh with consistent winding.</param>
+			/// <returns>For each triangle and each edge i, from vertex i to vertex i+1, the triangle on the other side.</returns>
+			static std::vector<std::array<uint_t, 3>> triangleNeighbors(const std::vector<std::array<uint_t, 3>>& triangles) {
+				std::unordered_map<uint64_t, uint_t> edge_triangle;	//directed edge -> triangle
+				for (uint_t t = 0; t < triangles.size(); ++t) {
+					for (int e = 0; e < 3; ++e) edge_triangle[edgeKey(triangles[t][e], triangles[t][(e + 1) % 3])] = t;
+				}
+				std::vector<std::array<uint_t, 3>> neighbors(triangles.size());
+				for (uint_t t = 0; t < triangles.size(); ++t) {
+					for (int e = 0; e < 3; ++e) neighbors[t][e] = edge_triangle.at(edgeKey(triangles[t][(e + 1) % 3], triangles[t][e]));
+				}
+				return neighbors;
 			}
 
 			/// <summary>
-			/// Calculate radius of bounding sphere of object.
+			/// Flood fill triangles into groups. A neighbor of a group member joins the group if joins(seed, neighbor) is true, 
+			/// where seed is the first triangle of the group.
 			/// </summary>
-			/// <returns>Bounding sphere radius.</returns>
-			real boundingSphereRadius() {
-				return std::max(m_scale.x, std::max(m_scale.y, m_scale.z)) * m_polytope->m_bounding_sphere_radius;
+			/// <param name="neighbors">Triangle neighbors, see triangleNeighbors().</param>
+			/// <param name="joins">Predicate deciding whether a triangle joins the group of a seed triangle.</param>
+			/// <returns>For each triangle the seed triangle of its group.</returns>
+			static std::vector<uint_t> groupTriangles(const std::vector<std::array<uint_t, 3>>& neighbors, auto&& joins) {
+				constexpr uint_t none = std::numeric_limits<uint_t>::max();
+				std::vector<uint_t> group(neighbors.size(), none);
+				std::vector<uint_t> members;
+				for (uint_t seed = 0; seed < neighbors.size(); ++seed) {
+					if (group[seed] != none) continue;
+					group[seed] = seed;
+					members.assign(1, seed);
+					for (size_t k = 0; k < members.size(); ++k) {
+						for (auto neighbor : neighbors[members[k]]) {
+							if (group[neighbor] == none && joins(seed, neighbor)) {
+								group[neighbor] = seed;
+								members.push_back(neighbor);
+							}
+						}
+					}
+				}
+				return group;
 			}
 
 			/// <summary>
-			/// Calculate mass of object. Is the inverse of the inverse mass. If inverse is 0 then
-			/// return a very large number.
+			/// Rotate a face so that it starts with its largest corner, since the polytope computes the face normal from the first corner.
 			/// </summary>
-			/// <returns>Mass of object.</returns>
-			real mass() {
-				return m_mass_inv <= c_eps ? 1.0_real / (c_eps) : 1.0_real / m_mass_inv;
+			/// <param name="points">Positions the face refers to.</param>
+			/// <param name="face">Vertex indices of the face.</param>
+			static void startAtLargestCorner(const std::vector<glmvec3>& points, std::vector<uint_t>& face) {
+				size_t best = 0;
+				real best_area = -(real)1.0;
+				for (size_t i = 0; i < face.size(); ++i) {
+					const glmvec3& a = points[face[i]];
+					const glmvec3& b = points[face[(i + 1) % face.size()]];
+					const glmvec3& c = points[face[(i + 2) % face.size()]];
+					if (real area = glm::length(glm::cross(b - a, c - b)); area > best_area) { best = i; best_area = area; }
+				}
+				std::ranges::rotate(face, face.begin() + best);
 			}
 
 			/// <summary>
-			/// Calculate inertia tensor and inverse in world coordinates. Only done once at start.
+			/// Merge adjacent hull triangles lying in the plane of a seed triangle into convex polygons, then drop vertices that
+			/// belong to only two faces, since they lie on an edge. Only vertices used by the faces are returned.
 			/// </summary>
-			/// <returns>Inertia tensor in world coordinates.</returns>
-			void inertiaTensorL() {
-				m_inertiaL = m_polytope->inertiaTensor(mass(), m_scale);	//Polytope inertia tensor
-				m_inertia_invL = glm::inverse(m_inertiaL);					//Inverse inertia tensor
+			/// <param name="points">Positions the triangles refer to.</param>
+			/// <param name="triangles">Closed triangle mesh of a convex hull, counter clockwise seen from outside.</param>
+			/// <param name="tolerance">Maximum distance of a merged vertex from the plane of the seed triangle.</param>
+			/// <param name="vertices">Returns the vertex positions the faces refer to.</param>
+			/// <returns>Faces as vertex indices, counter clockwise seen from outside.</returns>
+			static std::vector<std::vector<uint_t>> mergeFaces(const std::vector<glmvec3>& points, const std::vector<std::array<uint_t, 3>>& triangles
+				, real tolerance, std::vector<glmvec3>& vertices) {
+
+				constexpr uint_t none = std::numeric_limits<uint_t>::max();
+				auto neighbors = triangleNeighbors(triangles);
+				auto group = groupTriangles(neighbors, [&](uint_t seed, uint_t t) {
+					auto& s = triangles[seed];
+					glmvec3 n = glm::normalize(glm::cross(points[s[1]] - points[s[0]], points[s[2]] - points[s[0]]));
+					return std::ranges::all_of(triangles[t], [&](uint_t v) { return std::abs(glm::dot(n, points[v] - points[s[0]])) <= tolerance; });
+				});
+				std::vector<std::vector<uint_t>> members(triangles.size());
+				for (uint_t t = 0; t < triangles.size(); ++t) members[group[t]].push_back(t);
+
+				std::vector<std::vector<uint_t>> faces;
+				std::unordered_map<uint_t, uint_t> next;	//boundary of the merged triangles, vertex -> next vertex
+				for (uint_t seed = 0; seed < triangles.size(); ++seed) {
+					if (members[seed].empty()) continue;
+					next.clear();
+					size_t num_boundary = 0;
+					for (auto m : members[seed]) {
+						for (int e = 0; e < 3; ++e) {
+							if (group[neighbors[m][e]] == seed) continue;
+							next[triangles[m][e]] = triangles[m][(e + 1) % 3];
+							++num_boundary;
+						}
+					}
+					if (next.empty()) throw std::invalid_argument("The points of a convex hull must not lie in a plane.");	//all triangles in one plane
+					std::vector<uint_t> loop{ next.begin()->first };
+					while (loop.size() < num_boundary && next.count(loop.back()) > 0 && next[loop.back()] != loop.front()) loop.push_back(next[loop.back()]);
+
+					if (next.size() == num_boundary && loop.size() == num_boundary) faces.push_back(std::move(loop));
+					else for (auto m : members[seed]) faces.push_back({ triangles[m].begin(), triangles[m].end() });	//no simple polygon, keep the triangles
+				}
+
+				std::vector<uint_t> num_faces(points.size(), 0);	//vertices on only two faces lie on an edge
+				for (auto& face : faces) for (auto v : face) ++num_faces[v];
+				for (auto& face : faces) {							//keep them if a sliver face would lose a corner, both faces must agree
+					if (std::ranges::count_if(face, [&](uint_t v) { return num_faces[v] > 2; }) < 3) for (auto v : face) num_faces[v] = none;
+				}
+				for (auto& face : faces) {
+					std::erase_if(face, [&](uint_t v) { return num_faces[v] == 2; });
+					startAtLargestCorner(points, face);
+				}
+
+				std::vector<uint_t> remap(points.size(), none);
+				vertices.clear();
+				for (auto& face : faces) {
+					for (auto& v : face) {
+						if (remap[v] == none) { remap[v] = (uint_t)vertices.size(); vertices.push_back(points[v]); }
+						v = remap[v];
+					}
+				}
+				return faces;
 			}
 
 			/// <summary>
-			/// Compute the model (world) matrix for transforming points from local space to world space.
-			/// Is used to set this in the body callback, thus it is static.
+			/// Rebuild a hull from fewer planes. Neighboring triangles whose normals differ less than the merge angle from a seed triangle 
+			/// are replaced by one plane with their average normal, moved outwards until it touches the hull. The new vertices are the 
+			/// corners of the intersection of these half spaces. They are found by duality: relative to a point inside, each plane n*x = d 
+			/// maps to the point n/d, and each face of the convex hull of these points maps back to a vertex where its planes meet.
+			/// Planes that do not touch the intersection end up inside the dual hull and vanish.
 			/// </summary>
-			/// <param name="pos">Current position.</param>
-			/// <param name="orient">Current orientation.</param>
+			/// <param name="points">Positions the triangles refer to.</param>
+			/// <param name="triangles">Closed triangle mesh of a convex hull, counter clockwise seen from outside.</param>
+			/// <param name="angle">Merge angle in radians.</param>
+			/// <param name="vertices">Returns the vertex positions.</param>
+			/// <param name="faces">Returns the faces as vertex indices, counter clockwise seen from outside.</param>
+			/// <returns>False if the planes do not bound a hull of sensible size, then vertices and faces are invalid.</returns>
+			static bool mergePlanes(const std::vector<glmvec3>& points, const std::vector<std::array<uint_t, 3>>& triangles, real angle
+				, std::vector<glmvec3>& vertices, std::vector<std::vector<uint_t>>& faces) {
+
+				std::vector<glmvec3> normals;	//area weighted triangle normals
+				normals.reserve(triangles.size());
+				for (auto& t : triangles) normals.push_back(glm::cross(points[t[1]] - points[t[0]], points[t[2]] - points[t[0]]));
+				real cos_angle = std::cos(angle);
+				auto group = groupTriangles(triangleNeighbors(triangles), [&](uint_t seed, uint_t t) {
+					return glm::dot(glm::normalize(normals[seed]), glm::normalize(normals[t])) >= cos_angle;
+				});
+
+				std::vector<uint_t> hull;		//indices of the hull vertices
+				std::vector<bool> used(points.size(), false);
+				for (auto& t : triangles) for (auto v : t) if (!used[v]) { used[v] = true; hull.push_back(v); }
+				glmvec3 center{ (real)0.0 };	//a point inside the hull
+				for (auto v : hull) center += points[v];
+				center /= (real)hull.size();
+				real radius{ (real)0.0 };
+				for (auto v : hull) radius = std::max(radius, glm::distance(points[v], center));
+
+				std::map<uint_t, glmvec3> group_normal;	//seed -> sum of area weighted normals
+				for (uint_t t = 0; t < triangles.size(); ++t) group_normal[group[t]] += normals[t];
+				std::vector<glmvec3> dual;				//dual point of each merged plane
+				for (auto& [seed, sum] : group_normal) {
+					glmvec3 n = glm::normalize(sum);
+					real d = (real)0.0;
+					for (auto v : hull) d = std::max(d, glm::dot(n, points[v] - center));	//touch the hull, so that it is inside
+					dual.push_back(n / d);
+				}
+
+				glmvec3 max_abs{ (real)0.0 };
+				for (auto& q : dual) max_abs = glm::max(max_abs, glm::abs(q));
+				real eps = (real)3.0 * std::numeric_limits<real>::epsilon() * (max_abs.x + max_abs.y + max_abs.z);
+				std::vector<glmvec3> dual_vertices;
+				std::vector<std::vector<uint_t>> dual_faces;
+				try { dual_faces = mergeFaces(dual, quickhull(dual, eps), (real)4.0 * eps, dual_vertices); }
+				catch (std::invalid_argument&) { return false; }	//flat dual hull, the planes are open to one side
+
+				vertices.clear();
+				std::unordered_map<uint64_t, uint_t> edge_face;	//directed dual edge -> dual face
+				std::vector<uint_t> vertex_face(dual_vertices.size());
+				for (uint_t f = 0; f < dual_faces.size(); ++f) {	//each dual face m*y = e is a primal vertex m/e
+					auto& face = dual_faces[f];
+					glmvec3 m = glm::cross(dual_vertices[face[1]] - dual_vertices[face[0]], dual_vertices[face[2]] - dual_vertices[face[1]]);
+					real e = glm::dot(m, dual_vertices[face[0]]);
+					if (e <= (real)0.0 || glm::length(m) > (real)4.0 * radius * e) return false;	//unbounded or far outside the hull
+					vertices.push_back(center + m / e);
+					for (size_t i = 0; i < face.size(); ++i) {
+						edge_face[edgeKey(face[i], face[(i + 1) % face.size()])] = f;
+						vertex_face[face[i]] = f;
+					}
+				}
+
+				faces.clear();
+				for (uint_t v = 0; v < dual_vertices.size(); ++v) {	//each dual vertex is a primal face, its corners are the dual faces around it
+					auto& face = faces.emplace_back();
+					uint_t f = vertex_face[v];
+					do {
+						face.push_back(f);
+						auto& loop = dual_faces[f];
+						size_t i = std::ranges::find(loop, v) - loop.begin();
+						f = edge_face.at(edgeKey(v, loop[(i + loop.size() - 1) % loop.size()]));	//cross the edge coming into v
+					} while (f != vertex_face[v] && face.size() <= dual_faces.size());
+					if (face.size() < 3) return false;
+
+					glmvec3 area{ (real)0.0 };
+					for (size_t i = 0; i < face.size(); ++i) area += glm::cross(vertices[face[i]], vertices[face[(i + 1) % face.size()]]);
+					if (glm::dot(area, dual_vertices[v]) < (real)0.0) std::ranges::reverse(face);
+					startAtLargestCorner(vertices, face);
+				}
+				return true;
+			}
+		};
+
+		/// <summary>
+		/// This is the template for each cube. It contains the basic geometric properties of a cube:
+		/// Vertices, edges and faces. We use a left handed space. Edges can have signs, meaning
+		/// their vectors are multiplied with this factor (1 or -1). 
+		/// </summary>
+		inline static Polytope g_cube {
+			{ { -(real)0.5,-(real)0.5,-(real)0.5 }, { -(real)0.5,-(real)0.5,(real)0.5 }, { -(real)0.5,(real)0.5,(real)0.5 }, { -(real)0.5,(real)0.5,-(real)0.5 },
+			{ (real)0.5,-(real)0.5,(real)0.5 }, { (real)0.5,-(real)0.5,-(real)0.5 }, { (real)0.5,(real)0.5,-(real)0.5 }, { (real)0.5,(real)0.5,(real)0.5 } },
+			{ {0,1}, {1,2}, {2,3}, {3,0}, {4,5}, {5,6}, {6,7}, {7,4}, {5,0}, {1,4}, {3,6}, {7,2} }, //edges
+			{	{ {0, 1}, {1, 1},  {2, 1}, {3, 1} },	//face 0
+				{ {4, 1}, {5, 1},  {6, 1}, {7, 1} },	//face 1
+				{ {0,-1}, {8,-1},  {4,-1}, {9,-1} },	//face 2
+				{ {2,-1}, {11,-1}, {6,-1}, {10,-1} },	//face 3
+				{ {3,-1}, {10, 1}, {5,-1}, {8, 1} },	//face 4
+				{ {1,-1}, {9, 1},  {7,-1}, {11, 1} }	//face 5
+			},
+			[](real mass, glmvec3& s) { //callback for calculating the inertia tensor of this polytope
+				return mass * glmmat3{ {s.y * s.y + s.z * s.z,0,0}, {0,s.x * s.x + s.z * s.z,0}, {0,0,s.x * s.x + s.y * s.y} } / (real)12.0;
+			}
+		};
+
+		/// <summary>
+		/// A sphere around the local origin. Its radius is scaled with the x scale of the body, so use uniform scales.
+		/// Spheres collide with closed form functions instead of SAT.
+		/// </summary>
+		struct Sphere : public Collider {
+			real m_radius;		//radius in local space
+
+			/// <summary>
+			/// Constructor of a sphere.
+			/// </summary>
+			/// <param name="radius">Radius in local space.</param>
+			Sphere(real radius = (real)0.5) : Collider{ SHAPE_SPHERE, radius,
+				[=](real mass, glmvec3& s) { real r = radius * s.x; return (real)0.4 * mass * r * r * glmmat3{ (real)1.0 }; } },
+				m_radius{ radius } {}
+		};
+
+		/// <summary>
+		/// A capsule is a sphere swept along the local y axis, from -m_half_height to m_half_height. The segment is scaled with 
+		/// the body, and the radius with its x scale. Capsules collide with closed form functions instead of SAT.
+		/// </summary>
+		struct Capsule : public Collider {
+			real m_radius;		//radius in local space
+			real m_half_height;	//half length of the segment in local space
+
+			/// <summary>
+			/// Constructor of a capsule. The inertia tensor is the sum of a cylinder and two half spheres.
+			/// </summary>
+			/// <param name="radius">Radius in local space.</param>
+			/// <param name="half_height">Half length of the segment in local space.</param>
+			Capsule(real radius = (real)0.5, real half_height = (real)0.5) : Collider{ SHAPE_CAPSULE, radius + half_height,
+				[=](real mass, glmvec3& s) {
+					real r = radius * s.x, h = half_height * s.y;
+					real vc = (real)2.0 * h * r * r, vs = (real)4.0 / (real)3.0 * r * r * r;	//volumes of cylinder and sphere, without pi
+					real mc = mass * vc / (vc + vs), ms = mass - mc;
+					real iy = mc * r * r / (real)2.0 + ms * (real)0.4 * r * r;
+					real ix = mc * (h * h / (real)3.0 + r * r / (real)4.0) + ms * ((real)0.4 * r * r + h * h + (real)0.75 * h * r);
+					return glmmat3{ {ix,0,0}, {0,iy,0}, {0,0,ix} };
+				} },
+				m_radius{ radius }, m_half_height{ half_height } {}
+		};
+
+		inline static Sphere g_sphere{};		//sphere with diameter 1
+		inline static Capsule g_capsule{};		//capsule with diameter 1 and height 2
+
+		/// <summary>
+		/// The core of a round shape in world space: a sphere swept along a segment. For a sphere, both ends are the same point.
+		/// </summary>
+		struct RoundCore {
+			glmvec3 m_aW;		//first end of the segment
+			glmvec3 m_bW;		//second end of the segment
+			real	m_radius;	//radius in world space
+		};
+
+		/// <summary>
+		/// A compound is a rigid shape made of several child shapes, e.g. the top and the legs of a table. Children are placed with local 
+		/// transforms, and their masses give the mass distribution. A small bounding volume hierarchy over the children lets the narrow 
+		/// phase test only children that can touch the other body. Bodies with compound shapes must use uniform scales.
+		/// </summary>
+		struct Compound : public Collider {
+
+			/// <summary>
+			/// A child shape of a compound.
+			/// </summary>
+			struct Child {
+				Collider*	m_collider = &g_cube;			//shape of the child, must not be a compound
+				glmvec3		m_positionL{ 0, 0, 0 };			//position in the compound, relative to the center of mass after construction
+				glmquat		m_orientationL{ 1, 0, 0, 0 };	//orientation child -> compound
+				glmvec3		m_scale{ 1, 1, 1 };				//scale of the child
+				real		m_mass{ (real)1.0 };			//mass of the child, only the ratios between the children matter
+				Transform	m_transform{};					//child -> compound transform, computed by the compound
+			};
+
+			/// <summary>
+			/// Node of the bounding volume hierarchy, an axis aligned box in compound space. A leaf holds one child.
+			/// </summary>
+			struct Node {
+				glmvec3		m_min;			//lower corner of the box
+				glmvec3		m_max;			//upper corner of the box
+				uint32_t	m_left{ 0 };	//index of the left node, 0 if this is a leaf (the root is never a child)
+				uint32_t	m_right{ 0 };	//index of the right node
+				uint32_t	m_child{ 0 };	//index of the child if this is a leaf
+			};
+
+			std::vector<Child>	m_children;							//the child shapes
+			std::vector<Node>	m_nodes;							//bounding volume hierarchy, the first node is the root
+			glmvec3				m_center_of_massL{ (real)0.0 };		//center of mass in the coordinates the children were placed in
+
+			/// <summary>
+			/// Constructor of a compound. Moves the children so that the center of mass becomes the local origin, computes the combined
+			/// inertia tensor with the parallel axis theorem, and builds the bounding volume hierarchy. A render mesh placed with the
+			/// same child positions must be offset by -m_center_of_massL. A body with a compound shape must be scaled uniformly.
+			/// </summary>
+			/// <param name="children">The child shapes.</param>
+			Compound(std::vector<Child> children) : Collider{ SHAPE_COMPOUND, (real)0.0, {} }, m_children{ std::move(children) } {
+				assert(!m_children.empty());
+				real total{ (real)0.0 };
+				for (auto& child : m_children) {
+					assert(child.m_collider->m_shape != SHAPE_COMPOUND);
+					total += child.m_mass;
+					m_center_of_massL += child.m_mass * child.m_positionL;
+				}
+				m_center_of_massL /= total;
+
+				glmmat3 inertia{ (real)0.0 };	//for mass 1 and scale 1
+				for (auto& child : m_children) {
+					child.m_positionL -= m_center_of_massL;
+					child.m_transform = Transform::fromTRS(child.m_positionL, child.m_orientationL, child.m_scale);
+					real mass = child.m_mass / total;
+					glmmat3 rot{ glm::mat3_cast(child.m_orientationL) };
+					inertia += rot * child.m_collider->inertiaTensor(mass, child.m_scale) * glm::transpose(rot);
+					inertia += mass * (glm::dot(child.m_positionL, child.m_positionL) * glmmat3{ (real)1.0 } - glm::outerProduct(child.m_positionL, child.m_positionL));
+					real radius = glm::length(child.m_positionL) + std::max({ child.m_scale.x, child.m_scale.y, child.m_scale.z }) * child.m_collider->m_bounding_sphere_radius;
+					this->m_bounding_sphere_radius = std::max(this->m_bounding_sphere_radius, radius);
+				}
+				this->inertiaTensor = [=](real mass, glmvec3& s) { return mass * s.x * s.x * inertia; };
+
+				std::vector<std::pair<glmvec3, glmvec3>> bounds;
+				std::vector<uint32_t> indices;
+				for (auto& child : m_children) {
+					bounds.push_back(childBounds(child));
+					indices.push_back((uint32_t)indices.size());
+				}
+				build(indices, 0, indices.size(), bounds);
+			}
+
+			/// <summary>
+			/// Box around a child in compound space.
+			/// </summary>
+			/// <param name="child">The child.</param>
+			/// <returns>Lower and upper corner of the box.</returns>
+			static std::pair<glmvec3, glmvec3> childBounds(const Child& child) {
+				if (child.m_collider->m_shape == SHAPE_POLYTOPE) {
+					glmvec3 lo{ std::numeric_limits<real>::max() }, hi{ -std::numeric_limits<real>::max() };
+					for (auto& vertex : static_cast<Polytope*>(child.m_collider)->m_vertices) {
+						glmvec3 p = child.m_transform.point(vertex.m_positionL);
+						lo = glm::min(lo, p);
+						hi = glm::max(hi, p);
+					}
+					return { lo, hi };
+				}
+				real radius = static_cast<Sphere*>(child.m_collider)->m_radius * child.m_scale.x;
+				glmvec3 a = child.m_positionL, b = child.m_positionL;
+				if (child.m_collider->m_shape == SHAPE_CAPSULE) {
+					real half_height = static_cast<Capsule*>(child.m_collider)->m_half_height;
+					a = child.m_transform.point(glmvec3{ 0, -half_height, 0 });
+					b = child.m_transform.point(glmvec3{ 0, half_height, 0 });
+				}
+				return { glm::min(a, b) - radius, glm::max(a, b) + radius };
+			}
+
+			/// <summary>
+			/// Build the hierarchy top down, splitting the children at the median of the longest box axis.
+			/// </summary>
+			/// <param name="indices">Child indices, reordered in place.</param>
+			/// <param name="first">First index of the children of this node.</param>
+			/// <param name="last">One past the last index of the children of this node.</param>
+			/// <param name="bounds">Boxes of all children.</param>
+			/// <returns>Index of the new node.</returns>
+			uint32_t build(std::vector<uint32_t>& indices, size_t first, size_t last, const std::vector<std::pair<glmvec3, glmvec3>>& bounds) {
+				uint32_t n = (uint32_t)m_nodes.size();
+				m_nodes.push_back({ bounds[indices[first]].first, bounds[indices[first]].second });
+				for (size_t i = first + 1; i < last; ++i) {
+					m_nodes[n].m_min = glm::min(m_nodes[n].m_min, bounds[indices[i]].first);
+					m_nodes[n].m_max = glm::max(m_nodes[n].m_max, bounds[indices[i]].second);
+				}
+				if (last - first == 1) {
+					m_nodes[n].m_child = indices[first];
+					return n;
+				}
+				glmvec3 extent = m_nodes[n].m_max - m_nodes[n].m_min;
+				int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+				size_t mid = (first + last) / 2;
+				std::nth_element(indices.begin() + first, indices.begin() + mid, indices.begin() + last, [&](uint32_t a, uint32_t b) {
+					return bounds[a].first[axis] + bounds[a].second[axis] < bounds[b].first[axis] + bounds[b].second[axis]; });
+				uint32_t left = build(indices, first, mid, bounds);
+				uint32_t right = build(indices, mid, last, bounds);
+				m_nodes[n].m_left = left;
+				m_nodes[n].m_right = right;
+				return n;
+			}
+
+			/// <summary>
+			/// Visit all children whose boxes overlap a box in compound space.
+			/// </summary>
+			/// <param name="lo">Lower corner of the box.</param>
+			/// <param name="hi">Upper corner of the box.</param>
+			/// <param name="visit">Called with the index of each overlapping child.</param>
+			void query(glmvec3 lo, glmvec3 hi, auto&& visit) const {
+				std::array<uint32_t, 64> stack;	//the hierarchy is balanced, so this is deep enough
+				size_t top = 0;
+				stack[top++] = 0;
+				while (top > 0) {
+					const Node& node = m_nodes[stack[--top]];
+					if (glm::any(glm::lessThan(hi, node.m_min)) || glm::any(glm::greaterThan(lo, node.m_max))) continue;
+					if (node.m_left == 0) { visit(node.m_child); continue; }
+					stack[top++] = node.m_left;
+					stack[top++] = node.m_right;
+				}
+			}
+		};
+
+		/// <summary>
+		/// A static triangle mesh for level geometry like buildings, ramps or caves. It need not be convex or closed. Triangles are
+		/// one sided: bodies collide with the side their normal points to, i.e. the side from which the triangle is counter clockwise.
+		/// A bounding volume hierarchy built with the surface area heuristic lets the narrow phase visit only triangles near a body.
+		/// Bodies with a mesh shape must have infinite mass. They are tested against all other bodies like the ground, so use few, 
+		/// large meshes.
+		/// </summary>
+		struct TriangleMesh : public Collider {
+
+			/// <summary>
+			/// Node of the bounding volume hierarchy, an axis aligned box in local space. The left child of an inner node
+			/// is the next node. A leaf holds a range of triangles.
+			/// </summary>
+			struct Node {
+				glmvec3		m_min;			//lower corner of the box
+				glmvec3		m_max;			//upper corner of the box
+				uint32_t	m_first{ 0 };	//first triangle of a leaf
+				uint32_t	m_count{ 0 };	//number of triangles of a leaf, 0 for inner nodes
+				uint32_t	m_right{ 0 };	//index of the right child of an inner node
+			};
+
+			static constexpr uint32_t c_leaf_size = 4;	//a node with at most this many triangles is not split
+			static constexpr uint32_t c_bins = 16;		//number of bins per axis for evaluating the surface area heuristic
+			static constexpr uint32_t c_max_depth = 64;	//deeper nodes become leaves, so queries need a fixed size stack
+
+			std::vector<glmvec3>					m_positionsL;		//vertex positions in local space
+			std::vector<std::array<uint_t, 3>>		m_triangles;		//vertex indices, sorted into the leaves of the hierarchy
+			std::vector<glmvec3>					m_normalsL;			//normal vector of each triangle
+			std::vector<uint8_t>					m_active_edges;		//bit e is set if edge e (from vertex e to e+1) of a triangle is active
+			std::vector<Node>						m_nodes;			//bounding volume hierarchy, the first node is the root
+
+			/// <summary>
+			/// Constructor of a triangle mesh. Degenerate triangles are dropped. An edge is active, i.e. it can push bodies 
+			/// in another direction than the triangle normal, if it is a border of the mesh, or if the mesh is convex at the edge
+			/// and bends more than active_edge_angle. Edges inside flat or concave regions are inactive, so bodies sliding
+			/// over them do not hit them (ghost collisions).
+			/// </summary>
+			/// <param name="positions">Vertex positions in local space.</param>
+			/// <param name="triangles">Vertex indices, counter clockwise seen from the colliding side.</param>
+			/// <param name="active_edge_angle">Smallest angle between the normals of two triangles at an active edge.</param>
+			TriangleMesh(std::vector<glmvec3> positions, const std::vector<std::array<uint_t, 3>>& triangles, real active_edge_angle = pi / (real)36.0)
+				: Collider{ SHAPE_MESH, (real)0.0, [](real mass, glmvec3&) { return mass * glmmat3{ (real)1.0 }; } }, m_positionsL{ std::move(positions) } {
+				for (auto& p : m_positionsL) this->m_bounding_sphere_radius = std::max(this->m_bounding_sphere_radius, glm::length(p));
+				for (auto& t : triangles) {
+					glmvec3 e1 = m_positionsL[t[1]] - m_positionsL[t[0]], e2 = m_positionsL[t[2]] - m_positionsL[t[0]];
+					if (glm::length(glm::cross(e1, e2)) > c_eps * glm::length(e1) * glm::length(e2)) m_triangles.push_back(t);	//relative, so small triangles are kept
+				}
+				if (m_triangles.empty()) throw std::invalid_argument("TriangleMesh: no triangles");
+
+				std::vector<std::pair<glmvec3, glmvec3>> bounds;	//box of each triangle
+				for (auto& t : m_triangles) {
+					bounds.emplace_back(glm::min(glm::min(m_positionsL[t[0]], m_positionsL[t[1]]), m_positionsL[t[2]]),
+						glm::max(glm::max(m_positionsL[t[0]], m_positionsL[t[1]]), m_positionsL[t[2]]));
+				}
+				std::vector<uint32_t> indices(m_triangles.size());
+				std::iota(indices.begin(), indices.end(), 0);
+				m_nodes.reserve(2 * m_triangles.size() / c_leaf_size + 1);
+				build(indices, 0, (uint32_t)indices.size(), bounds, 0);
+				std::vector<std::array<uint_t, 3>> sorted;
+				sorted.reserve(indices.size());
+				for (auto i : indices) sorted.push_back(m_triangles[i]);
+				m_triangles = std::move(sorted);
+
+				for (auto& t : m_triangles) {
+					m_normalsL.push_back(glm::normalize(glm::cross(m_positionsL[t[1]] - m_positionsL[t[0]], m_positionsL[t[2]] - m_positionsL[t[0]])));
+				}
+
+				std::unordered_map<uint64_t, uint32_t> edge_triangle;	//directed edge -> triangle
+				for (uint32_t i = 0; i < m_triangles.size(); ++i) {
+					for (int e = 0; e < 3; ++e) edge_triangle[Polytope::edgeKey(m_triangles[i][e], m_triangles[i][(e + 1) % 3])] = i;
+				}
+				real cos_angle = std::cos(active_edge_angle);
+				m_active_edges.assign(m_triangles.size(), 0);
+				for (uint32_t i = 0; i < m_triangles.size(); ++i) {
+					auto& t = m_triangles[i];
+					for (int e = 0; e < 3; ++e) {
+						auto it = edge_triangle.find(Polytope::edgeKey(t[(e + 1) % 3], t[e]));	//the neighbor has the edge reversed
+						bool active = it == edge_triangle.end();
+						if (!active) {
+							auto& n = m_triangles[it->second];
+							uint_t opposite = n[0] != t[e] && n[0] != t[(e + 1) % 3] ? n[0] : (n[1] != t[e] && n[1] != t[(e + 1) % 3] ? n[1] : n[2]);
+							bool convex = glm::dot(m_normalsL[i], m_positionsL[opposite] - m_positionsL[t[e]]) < (real)0.0;
+							active = convex && glm::dot(m_normalsL[i], m_normalsL[it->second]) < cos_angle;
+						}
+						if (active) m_active_edges[i] |= (uint8_t)(1 << e);
+					}
+				}
+			}
+
+			/// <summary>
+			/// Build the hierarchy top down. Each node is split where the surface area heuristic, evaluated for
+			/// c_bins bins of the triangle centers along each axis, is smallest.
+			/// </summary>
+			/// <param name="indices">Triangle indices, reordered in place.</param>
+			/// <param name="first">First index of the triangles of this node.</param>
+			/// <param name="last">One past the last index of the triangles of this node.</param>
+			/// <param name="bounds">Boxes of all triangles.</param>
+			/// <param name="depth">Depth of this node.</param>
+			void build(std::vector<uint32_t>& indices, uint32_t first, uint32_t last, const std::vector<std::pair<glmvec3, glmvec3>>& bounds, uint32_t depth) {
+				auto area = [](glmvec3 lo, glmvec3 hi) { glmvec3 d = hi - lo; return d.x * d.y + d.y * d.z + d.z * d.x; };
+				uint32_t n = (uint32_t)m_nodes.size();
+				m_nodes.push_back({ bounds[indices[first]].first, bounds[indices[first]].second });
+				glmvec3 clo{ std::numeric_limits<real>::max() }, chi{ -std::numeric_limits<real>::max() };	//box of the centers
+				for (uint32_t i = first; i < last; ++i) {
+					m_nodes[n].m_min = glm::min(m_nodes[n].m_min, bounds[indices[i]].first);
+					m_nodes[n].m_max = glm::max(m_nodes[n].m_max, bounds[indices[i]].second);
+					glmvec3 c = (bounds[indices[i]].first + bounds[indices[i]].second) * (real)0.5;
+					clo = glm::min(clo, c);
+					chi = glm::max(chi, c);
+				}
+
+				real best_cost = area(m_nodes[n].m_min, m_nodes[n].m_max) * (real)(last - first);	//cost of a leaf
+				int best_axis = -1;
+				uint32_t best_bin = 0;
+				auto bin = [&](uint32_t t, int axis) {	//bin of the center of triangle t
+					real c = (bounds[t].first[axis] + bounds[t].second[axis]) * (real)0.5;
+					return std::min(c_bins - 1, (uint32_t)((real)c_bins * (c - clo[axis]) / (chi[axis] - clo[axis])));
+				};
+				for (int axis = 0; axis < 3; ++axis) {
+					if (chi[axis] - clo[axis] < c_eps) continue;
+					std::array<glmvec3, c_bins> lo, hi;
+					std::array<uint32_t, c_bins> count{};
+					lo.fill(glmvec3{ std::numeric_limits<real>::max() });
+					hi.fill(glmvec3{ -std::numeric_limits<real>::max() });
+					for (uint32_t i = first; i < last; ++i) {
+						uint32_t b = bin(indices[i], axis);
+						++count[b];
+						lo[b] = glm::min(lo[b], bounds[indices[i]].first);
+						hi[b] = glm::max(hi[b], bounds[indices[i]].second);
+					}
+					std::array<real, c_bins> right_cost{};		//sweep from the right, then from the left
+					glmvec3 rlo = lo[c_bins - 1], rhi = hi[c_bins - 1];
+					uint32_t rcount = 0;
+					for (uint32_t b = c_bins - 1; b > 0; --b) {
+						rlo = glm::min(rlo, lo[b]);
+						rhi = glm::max(rhi, hi[b]);
+						rcount += count[b];
+						right_cost[b] = rcount > 0 ? area(rlo, rhi) * (real)rcount : (real)0.0;
+					}
+					glmvec3 llo = lo[0], lhi = hi[0];
+					uint32_t lcount = 0;
+					for (uint32_t b = 0; b + 1 < c_bins; ++b) {
+						llo = glm::min(llo, lo[b]);
+						lhi = glm::max(lhi, hi[b]);
+						lcount += count[b];
+						if (lcount == 0 || lcount == last - first) continue;
+						real cost = area(llo, lhi) * (real)lcount + right_cost[b + 1];
+						if (cost < best_cost) { best_cost = cost; best_axis = axis; best_bin = b; }
+					}
+				}
+
+				if (depth + 1 >= c_max_depth || (best_axis < 0 && last - first <= c_leaf_size)) {	//a leaf is cheaper, or the tree is too deep
+					m_nodes[n].m_first = first;
+					m_nodes[n].m_count = last - first;
+					return;
+				}
+				uint32_t mid = (first + last) / 2;		//if a leaf is cheaper but too large, split in the middle
+				if (best_axis >= 0) {
+					mid = (uint32_t)(std::partition(indices.begin() + first, indices.begin() + last, [&](uint32_t t) { return bin(t, best_axis) <= best_bin; }) - indices.begin());
+				}
+				build(indices, first, mid, bounds, depth + 1);
+				m_nodes[n].m_right = (uint32_t)m_nodes.size();
+				build(indices, mid, last, bounds, depth + 1);
+			}
+
+			/// <summary>
+			/// Visit all triangles whose boxes overlap a box in local space.
+			/// </summary>
+			/// <param name="lo">Lower corner of the box.</param>
+			/// <param name="hi">Upper corner of the box.</param>
+			/// <param name="visit">Called with the index of each overlapping triangle.</param>
+			void query(glmvec3 lo, glmvec3 hi, auto&& visit) const {
+				std::array<uint32_t, c_max_depth> stack;
+				size_t top = 0;
+				stack[top++] = 0;
+				while (top > 0) {
+					const Node& node = m_nodes[stack[--top]];
+					if (glm::any(glm::lessThan(hi, node.m_min)) || glm::any(glm::greaterThan(lo, node.m_max))) continue;
+					if (node.m_count > 0) {
+						for (uint32_t i = node.m_first; i < node.m_first + node.m_count; ++i) visit(i);
+						continue;
+					}
+					stack[top++] = node.m_right;
+					stack[top++] = (uint32_t)(&node - m_nodes.data()) + 1;
+				}
+			}
+
+			/// <summary>
+			/// Create a flat polytope with three vertices, three edges, and a front and a back face. The narrow phase
+			/// moves it to the triangles of a mesh with setTriangle(), and collides it with collidePolytopes().
+			/// </summary>
+			/// <returns>The triangle polytope.</returns>
+			static Polytope makeTriangle() {
+				return { { { 0, 0, 0 }, { 0, 0, 1 }, { 1, 0, 0 } }, { { 0, 1 }, { 1, 2 }, { 2, 0 } },
+					{ { { 0, 1 }, { 1, 1 }, { 2, 1 } }, { { 2, -1 }, { 1, -1 }, { 0, -1 } } }, [](real mass, glmvec3&) { return mass * glmmat3{ (real)1.0 }; } };
+			}
+
+			/// <summary>
+			/// Move a polytope made by makeTriangle() to a triangle of this mesh.
+			/// </summary>
+			/// <param name="triangle">The triangle polytope.</param>
+			/// <param name="i">Index of the triangle.</param>
+			void setTriangle(Polytope& triangle, uint32_t i) const {
+				for (int k = 0; k < 3; ++k) triangle.m_vertices[k].m_positionL = m_positionsL[m_triangles[i][k]];
+				for (auto& edge : triangle.m_edges) edge.m_edgeL = edge.m_second_vertexL.m_positionL - edge.m_first_vertexL.m_positionL;
+				for (auto& face : triangle.m_faces) Polytope::updateFace(face);
+				triangle.updatePlanes();
+				triangle.m_bounding_sphere_radius = std::max({ glm::length(triangle.m_vertices[0].m_positionL), 
+					glm::length(triangle.m_vertices[1].m_positionL), glm::length(triangle.m_vertices[2].m_positionL) });
+			}
+
+			/// <summary>
+			/// Test whether a point touches a triangle at an active edge. Points inside the triangle touch the face, points 
+			/// near a vertex touch both edges at the vertex.
+			/// </summary>
+			/// <param name="i">Index of the triangle.</param>
+			/// <param name="pL">The point in local space, e.g. a contact point.</param>
+			/// <param name="tolerance">Points closer to an edge than this fraction of the triangle height count as touching it.</param>
+			/// <returns>True if the point touches an active edge.</returns>
+			bool activeEdge(uint32_t i, glmvec3 pL, real tolerance = (real)0.01) const {
+				if (m_active_edges[i] == 0) return false;
+				auto& t = m_triangles[i];
+				glmvec3 a = m_positionsL[t[0]], b = m_positionsL[t[1]], c = m_positionsL[t[2]];
+				glmvec3 n = glm::cross(b - a, c - a);
+				real area2 = glm::dot(n, n);
+				std::array<real, 3> bary{		//barycentric coordinates, bary[k] is 0 on the edge opposite of vertex k
+					glm::dot(glm::cross(c - b, pL - b), n) / area2,
+					glm::dot(glm::cross(a - c, pL - c), n) / area2,
+					glm::dot(glm::cross(b - a, pL - a), n) / area2 };
+				for (int e = 0; e < 3; ++e) {	//edge e is opposite of vertex (e + 2) % 3
+					if (bary[(e + 2) % 3] < tolerance && (m_active_edges[i] & (1 << e))) return true;
+				}
+				return false;
+			}
+		};
+
+		//--------------------------------------------------------------------------------------------------
+		//Physics engine stuff
+
+		/// <summary>
+		/// Handle of a constraint, returned by addConstraint(). Stays valid until the constraint is removed, 
+		/// a removed constraint's handle does not refer to a later constraint in the same slot.
+		/// </summary>
+		struct ConstraintHandle {
+			uint32_t m_type{ std::numeric_limits<uint32_t>::max() };	//index of the constraint type in m_constraints
+			uint32_t m_slot{ 0 };										//slot in the array of this type
+			uint32_t m_generation{ 0 };									//generation of the slot when the constraint was added
+
+			bool operator==(const ConstraintHandle&) const = default;
+		};
+
+		class Body;
+		struct Contact;
+		using callback_move = std::function<void(double, std::shared_ptr<Body>)>; //call this function when the body moves
+		using callback_erase = std::function<void(std::shared_ptr<Body>)>; //call this function when the body moves
+
+		/// <summary>
+		/// This class implements the basic physics properties of a rigid body.
+		/// </summary>
+		class Body : public std::enable_shared_from_this<Body> {
+
+		public:
+			BasicVPEWorld* m_physics;			//Pointer to the physics world to access parameters
+			std::string	m_name;							//The name of this body
+
+			//-----------------------------------------------------------------------------
+			//Physics parameters of the body
+
+			void*		m_owner = nullptr;				//pointer to owner of this body, must be unique (owner is called if body moves)
+			Collider*	m_collider = nullptr;			//geometric shape
+			Polytope*	m_polytope = nullptr;			//the shape if it is a polytope, else nullptr
+			glmvec3		m_scale{ 1,1,1 };				//scale factor in local space
+			glmvec3		m_positionW{ 0, 0, 0 };			//current position at time slot in world space
+			glmquat		m_orientationLW{ 1, 0, 0, 0 };	//current orientation at time slot Local -> World
+			glmvec3		m_linear_velocityW{ 0,0,0 };	//linear velocity at time slot in world space
+			glmvec3		m_angular_velocityW{ 0,0,0 };	//angular velocity at time slot in world space
+			callback_move  m_on_move = nullptr;			//called if the body moves
+			callback_erase m_on_erase = nullptr;			//called if the body is erased
+			real		m_mass_inv{ 0 };				//1 over mass
+			real		m_restitution{ 0 };				//coefficient of restitution eps
+			real		m_friction{ 1 };				//coefficient of friction mu
+			uint64_t	m_loop_last_active{ 0 };		//The loop number in which this body was last time active
+			uint32_t	m_event_flags{ 0 };				//Contact events to report for this body, see contact_event_flags_t
+			uint32_t	m_collision_category{ 1 };		//Category bits of this body, see shouldCollide()
+			uint32_t	m_collision_mask{ 0xffffffff };	//Categories of bodies this body collides with
+			bool		m_ccd{ false };					//Continuous collision detection, for fast bodies like projectiles
+			bool		m_sleeping{ false };			//Sleeping bodies are not integrated, call wakeBody() after changing them
+
+			std::pmr::unordered_map<uint64_t, Force> m_forces;//forces acting on this body, allocated from the world's memory resource
+
+			//-----------------------------------------------------------------------------
+			//These members are computed by the class, only change if you know what you are doing
+
+			glmmat3		m_inertiaL{ 1 };				//computed when the body is created
+			glmmat3		m_inertia_invL{ 1 };			//computed when the body is created
+
+			//-----------------------------------------------------------------------------
+			//computed when the body moves
+
+			Transform	m_model;						//model transform at time slots
+			Transform	m_model_inv;					//model inverse transform at time slots
+			glmmat3		m_model_it;						//orientation inverse transpose for bringing normal vector to world
+			glmmat3		m_inertiaW{ glmmat4{1} };		//inertia tensor in world frame
+			glmmat3		m_inertia_invW{ glmmat4{1} };	//inverse inertia tensor in world frame
+			int_t		m_grid_x{ 0 };					//grid coordinates for broadphase
+			int_t		m_grid_z{ 0 };
+			size_t		m_active_idx{ 0 };				//index in the active body list of the world, if not sleeping
+			uint32_t	m_slot{ 0 };					//slot in the transform output buffer of the world
+			glmvec3		m_prev_positionW{ 0, 0, 0 };	//position at the previous time slot, for interpolation
+			glmquat		m_prev_orientationLW{ 1, 0, 0, 0 };	//orientation at the previous time slot, for interpolation
+			glmvec3		m_pbias{ 0, 0, 0 };				//extra energy if body overlaps with another body
+			uint32_t	m_num_resting{ 0 };				//number resting contact points 
+			real		m_damping{ 0 };					//damping velocity of resting contact points
+			real		m_toi{ 1 };						//time of impact as fraction of the time step, if m_ccd is set
+			std::vector<std::shared_ptr<Body>> m_parts;	//one proxy body per child if the shape is a compound, not in the world
+			std::pmr::vector<Contact*> m_contacts;		//contacts of this body in the world's m_contacts, see bodyContacts()
+			std::pmr::vector<ConstraintHandle> m_constraints;	//constraints connecting this body, see bodyConstraints()
+
+			/// <summary>
+			/// Constructor of class Body. Uses ony default parameters.
+			/// </summary>
+			/// <param name="physics">Pointer to the physics world.</param>
+			Body(BasicVPEWorld* physics) : m_physics{ physics }, m_forces{ physics->m_memory_resource }, 
+				m_contacts{ physics->m_memory_resource }, m_constraints{ physics->m_memory_resource } { m_collider = m_polytope = &m_physics->g_cube; inertiaTensorL(); updateMatrices(); };
+
+			/// <summary>
+			/// Constructor of class Body
+			/// </summary>
+			/// <param name="physics">Pointer to the physics world.</param>
+			/// <param name="name">Name of the body.</param>
+			/// <param name="owner">Pointer to the owner. The callback knows how to use this pointer.</param>
+			/// <param name="collider">Pointer to the shape, e.g. a polytope, sphere or capsule.</param>
+			/// <param name="scale">3D scaling.</param>
+			/// <param name="positionW">3D position of the body.</param>
+			/// <param name="orientationLW">Body orientation as quaternion.</param>
+			/// <param name="on_move">Callback that is called when the body moves.</param>
+			/// <param name="on_erase">Callback that is called when the body is erased.</param>
+			/// <param name="linear_velocityW">Starting linear velocity.</param>
+			/// <param name="angular_velocityW">Starting angular velovity as axis vector. Length of vector is the speed.</param>
+			/// <param name="mass_inv">1 / mass. If zero, then mass is infinite.</param>
+			/// <param name="restitution">Bounciness, between 0 and 1.</param>
+			/// <param name="friction">Friction coefficient, usually larger than 0.5.</param>
+			Body(BasicVPEWorld* physics, std::string name, void* owner, Collider* collider,
+				glmvec3 scale, glmvec3 positionW, glmquat orientationLW = { 1,0,0,0 },
+				glmvec3 linear_velocityW = glmvec3{ 0,0,0 }, glmvec3 angular_velocityW = glmvec3{ 0,0,0 },
+				real mass_inv = 0, real restitution = (real)0.2, real friction = 1) :
+				m_physics{ physics }, m_name{ name }, m_owner{ owner }, m_collider{ collider },
+				m_polytope{ collider->m_shape == SHAPE_POLYTOPE ? static_cast<Polytope*>(collider) : nullptr },
+				m_scale{ scale }, m_positionW{ positionW }, m_orientationLW{ orientationLW },
+				m_linear_velocityW{ linear_velocityW }, m_angular_velocityW{ angular_velocityW },
+				m_mass_inv{ mass_inv }, m_restitution{ restitution }, m_friction{ friction }, m_forces{ physics->m_memory_resource },
+				m_contacts{ physics->m_memory_resource }, m_constraints{ physics->m_memory_resource } {
+					m_scale *= m_physics->m_collision_margin_factor;
+					assert(collider->m_shape != SHAPE_MESH || mass_inv == (real)0.0);	//meshes are static
+					if (collider->m_shape == SHAPE_COMPOUND) {
+						assert(scale.x == scale.y && scale.y == scale.z);	//the compound inertia tensor and the child transforms assume a uniform scale
+						for (auto& child : static_cast<Compound*>(collider)->m_children) {
+							m_parts.push_back(physics->makeBody(name, owner, child.m_collider, child.m_scale, positionW));
+						}
+					}
+					inertiaTensorL();
+					updateMatrices();
+					m_loop_last_active = m_physics->m_loop;
+			};
+
+			/// <summary>
+			/// Attach a force to the body or change it.
+			/// </summary>
+			/// <param name="id">The force ID.</param>
+			/// <param name="force">The force itself.</param>
+			template<typename F>
+			void setForce(uint64_t id, F&& force) {
+				m_forces[id] = std::forward<F>(force);
+				m_physics->wakeBody(this);
+			}
+
+			/// <summary>
+			/// Remove a force.
+			/// </summary>
+			/// <param name="id">Force id.</param>
+			void removeForce(uint64_t id) {
+				m_forces.erase(id);
+				m_physics->wakeBody(this);
+			}
+
+			/// <summary>
+			/// Clamped Euler step for position and orientation, used by both solvers. The body rotates about its world
+			/// angular velocity. If m_clamp_position is 1, slow motion is not integrated.
+			/// </summary>
+			/// <param name="dt">Delta time step.</param>
+			/// <param name="pos">Current position that is updated.</param>
+			/// <param name="quat">Current orientation that is updated.</param>
+			/// <returns>True if the body is moving.</returns>
+			bool integrate(double dt, glmvec3& pos, glmquat& quat) {
+				bool active = false;
+
+				bool dx = fabs(m_linear_velocityW.x) > m_physics->c_small;
+				bool dy = fabs(m_linear_velocityW.y) > -m_physics->m_resting_factor * m_physics->c_gravity * m_physics->m_sim_delta_time;
+				bool dz = fabs(m_linear_velocityW.z) > m_physics->c_small;
+
+				if (dx || dy || dz || m_num_resting < 3) {
+					if (m_physics->m_clamp_position == 1) pos += m_linear_velocityW * (real)dt;
+					active = true;
+				}
+				if (m_physics->m_clamp_position == 0) pos += m_linear_velocityW * (real)dt;
+
+				real len = glm::length(m_angular_velocityW);	//The same for orientation
+				if (len > m_physics->c_small) {
+					if (m_physics->m_clamp_position == 1) quat = glm::normalize(glm::angleAxis(len * (real)dt, m_angular_velocityW / len) * quat);	//Euler step
+					active = true;
+				}
+				if (m_physics->m_clamp_position == 0 && len != (real)0.0) quat = glm::normalize(glm::angleAxis(len * (real)dt, m_angular_velocityW / len) * quat); //Euler step
+
+				return active;
+			}
+
+			/// <summary>
+			/// Euler step for position. Can be used for integration or extrapolation in between time steps.
+			/// Also adds the position bias and updates the damping. With a zero time step, e.g. after the substeps 
+			/// have moved the body, only the damping is updated.
+			/// </summary>
+			/// <param name="dt">Delta time step.</param>
+			/// <param name="pos">Current position that is updated.</param>
+			/// <param name="quat">Current orientation that is updated.</param>
+			/// <returns></returns>
+			bool stepPosition(double dt, glmvec3& pos, glmquat& quat, bool use_pbias = true) {
+				bool active = integrate(dt, pos, quat) || !m_physics->m_deactivate;
+				pos += m_physics->m_pbias_factor * m_pbias * (real)dt;
+				if (use_pbias) { m_pbias = glmvec3{ 0,0,0 }; }
+
+				if (active) {
+					m_damping = (real)0.0;						//If the body moves then no damping
+					m_loop_last_active = m_physics->m_loop;		//remember that the body is now active
+				}
+				else {
+					m_damping = std::clamp(m_damping + m_physics->m_damping_incr, (real)0.0, (real)600.0);	//If no motion, increase damping
+				}
+
+				return active;
+			};
+
+			/// <summary>
+			/// Interpolate between the previous and the current time slot. Does not change the body.
+			/// </summary>
+			/// <param name="alpha">Interpolation weight, 0 is the previous slot, 1 the current slot.</param>
+			/// <param name="pos">Interpolated position.</param>
+			/// <param name="quat">Interpolated orientation.</param>
+			void interpolate(real alpha, glmvec3& pos, glmquat& quat) const {
+				pos = glm::mix(m_prev_positionW, m_positionW, alpha);
+				quat = glm::slerp(m_prev_orientationLW, m_orientationLW, alpha);
+			}
+
+			/// <summary>
+			/// Euler step for velocity.
+			/// </summary>
+			/// <param name="dt">Delta time step.</param>
+			/// <returns></returns>
+			void stepVelocity(double dt) {
+				glmvec3 sum_accelW{ 0 };	//sum of all accelerations
+				glmvec3 sum_forcesW{ 0 };	//sum of all forces in world coordinates
+				glmvec3 sum_torquesW{ 0 };	//sum of all torques in world coordinates
+				for (auto& force : m_forces) {
+					sum_accelW += force.second.m_accelW;
+					sum_forcesW += m_model.m_linear * force.second.m_forceL + force.second.m_forceW;	//forces in local and world coordinates
+					sum_torquesW += glm::cross(m_model.m_linear * force.second.m_positionL, m_model.m_linear * force.second.m_forceL);
+				}
+				m_linear_velocityW += (real)dt * (m_mass_inv * sum_forcesW + sum_accelW);
+				m_angular_velocityW += (real)dt * (m_inertia_invW * (sum_torquesW - glm::cross(m_angular_velocityW, m_inertiaW * m_angular_velocityW)));
+
+				m_linear_velocityW.x *= (real)1.0 / ((real)1.0 + (real)dt * m_damping);	//apply sideways damping if any
+				m_linear_velocityW.z *= (real)1.0 / ((real)1.0 + (real)dt * m_damping);
+				m_angular_velocityW *= (real)1.0 / ((real)1.0 + (real)dt * m_damping);
+			}
+
+			/// <summary>
+			/// Compute total velocity of object at a certain point.
+			/// </summary>
+			/// <param name="positionW">Position of interest in world coordinates.</param>
+			/// <returns></returns>
+			glmvec3 totalVelocityW(glmvec3 positionW) {
+				return m_linear_velocityW + glm::cross(m_angular_velocityW, positionW - m_positionW);
+			}
+
+			/// <summary>
+			/// Calculate radius of bounding sphere of object.
+			/// </summary>
+			/// <returns>Bounding sphere radius.</returns>
+			real boundingSphereRadius() const {
+				return std::max(m_scale.x, std::max(m_scale.y, m_scale.z)) * m_collider->m_bounding_sphere_radius;
+			}
+
+			/// <summary>
+			/// Calculate mass of object. Is the inverse of the inverse mass. If inverse is 0 then
+			/// return a very large number.
+			/// </summary>
+			/// <returns>Mass of object.</returns>
+			real mass() {
+				return m_mass_inv <= c_eps ? (real)1.0 / (c_eps) : (real)1.0 / m_mass_inv;
+			}
+
+			/// <summary>
+			/// Calculate inertia tensor and inverse in world coordinates. Only done once at start.
+			/// </summary>
+			/// <returns>Inertia tensor in world coordinates.</returns>
+			void inertiaTensorL() {
+				m_inertiaL = m_collider->inertiaTensor(mass(), m_scale);	//Shape inertia tensor
+				m_inertia_invL = glm::inverse(m_inertiaL);					//Inverse inertia tensor
+			}
+
+			/// <summary>
+			/// Compute the model (world) matrix for transforming points from local space to world space.
+			/// Is used to set this in the body callback, thus it is static.
+			/// </summary>
+			/// <param name="pos">Current position.</param>
+			/// <param name="orient">Current orientation.</param>
 			/// <param name="scale">Object scale.</param>
 			/// <returns></returns>
 			static glmmat4 computeModel(glmvec3& pos, glmquat& orient, glmvec3& scale) {
-				return glm::translate(glmmat4{ 1.0_real }, pos) * glm::mat4_cast(orient) * glm::scale(glmmat4{ 1.0_real }, scale);
+				return glm::translate(glmmat4{ (real)1.0 }, pos) * glm::mat4_cast(orient) * glm::scale(glmmat4{ (real)1.0 }, scale);
 			};
 
 			/// <summary>
@@ -643,12 +1801,50 @@ namespace vpe {
 			void updateMatrices() {
 				glmmat3 rot3{ glm::mat4_cast(m_orientationLW) };
 
-				m_model = computeModel(m_positionW, m_orientationLW, m_scale);  //model matrix
-				m_model_inv = glm::inverse(m_model);							//inverse model matrix
-				m_model_it = glm::transpose(glm::inverse(glmmat3{ rot3 }));		//inverse transpose to transform normal vectors
+				m_model = Transform::fromTRS(m_positionW, m_orientationLW, m_scale);	//model transform
+				m_model_inv = m_model.inverse();										//inverse model transform, closed form
+				m_model_it = rot3;		//inverse transpose of a rotation is the rotation itself, to transform normal vectors
 
 				m_inertiaW = rot3 * m_inertiaL * glm::transpose(rot3);			//inertia tensor depending on current orientation
 				m_inertia_invW = rot3 * m_inertia_invL * glm::transpose(rot3);
+				if (!m_parts.empty()) updateParts();
+			}
+
+			/// <summary>
+			/// Move the proxy bodies of a compound along with the body. The proxies carry the mass, velocity and material of the
+			/// whole body, so contacts computed with them are valid for the body itself.
+			/// </summary>
+			void updateParts() {
+				auto& children = static_cast<Compound*>(m_collider)->m_children;
+				for (size_t i = 0; i < m_parts.size(); ++i) {
+					auto& part = *m_parts[i];
+					part.m_model = m_model * children[i].m_transform;
+					part.m_model_inv = part.m_model.inverse();
+					part.m_positionW = part.m_model.m_translation;
+					part.m_orientationLW = m_orientationLW * children[i].m_orientationL;
+					part.m_model_it = glmmat3{ glm::mat3_cast(part.m_orientationLW) };
+					part.m_scale = m_scale.x * children[i].m_scale;
+					part.m_linear_velocityW = totalVelocityW(part.m_positionW);
+					part.m_angular_velocityW = m_angular_velocityW;
+					part.m_mass_inv = m_mass_inv;
+					part.m_inertiaW = m_inertiaW;
+					part.m_inertia_invW = m_inertia_invW;
+					part.m_restitution = m_restitution;
+					part.m_friction = m_friction;
+				}
+			}
+
+			/// <summary>
+			/// Core of a sphere or capsule body in world space.
+			/// </summary>
+			/// <param name="model">Transform of the body, e.g. m_model or the body at a different time.</param>
+			/// <returns>Segment and radius in world space.</returns>
+			RoundCore roundCore(const Transform& model) const {
+				if (m_collider->m_shape == SHAPE_SPHERE) {
+					return { model.m_translation, model.m_translation, static_cast<Sphere*>(m_collider)->m_radius * m_scale.x };
+				}
+				auto* capsule = static_cast<Capsule*>(m_collider);
+				return { model.point(glmvec3{ 0, -capsule->m_half_height, 0 }), model.point(glmvec3{ 0, capsule->m_half_height, 0 }), capsule->m_radius * m_scale.x };
 			}
 
 			/// <summary>
@@ -658,10 +1854,33 @@ namespace vpe {
 			/// <returns>Pointer to supporting vertex of body.</returns>
 			Vertex* support(glmvec3 dirL) {
 				auto compare = [&](auto& a, auto& b) { return glm::dot(dirL, a.m_positionL) < glm::dot(dirL, b.m_positionL); };
-				return std::ranges::max_element(m_polytope->m_vertices, compare)._Ptr;
+				return &*std::ranges::max_element(m_polytope->m_vertices, compare);
 			};
 		};
 
+		/// <summary>
+		/// Description of a body for creating many bodies at once with addBodies().
+		/// The members correspond to the parameters of the Body constructor.
+		/// </summary>
+		struct BodyDesc {
+			std::string	m_name;								//The name of the body
+			void*		m_owner = nullptr;					//pointer to owner of this body, must be unique
+			Collider*	m_collider = &g_cube;				//geometric shape
+			glmvec3		m_scale{ 1,1,1 };					//scale factor in local space
+			glmvec3		m_positionW{ 0,0,0 };				//position in world space
+			glmquat		m_orientationLW{ 1,0,0,0 };			//orientation Local -> World
+			glmvec3		m_linear_velocityW{ 0,0,0 };		//starting linear velocity
+			glmvec3		m_angular_velocityW{ 0,0,0 };		//starting angular velocity
+			real		m_mass_inv{ 0 };					//1 over mass, 0 means infinite mass
+			real		m_restitution{ (real)0.2 };			//bounciness
+			real		m_friction{ 1 };					//friction coefficient
+			bool		m_ccd{ false };						//continuous collision detection
+			uint32_t	m_collision_category{ 1 };			//category bits of this body
+			uint32_t	m_collision_mask{ 0xffffffff };		//categories of bodies this body collides with
+			callback_move  m_on_move = nullptr;				//called if the body moves
+			callback_erase m_on_erase = nullptr;			//called if the body is erased
+		};
+
 		//--------------------------------------------------------------------------------------------------
 		//Contact between bodies
 
@@ -677,8 +1896,8 @@ namespace vpe {
 			/// </summary>
 			struct BodyPtr {
 				std::shared_ptr<Body> m_body;	//pointer to body
-				glmmat4 m_to_other;				//transform to other body
-				glmmat3 m_to_other_it;			//inverse transpose of transform to other body, for normal vectors
+				Transform m_to_other;			//transform to other body, its m_normal transforms normal vectors
+				uint32_t m_adjacency{ 0 };		//index of the contact in m_contacts of the body
 			};
 
 			/// <summary>
@@ -697,6 +1916,8 @@ namespace vpe {
 				};
 
 				glmvec3 m_positionW{ 0 };			//Position in world coordinates
+				glmvec3 m_normalW{ 0 };				//Contact normal, pointing from the reference to the incident body
+				std::array<glmvec3, 2> m_tangentW;	//Tangent vectors, the basis of the friction impulses
 				type_t	m_type{ type_t::none };	//Type of contact point
 				real	m_restitution;				//Restitution of velcoties after a collision (if reting then = 0)
 				real	m_friction;					//Friction coefficient
@@ -705,8 +1926,15 @@ namespace vpe {
 				glmmat3	m_K;			//mass matrix
 				glmmat3	m_K_inv;		//inverse mass matrix
 				real	m_vbias{ 0 };	//extra energy if bodies overlap
+				real	m_separation{ 0 };	//penetration when the contact was found, if <0 then there is interpenetration
+				uint64_t m_id{ 0 };		//feature ID, identifies the same point in the next loop
 				real	m_f{ 0 };		//accumulates force impulses along normal (1D) during a loop run
 				glmvec2	m_t{ 0 };		//accumulates force impulses along tangent (2D) during a loop run
+				glmvec3	m_r0L{ 0 };		//m_r0W rotated into the frame of body 0, for updating it in substeps
+				glmvec3	m_r1L{ 0 };		//m_r1W rotated into the frame of body 1
+				real	m_vn0{ 0 };		//closing speed before the substeps, for restitution
+				real	m_f_max{ 0 };	//largest normal impulse in the substeps, if 0 then the bodies did not touch
+				real	m_f_step{ 0 };	//sum of the normal impulses of all substeps, the impulse of the whole step
 			};
 
 			uint64_t	m_last_loop{ std::numeric_limits<uint64_t>::max() }; //number of last loop this contact was valid
@@ -716,32 +1944,88 @@ namespace vpe {
 			bool		m_active{ true };					//if deactive, the contact is ignored
 			glmvec3		m_separating_axisW{ 0 };			//Axis that separates the two bodies in world space
 
-			glmvec3					m_normalW{ 0 };			//Contact normal
-			std::array<glmvec3, 2>	m_tangentW;				//Contact tangent vector (calculated for each normal)
+			/// <summary>
+			/// The simplex GJK ended with, as vertex indices of both polytopes. It starts GJK in the next loop,
+			/// which then usually needs only one or two more support points.
+			/// </summary>
+			struct SimplexCache {
+				const Body*				m_ref{ nullptr };	//reference body when the simplex was stored, only compared
+				uint32_t				m_size{ 0 };		//number of simplex vertices, 0 if empty
+				std::array<uint_t, 4>	m_vertex_ref{};		//vertex indices into the polytope of the reference body
+				std::array<uint_t, 4>	m_vertex_inc{};		//vertex indices into the polytope of the incident body
+			} m_simplex;
+
+			/// <summary>
+			/// The feature SAT found for touching polytopes, and their relative pose at the last full SAT. As long as the 
+			/// pose stays close to it, SAT only tests the faces and edges around this feature.
+			/// </summary>
+			struct FeatureCache {
+				enum feature_t : uint32_t {
+					FEATURE_NONE,	//No feature, run the full SAT
+					FEATURE_FACE,	//Reference face and incident face
+					FEATURE_EDGE	//Edge of the reference body and edge of the incident body
+				};
+				feature_t		m_type{ FEATURE_NONE };		//type of the cached feature
+				const Body*		m_ref{ nullptr };			//reference body when the feature was stored, only compared
+				const Polytope*	m_polytope_ref{ nullptr };	//polytope of the reference body
+				const Polytope*	m_polytope_inc{ nullptr };	//polytope of the incident body
+				uint_t			m_feature_ref{ 0 };			//index of the face or edge of the reference polytope
+				uint_t			m_feature_inc{ 0 };			//index of the face or edge of the incident polytope
+				Transform		m_inc_to_ref;				//transform from incident to reference space at the last full SAT
+			} m_feature;
+			bool		m_touching{ false };				//true if a begin event passed the threshold, and no end event followed yet
+
+			glmvec3					m_normalW{ 0 };			//Contact normal of the first point, points of compound contacts can have other normals
 
 			std::vector<ContactPoint> m_contact_points{};		//Contact points in contact manifold in world space
 			std::vector<ContactPoint> m_old_contact_points{};	//Contact points in contact manifold in world space in prev loop
 		};
 
+		/// <summary>
+		/// Select which contact events are reported for a body, by setting its m_event_flags.
+		/// An event is reported if one of the two bodies has the flag.
+		/// </summary>
+		enum contact_event_flags_t : uint32_t {
+			CONTACT_EVENT_NONE = 0,			//Do not report anything
+			CONTACT_EVENT_BEGIN = 1 << 0,	//Bodies start touching
+			CONTACT_EVENT_PERSIST = 1 << 1,	//Bodies keep touching
+			CONTACT_EVENT_END = 1 << 2,		//Bodies stop touching
+			CONTACT_EVENT_ALL = CONTACT_EVENT_BEGIN | CONTACT_EVENT_PERSIST | CONTACT_EVENT_END
+		};
+
+		/// <summary>
+		/// A contact event. Events are collected in m_contact_events during tick(), and can be read after tick() returns.
+		/// </summary>
+		struct ContactEvent {
+			contact_event_flags_t	m_type;				//Begin, persist or end
+			std::shared_ptr<Body>	m_body_ref;			//Reference body of the contact
+			std::shared_ptr<Body>	m_body_inc;			//Incident body of the contact
+			glmvec3					m_positionW{ 0 };	//Center of the contact points (zero for end events)
+			glmvec3					m_normalW{ 0 };		//Contact normal, pointing from the reference to the incident body
+			real					m_impulse{ 0 };		//Sum of the normal impulses of the contact points (zero for end events)
+		};
+
 		/// <summary>
 		/// This function adds a new contact point to a contact manifold. 
 		/// </summary>
 		/// <param name="positionW">Position in world coordinates.</param>
 		/// <param name="normalW">Normal vector in world coordinates.</param>
 		/// <param name="penetration">Interpenetration depth. If <0 then there is interpenetration.</param>
-		void addContactPoint(Contact& contact, glmvec3 positionW, glmvec3 normalW, real penetration) {
+		/// <param name="id">Feature ID of the point, the same features of the same bodies must give the same ID.</param>
+		void addContactPoint(Contact& contact, glmvec3 positionW, glmvec3 normalW, real penetration, uint64_t id) {
 			if (contact.m_contact_points.size() == 0) {									//If first contact point
 				contact.m_normalW = normalW;											//Use its normal vector
-				geometry::computeBasis(normalW, contact.m_tangentW[0], contact.m_tangentW[1]);	//Calculate a tangent base
 				contact.m_num_resting = 0;
 			}
+			std::array<glmvec3, 2> tangentW;
+			geometry::computeBasis(normalW, tangentW[0], tangentW[1]);	//Calculate a tangent base
 			auto r0W = positionW - contact.m_body_ref.m_body->m_positionW;	//Position relative to body 0 center in world coordinates
 			auto r1W = positionW - contact.m_body_inc.m_body->m_positionW;	//Position relative to body 1 center in world coordinates
 			auto vrel = contact.m_body_inc.m_body->totalVelocityW(positionW) - contact.m_body_ref.m_body->totalVelocityW(positionW);
 			auto d = glm::dot(vrel, normalW);
 
-			Contact::ContactPoint::type_t type;	//determine the contact point type
-			real vbias = 0.0_real;
+			typename Contact::ContactPoint::type_t type;	//determine the contact point type
+			real vbias = (real)0.0;
 			if (d > m_sep_velocity) {										//Separating contact
 				type = Contact::ContactPoint::type_t::separating;
 			}
@@ -750,53 +2034,66 @@ namespace vpe {
 				contact.m_body_ref.m_body->m_num_resting++;
 				contact.m_body_inc.m_body->m_num_resting++;
 				contact.m_num_resting++;
-				vbias = (penetration < 0.0_real) ? m_bias * (real)m_sim_frequency * std::max(0.0_real, -penetration - m_slop) : 0.0_real;
+				vbias = (penetration < (real)0.0) ? m_bias * (real)m_sim_frequency * std::max((real)0.0, -penetration - m_slop) : (real)0.0;
 			}
 			else {
 				type = Contact::ContactPoint::type_t::colliding;			//Colliding contact
 			}
 
 			auto restitution = std::max(contact.m_body_ref.m_body->m_restitution, contact.m_body_inc.m_body->m_restitution);
-			restitution = (type == Contact::ContactPoint::type_t::colliding ? restitution : 0.0_real);
-			auto friction = (contact.m_body_ref.m_body->m_friction + contact.m_body_inc.m_body->m_friction) / 2.0_real;
+			restitution = (type == Contact::ContactPoint::type_t::colliding ? restitution : (real)0.0);
+			auto friction = (contact.m_body_ref.m_body->m_friction + contact.m_body_inc.m_body->m_friction) / (real)2.0;
 
 			auto mc0 = matrixCross3(r0W);	//Turn cross product into a matrix multiplication
 			auto mc1 = matrixCross3(r1W);
 
-			auto K = glmmat3{ 1.0_real } *contact.m_body_inc.m_body->m_mass_inv - mc1 * contact.m_body_inc.m_body->m_inertia_invW * mc1 + //mass matrix
-				glmmat3{ 1.0_real } *contact.m_body_ref.m_body->m_mass_inv - mc0 * contact.m_body_ref.m_body->m_inertia_invW * mc0;
+			auto K = glmmat3{ (real)1.0 } *contact.m_body_inc.m_body->m_mass_inv - mc1 * contact.m_body_inc.m_body->m_inertia_invW * mc1 + //mass matrix
+				glmmat3{ (real)1.0 } *contact.m_body_ref.m_body->m_mass_inv - mc0 * contact.m_body_ref.m_body->m_inertia_invW * mc0;
 
 			auto K_inv = glm::inverse(K);	//Inverse of mass matrix (roughly 1/mass)
 
-			contact.m_contact_points.emplace_back(positionW, type, restitution, friction, r0W, r1W, K, K_inv, vbias);
+			contact.m_contact_points.emplace_back(positionW, normalW, tangentW, type, restitution, friction, r0W, r1W, K, K_inv, vbias, penetration, id);
 		}
 
 
 		//--------------------------------------------------------------------------------------------------
 		//simulation parameters
 
-		real	m_collision_margin_factor = 1.001_real;		//This factor makes physics bodies a little larger to prevent visible interpenetration
-		real	m_collision_margin = 0.005_real;			//Also a little slack for detecting collisions
-		real	m_sep_velocity = 0.01_real;					//Limit such that a contact is seperating and not resting
-		real	m_bias = 0.2_real;							//A small addon to reduce interpenetration
-		real	m_slop = 0.001_real;						//This much penetration does not cause bias
-		real	m_resting_factor = 3.0_real;				//Factor for determining when a collision velocity is actually just resting
+		real	m_collision_margin_factor = (real)1.001;		//This factor makes physics bodies a little larger to prevent visible interpenetration
+		real	m_collision_margin = (real)0.005;			//Also a little slack for detecting collisions
+		real	m_sep_velocity = (real)0.01;					//Limit such that a contact is seperating and not resting
+		real	m_bias = (real)0.2;							//A small addon to reduce interpenetration
+		real	m_slop = (real)0.001;						//This much penetration does not cause bias
+		real	m_resting_factor = (real)3.0;				//Factor for determining when a collision velocity is actually just resting
 		double	m_sim_frequency = 60.0;						//Simulation frequency in Hertz
 		double	m_sim_delta_time = 1.0 / m_sim_frequency;	//The time to move forward the simulation
 		int		m_solver = 0;								//Select which solver to use
 		int		m_clamp_position = 1;						//No motions below a certain limit
 		int		m_use_vbias = 1;							//If true, the the bias is used for resting contacts
 		int		m_align_position_bias = 1;					//if true then look of current position bias is already enough
-		real	m_pbias_factor = 0.3_real;					//Add only a fraction of the current position bias.
-		int		m_use_warmstart = 1;						//If true then warm start resting contacts
+		real	m_pbias_factor = (real)0.3;					//Add only a fraction of the current position bias.
+		int		m_use_warmstart = 1;						//If true then warm start persistent contact points
 		int		m_use_warmstart_single = 0;					//If true then warm start resting contacts
 		int		m_loops = 30;								//Number of loops in each simulation step
+		int		m_substeps = 1;								//If > 1 then split each step into substeps with soft contacts
+		int		m_substep_loops = 1;						//Number of loops in each substep
+		real	m_contact_hertz = (real)60.0;				//Stiffness of soft contacts in substeps
+		real	m_contact_damping_ratio = (real)10.0;		//Damping of soft contacts in substeps
+		real	m_max_push_velocity = (real)3.0;			//Max velocity for pushing overlapping bodies apart in substeps
 		bool	m_deactivate = true;						//Do not move objects that are deactivated
+		int		m_use_sleeping = 1;							//If true then bodies that are deactivated long enough go to sleep
+		uint64_t m_sleep_loops = 30;						//Number of loops a body must be deactivated before it goes to sleep
+		real	m_ccd_motion_factor = (real)0.5;			//CCD bodies moving more than this times their radius in a step are swept
+		int		m_ccd_iterations = 20;						//Maximum number of conservative advancement steps per body pair
+		uint_t	m_gjk_cost = 1024;							//Two polytopes use GJK/EPA if faces plus edge pairs exceed this
+		int		m_gjk_iterations = 64;						//Maximum number of support points in GJK and in EPA
+		real	m_feature_cache_distance = (real)0.02;		//SAT reuses the last feature if the relative position moved less, as fraction of the reference size
+		real	m_feature_cache_rotation = (real)0.02;		//and the relative rotation changed less than this angle (radians)
 		real	m_num_active{ 0 };							//Number of currently active bodies
-		real	m_damping_incr = 10.0_real;					//Damp motion of slowly moving resting objects 
-		real	m_restitution = 0.2_real;					//Coefficient of restitution (bounciness)
-		real	m_friction = 1.0_real;						//Coefficient of friction
-		real	m_fps = 0.0_real;
+		real	m_damping_incr = (real)10.0;					//Damp motion of slowly moving resting objects 
+		real	m_restitution = (real)0.2;					//Coefficient of restitution (bounciness)
+		real	m_friction = (real)1.0;						//Coefficient of friction
+		real	m_fps = (real)0.0;
 
 		//--------------------------------------------------------------------------------------------------
 		//simulation state
@@ -819,6 +2116,42 @@ namespace vpe {
 		double			m_last_slot{ 0 };				//Last time the sim was calculated
 		double			m_next_slot{ m_sim_delta_time };//Next time for simulation
 
+		//--------------------------------------------------------------------------------------------------
+		//floating origin
+
+		using callback_shift_origin = std::function<void(glmvec3)>; //call this function when the origin is shifted
+
+		glm::dvec3		m_origin{ 0, 0, 0 };			//Absolute position of the current world origin, always in double
+		real			m_ground_height{ 0 };			//Height of the ground plane in current world coordinates
+		glmvec3			m_origin_focusW{ 0, 0, 0 };		//Focus point for automatic rebasing, e.g. the camera position
+		real			m_origin_rebase_distance{ 0 };	//If > 0 then rebase automatically if the focus is further away from the origin
+		callback_shift_origin m_on_shift_origin = nullptr;	//called after the origin has been shifted
+
+		//--------------------------------------------------------------------------------------------------
+		//memory pools
+
+		/// <summary>
+		/// The world owns pools for bodies and contacts. Each pool hands out fixed size blocks from
+		/// larger slabs and keeps freed blocks in free lists, so long running worlds do not fragment the heap and do not 
+		/// contend for the global allocator. All other memory of the world (e.g. forces, constraint arrays) comes from m_memory_resource,
+		/// which can be supplied by the user when constructing the world. The pools are declared before all containers,
+		/// so they outlive the objects allocated from them. Bodies created by makeBody() must not outlive the world.
+		/// </summary>
+		std::pmr::memory_resource*				m_memory_resource{ std::pmr::get_default_resource() };	//upstream for all world memory
+		std::pmr::unsynchronized_pool_resource	m_body_pool{ m_memory_resource };			//pool for bodies
+		std::pmr::unsynchronized_pool_resource	m_contact_pool{ m_memory_resource };		//pool for contacts
+
+		/// <summary>
+		/// Create a new body in the body pool of this world. The parameters are those of the Body constructor, without the world pointer.
+		/// The body is not added to the world, call addBody() for this.
+		/// </summary>
+		/// <param name="...args">Parameters for the Body constructor.</param>
+		/// <returns>Shared pointer to the new body.</returns>
+		template<typename... Args>
+		std::shared_ptr<Body> makeBody(Args&&... args) {
+			return std::allocate_shared<Body>(std::pmr::polymorphic_allocator<Body>{ &m_body_pool }, this, std::forward<Args>(args)...);
+		}
+
 		/// <summary>
 		/// Wrapper class that provides parts of a std::unordered_map like interface while using a std::vector as the underlying data structure.
 		/// As inserting, erasing and targeted lookup for bodies are barely used and the main use case of this data structure is linear iteration
@@ -859,11 +2192,11 @@ namespace vpe {
 				});
 			}
 
-			typename std::vector<pair_t>::iterator find(const key_type& key) const {
+			typename std::vector<pair_t>::iterator find(const key_type& key) {
 				return std::find_if(m_vector.begin(), m_vector.end(), [&key](auto pair) { return pair.first == key; });
 			}
 
-			pair_t& operator [] (const key_type& key) const {
+			pair_t& operator [] (const key_type& key) {
 				auto element = this->find(key);
 				if (element != m_vector.end()) {
 					return *element;
@@ -873,7 +2206,7 @@ namespace vpe {
 				}
 			}
 
-			pair_t& at(const key_type& key) const {
+			pair_t& at(const key_type& key) {
 				return (*this)[key];
 			}
 
@@ -881,7 +2214,7 @@ namespace vpe {
 				m_vector.clear();
 			}
 
-			typename std::vector<pair_t>& get_vector() const {
+			typename std::vector<pair_t>& get_vector() {
 				return m_vector;
 			}
 
@@ -908,6 +2241,11 @@ namespace vpe {
 			void reserve(size_t size) {
 				m_vector.reserve(size);
 			}
+
+			template<typename P>
+			size_t erase_if(P&& pred) {
+				return std::erase_if(m_vector, std::forward<P>(pred));
+			}
 		};
 
 		/// <summary>
@@ -926,23 +2264,27 @@ namespace vpe {
 		real		m_width{ 3 };								//grid cell width (m)
 		std::unordered_map<intpair_t, body_map > m_grid;	//broadphase grid of cells.
 
-		std::shared_ptr<Body> m_ground = std::make_shared<Body>(Body{ this, "Ground", nullptr, &g_cube, {1000, 1000, 1000}, {0, -500.0_real, 0}, {1,0,0,0} });
-		body_map	m_global_cell{ { nullptr, m_ground } };	//cell containing only the ground
+		std::shared_ptr<Body> m_ground = makeBody("Ground", nullptr, &g_cube, glmvec3{ 1000, 1000, 1000 }, glmvec3{ 0, -(real)500.0 * m_collision_margin_factor, 0 });	//the top face is the ground plane, also for ray casts and CCD
+		body_map	m_global_cell{ { nullptr, m_ground } };	//cell containing the ground and the triangle meshes, paired with all cells
 
 		/// <summary>
 		/// A contact is a struct that contains contact information for a pair of bodies A and B.
 		/// The map hash function alsways uses the smaller of A and B first, so there is only one contact for
 		/// A/B and B/A.
 		/// </summary>
-		std::unordered_map<voidppair_t, Contact> m_contacts;	//possible contacts resulting from broadphase
+		std::pmr::unordered_map<voidppair_t, Contact> m_contacts{ &m_contact_pool };	//possible contacts resulting from broadphase
 
-		std::unordered_map<void*, callback_collide> m_collider;	//Call these callbacks if there is a collision for a specific body
+		std::vector<ContactEvent>	m_contact_events;		//Contact events of the last tick(), read them after tick() returns
+		std::vector<ContactEvent>	m_erase_events;			//End events of contacts of erased bodies, reported by the next tick()
+		std::vector<Contact*>		m_event_contacts;		//Touching contacts that need begin or persist events after the solver
+		real m_event_impulse_threshold{ 0 };				//Begin and persist events with smaller impulses are not reported
 
-		/// <summary>
-		///  Holds all constraints 
-		/// </summary>
-		class Constraint;
-		std::vector<std::shared_ptr<Constraint>> m_constraints;
+		class Constraint;		//constraints are stored in m_constraints, an array for each constraint type
+
+		std::unordered_map<voidppair_t, uint32_t> m_ignore_pairs;	//bodies connected by constraints that do not collide, and the number of these constraints
+
+		using callback_pair_filter = std::function<bool(const Body&, const Body&)>;	//return false if two bodies must not collide
+		callback_pair_filter m_pair_filter = nullptr;	//if set, called in the broadphase for pairs that pass the other filters
 
 		//-----------------------------------------------------------------------------------------------------
 
@@ -956,6 +2298,818 @@ namespace vpe {
 		}
 		std::shared_ptr<Body> m_body; // the body we can move with the debug panel (always the latest body created)
 
+		//-----------------------------------------------------------------------------------------------------
+		//ray casting
+
+		using raycast_filter = std::function<bool(const Body&)>;	//return false to ignore a body in a ray cast
+
+		/// <summary>
+		/// Result of a ray cast.
+		/// </summary>
+		struct RaycastHit {
+			std::shared_ptr<Body>	m_body;					//the body that was hit, nullptr if nothing was hit
+			glmvec3					m_positionW{ 0 };		//hit point in world space
+			glmvec3					m_normalW{ 0 };			//normal of the hit face in world space
+			Face*					m_face{ nullptr };		//the face of the polytope that was hit, nullptr for other shapes
+			real					m_distance{ 0 };		//distance from the ray origin to the hit point
+		};
+
+		/// <summary>
+		/// Intersect a ray with a sphere or capsule body, in closed form. The ray is intersected with the cylinder around
+		/// the segment and the spheres at both ends. Bodies that contain the ray origin are ignored.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <param name="originW">Ray origin in world space.</param>
+		/// <param name="dirW">Normalized ray direction in world space.</param>
+		/// <param name="hit">Closest hit so far, updated if the body is hit closer than hit.m_distance.</param>
+		/// <returns>True if the body was hit closer than hit.m_distance.</returns>
+		bool raycastRound(const std::shared_ptr<Body>& body, glmvec3 originW, glmvec3 dirW, RaycastHit& hit) {
+			auto core = body->roundCore(body->m_model);
+			real r2 = core.m_radius * core.m_radius;
+			glmvec3 closestW = closestPointSegment(originW, core.m_aW, core.m_bW);
+			if (glm::dot(originW - closestW, originW - closestW) < r2) return false;	//origin is inside
+
+			real t_hit = std::numeric_limits<real>::max();
+			auto sphere = [&](glmvec3 centerW) {
+				glmvec3 oc = originW - centerW;
+				real b = glm::dot(oc, dirW);
+				real disc = b * b - glm::dot(oc, oc) + r2;
+				if (disc >= (real)0.0 && -b - std::sqrt(disc) > (real)0.0) t_hit = std::min(t_hit, -b - std::sqrt(disc));
+			};
+			sphere(core.m_aW);
+			sphere(core.m_bW);
+
+			glmvec3 segW = core.m_bW - core.m_aW;						//cylinder, https://iquilezles.org/articles/intersectors/
+			real seg2 = glm::dot(segW, segW);
+			if (seg2 > c_eps) {
+				glmvec3 oa = originW - core.m_aW;
+				real sd = glm::dot(segW, dirW), so = glm::dot(segW, oa);
+				real k2 = seg2 - sd * sd;
+				real k1 = seg2 * glm::dot(oa, dirW) - so * sd;
+				real k0 = seg2 * glm::dot(oa, oa) - so * so - r2 * seg2;
+				real disc = k1 * k1 - k2 * k0;
+				if (k2 > c_eps && disc >= (real)0.0) {
+					real t = (-k1 - std::sqrt(disc)) / k2;
+					real y = so + t * sd;									//position along the segment
+					if (t > (real)0.0 && y > (real)0.0 && y < seg2) t_hit = std::min(t_hit, t);
+				}
+			}
+			if (t_hit >= hit.m_distance) return false;
+
+			glmvec3 positionW = originW + t_hit * dirW;
+			hit = { body, positionW, glm::normalize(positionW - closestPointSegment(positionW, core.m_aW, core.m_bW)), nullptr, t_hit };
+			return true;
+		}
+
+		/// <summary>
+		/// Intersect a ray with a triangle mesh. The hierarchy is traversed with a slab test for each box, and the triangles 
+		/// in the leaves are tested with the Moeller-Trumbore algorithm. Only the front sides of triangles are hit.
+		/// </summary>
+		/// <param name="body">The body, its shape is a triangle mesh.</param>
+		/// <param name="originW">Ray origin in world space.</param>
+		/// <param name="dirW">Normalized ray direction in world space.</param>
+		/// <param name="hit">Closest hit so far, updated if the body is hit closer than hit.m_distance.</param>
+		/// <returns>True if the body was hit closer than hit.m_distance.</returns>
+		bool raycastMesh(const std::shared_ptr<Body>& body, glmvec3 originW, glmvec3 dirW, RaycastHit& hit) {
+			auto* mesh = static_cast<TriangleMesh*>(body->m_collider);
+			glmvec3 originL = body->m_model_inv.point(originW);			//points on the ray have the same parameter t in both spaces
+			glmvec3 dirL = body->m_model_inv.vector(dirW);
+			glmvec3 dir_inv = (real)1.0 / dirL;
+			real t_hit = hit.m_distance;
+			int64_t tri_hit = -1;
+
+			std::array<uint32_t, TriangleMesh::c_max_depth> stack;
+			size_t top = 0;
+			stack[top++] = 0;
+			while (top > 0) {
+				uint32_t n = stack[--top];
+				auto& node = mesh->m_nodes[n];
+				glmvec3 t0 = (node.m_min - originL) * dir_inv, t1 = (node.m_max - originL) * dir_inv;
+				glmvec3 tmin = glm::min(t0, t1), tmax = glm::max(t0, t1);
+				real t_enter = std::max({ tmin.x, tmin.y, tmin.z, (real)0.0 }), t_exit = std::min({ tmax.x, tmax.y, tmax.z, t_hit });
+				if (!(t_enter <= t_exit)) continue;						//also catches NaN from 0 * inf
+				if (node.m_count == 0) {
+					stack[top++] = node.m_right;
+					stack[top++] = n + 1;
+					continue;
+				}
+				for (uint32_t i = node.m_first; i < node.m_first + node.m_count; ++i) {
+					auto& tri = mesh->m_triangles[i];
+					glmvec3 a = mesh->m_positionsL[tri[0]];
+					glmvec3 e1 = mesh->m_positionsL[tri[1]] - a, e2 = mesh->m_positionsL[tri[2]] - a;
+					glmvec3 p = glm::cross(dirL, e2);
+					real det = glm::dot(e1, p);								//scales with the lengths of the ray direction and the edges
+					if (det <= c_eps * glm::length(dirL) * std::sqrt(glm::dot(e1, e1) * glm::dot(e2, e2))) continue;	//back side or parallel
+					glmvec3 s = originL - a;
+					real u = glm::dot(s, p) / det;
+					if (u < (real)0.0 || u > (real)1.0) continue;
+					glmvec3 q = glm::cross(s, e1);
+					real v = glm::dot(dirL, q) / det;
+					if (v < (real)0.0 || u + v > (real)1.0) continue;
+					real t = glm::dot(e2, q) / det;
+					if (t > (real)0.0 && t < t_hit) { t_hit = t; tri_hit = i; }
+				}
+			}
+			if (tri_hit < 0) return false;
+			hit = { body, originW + t_hit * dirW, glm::normalize(body->m_model.normal(mesh->m_normalsL[tri_hit])), nullptr, t_hit };
+			return true;
+		}
+
+		/// <summary>
+		/// Intersect a ray with a body. The ray is transformed into local space and clipped against the face planes
+		/// of the polytope (slab test). Bodies that contain the ray origin are ignored.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <param name="originW">Ray origin in world space.</param>
+		/// <param name="dirW">Normalized ray direction in world space.</param>
+		/// <param name="hit">Closest hit so far, updated if the body is hit closer than hit.m_distance.</param>
+		/// <returns>True if the body was hit closer than hit.m_distance.</returns>
+		bool raycastBody(const std::shared_ptr<Body>& body, glmvec3 originW, glmvec3 dirW, RaycastHit& hit) {
+			glmvec3 oc = body->m_positionW - originW;						//quick test against the bounding sphere
+			real tc = glm::dot(oc, dirW);
+			real radius = body->boundingSphereRadius();
+			if (tc - radius > hit.m_distance || glm::dot(oc, oc) - tc * tc > radius * radius) return false;
+			if (!body->m_parts.empty()) {									//the closest part of a compound, reported as the body
+				bool res = false;
+				for (auto& part : body->m_parts) {
+					if (raycastBody(part, originW, dirW, hit)) { hit.m_body = body; res = true; }
+				}
+				return res;
+			}
+			if (body->m_collider->m_shape == SHAPE_MESH) return raycastMesh(body, originW, dirW, hit);
+			if (!body->m_polytope) return raycastRound(body, originW, dirW, hit);
+
+			glmvec3 originL = body->m_model_inv.point(originW);			//points on the ray have the same parameter t in both spaces
+			glmvec3 dirL = body->m_model_inv.vector(dirW);
+			auto& planes = body->m_polytope->m_planes;
+			constexpr size_t lanes = Polytope::c_lanes;
+			constexpr real inf = std::numeric_limits<real>::infinity();
+			std::array<real, lanes> enter, exit;						//one interval per lane, without branches
+			enter.fill((real)0.0);
+			exit.fill(hit.m_distance);
+			for (size_t i = 0; i < planes.m_d.size(); i += lanes) {
+				for (size_t l = 0; l < lanes; ++l) {
+					real denom = planes.m_nx[i + l] * dirL.x + planes.m_ny[i + l] * dirL.y + planes.m_nz[i + l] * dirL.z;
+					real dist = planes.m_d[i + l] - (planes.m_nx[i + l] * originL.x + planes.m_ny[i + l] * originL.y + planes.m_nz[i + l] * originL.z);	//>0 if origin is inside
+					real t = dist / denom;
+					enter[l] = denom < 0 && t > enter[l] ? t : enter[l];	//ray enters the half space
+					exit[l] = denom > 0 && t < exit[l] ? t : exit[l];		//ray leaves the half space
+					exit[l] = denom == 0 && dist < 0 ? -inf : exit[l];		//parallel and outside
+				}
+			}
+			real t_enter = *std::ranges::max_element(enter);
+			real t_exit = *std::ranges::min_element(exit);
+			if (t_enter > t_exit || !(t_enter > (real)0.0)) return false;	//missed, or origin is inside the body
+
+			Face* face_enter{ nullptr };								//the entering face is only needed for a hit
+			real t_face = -inf;
+			for (auto& face : body->m_polytope->m_faces) {
+				real denom = glm::dot(face.m_normalL, dirL);
+				if (denom >= 0) continue;
+				real t = glm::dot(face.m_normalL, face.m_face_vertex_ptrs[0]->m_positionL - originL) / denom;
+				if (t > t_face) { t_face = t; face_enter = &face; }
+			}
+
+			hit = { body, originW + t_enter * dirW, glm::normalize(body->m_model.normal(face_enter->m_normalL)), face_enter, t_enter };
+			return true;
+		}
+
+		/// <summary>
+		/// Cast a ray and find the closest body that it hits, including the ground. The broadphase grid is traversed along the 
+		/// ray with a 2D DDA, and only bodies in cells around the ray are tested. The traversal stops at the first hit.
+		/// If the ray would visit more cells than the grid contains, all cells are tested instead.
+		/// </summary>
+		/// <param name="originW">Ray origin in world space.</param>
+		/// <param name="dirW">Ray direction in world space, need not be normalized.</param>
+		/// <param name="max_dist">Maximum distance of a hit.</param>
+		/// <param name="filter">If set, bodies for which the filter returns false are ignored.</param>
+		/// <returns>The closest hit. m_body is nullptr if nothing was hit.</returns>
+		RaycastHit raycast(glmvec3 originW, glmvec3 dirW, real max_dist, const raycast_filter& filter = nullptr) {
+			std::unordered_set<intpair_t> tested;
+			return raycast(originW, dirW, max_dist, filter, tested);
+		}
+
+		/// <summary>
+		/// Cast a ray, reusing the memory of a set of tested cells. See raycast() above.
+		/// </summary>
+		/// <param name="tested">Set of tested cells, is cleared first.</param>
+		RaycastHit raycast(glmvec3 originW, glmvec3 dirW, real max_dist, const raycast_filter& filter, std::unordered_set<intpair_t>& tested) {
+			RaycastHit hit{};
+			hit.m_distance = max_dist;
+			real len = glm::length(dirW);
+			if (len < c_eps) return hit;
+			dirW /= len;
+
+			auto test = [&](const std::shared_ptr<Body>& body) {
+				if (!filter || filter(*body)) raycastBody(body, originW, dirW, hit);
+			};
+			for (auto& body : m_global_cell) { test(body.second); }	//the ground and the meshes
+
+			real num_steps = (std::abs(dirW.x) + std::abs(dirW.z)) * max_dist / m_width;	//number of cells the ray visits
+			if (!(num_steps < (real)m_grid.size())) {	//cheaper to test all cells, also if num_steps is NaN (vertical ray, infinite max_dist)
+				for (auto& cell : m_grid) { for (auto& body : cell.second) { test(body.second); } }
+				return hit;
+			}
+
+			tested.clear();								//bodies can reach into neighboring cells, so test each cell only once
+			auto test_around = [&](real x, real z) {
+				int_t cx = static_cast<int_t>(x / m_width);	//same cell coordinates as addGrid()
+				int_t cz = static_cast<int_t>(z / m_width);
+				for (int_t dx = -1; dx <= 1; ++dx) {
+					for (int_t dz = -1; dz <= 1; ++dz) {
+						intpair_t cell{ cx + dx, cz + dz };
+						if (!tested.insert(cell).second) continue;
+						auto it = m_grid.find(cell);
+						if (it != m_grid.end()) { for (auto& body : it->second) { test(body.second); } }
+					}
+				}
+			};
+
+			//DDA on a regular grid with cells [k*width, (k+1)*width), each such cell lies within one broadphase cell
+			constexpr real inf = std::numeric_limits<real>::max();
+			int_t ix = static_cast<int_t>(std::floor(originW.x / m_width));
+			int_t iz = static_cast<int_t>(std::floor(originW.z / m_width));
+			int_t step_x = dirW.x > 0 ? 1 : -1;
+			int_t step_z = dirW.z > 0 ? 1 : -1;
+			real delta_x = dirW.x != 0 ? m_width / std::abs(dirW.x) : inf;
+			real delta_z = dirW.z != 0 ? m_width / std::abs(dirW.z) : inf;
+			real next_x = dirW.x != 0 ? ((ix + (dirW.x > 0)) * m_width - originW.x) / dirW.x : inf;
+			real next_z = dirW.z != 0 ? ((iz + (dirW.z > 0)) * m_width - originW.z) / dirW.z : inf;
+
+			for (real t = 0; t <= hit.m_distance; ) {	//a body hit closer than t has already been tested
+				test_around((ix + (real)0.5) * m_width, (iz + (real)0.5) * m_width);
+				if (next_x >= inf && next_z >= inf) break;		//the ray does not cross another cell boundary
+				if (next_x < next_z) { t = next_x; next_x += delta_x; ix += step_x; }
+				else { t = next_z; next_z += delta_z; iz += step_z; }
+			}
+			return hit;
+		}
+
+		/// <summary>
+		/// A ray for batched ray casts.
+		/// </summary>
+		struct Ray {
+			glmvec3 m_originW{ 0 };		//ray origin in world space
+			glmvec3 m_dirW{ 0, 0, 1 };	//ray direction in world space, need not be normalized
+			real	m_max_dist{ 100 };	//maximum distance of a hit
+		};
+
+		/// <summary>
+		/// Cast many rays at once, e.g. for AI line of sight or audio occlusion. The batch is split into
+		/// contiguous chunks, one per thread, and each thread reuses its memory for all of its rays. 
+		/// The world must not be changed while the batch runs, and the filter must be thread safe.
+		/// </summary>
+		/// <param name="rays">The rays.</param>
+		/// <param name="hits">Results, one for each ray, must be at least as large as rays.</param>
+		/// <param name="filter">If set, bodies for which the filter returns false are ignored.</param>
+		/// <param name="num_threads">Number of threads to use, including the calling thread.</param>
+		void raycastBatch(std::span<const Ray> rays, std::span<RaycastHit> hits, const raycast_filter& filter = nullptr, uint32_t num_threads = 1) {
+			assert(hits.size() >= rays.size());
+			auto work = [&](size_t first, size_t last) {
+				std::unordered_set<intpair_t> tested;
+				for (size_t i = first; i < last; ++i) {
+					hits[i] = raycast(rays[i].m_originW, rays[i].m_dirW, rays[i].m_max_dist, filter, tested);
+				}
+			};
+
+			size_t chunk = (rays.size() + std::max(num_threads, 1u) - 1) / std::max(num_threads, 1u);
+			if (chunk == 0) return;
+			std::vector<std::jthread> threads;
+			for (size_t first = chunk; first < rays.size(); first += chunk) {	//the calling thread works on the first chunk
+				threads.emplace_back(work, first, std::min(first + chunk, rays.size()));
+			}
+			work(0, std::min(chunk, rays.size()));
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//round shapes
+
+		/// <summary>
+		/// Closest point on a segment to a point.
+		/// </summary>
+		static glmvec3 closestPointSegment(glmvec3 pW, glmvec3 aW, glmvec3 bW) {
+			glmvec3 eW = bW - aW;
+			real len2 = glm::dot(eW, eW);
+			if (len2 < c_eps) return aW;
+			return aW + std::clamp(glm::dot(pW - aW, eW) / len2, (real)0.0, (real)1.0) * eW;
+		}
+
+		/// <summary>
+		/// Closest points of two segments. See Ericson, Real-Time Collision Detection, 5.1.9.
+		/// </summary>
+		/// <param name="a0W">Start of first segment.</param>
+		/// <param name="b0W">End of first segment.</param>
+		/// <param name="a1W">Start of second segment.</param>
+		/// <param name="b1W">End of second segment.</param>
+		/// <param name="p0W">Closest point on the first segment.</param>
+		/// <param name="p1W">Closest point on the second segment.</param>
+		static void closestPointsSegments(glmvec3 a0W, glmvec3 b0W, glmvec3 a1W, glmvec3 b1W, glmvec3& p0W, glmvec3& p1W) {
+			glmvec3 d0 = b0W - a0W, d1 = b1W - a1W, r = a0W - a1W;
+			real l0 = glm::dot(d0, d0), l1 = glm::dot(d1, d1), f = glm::dot(d1, r);
+			real s{ 0 }, t{ 0 };
+			if (l0 < c_eps && l1 < c_eps) { p0W = a0W; p1W = a1W; return; }	//both are points
+			if (l0 < c_eps) { t = std::clamp(f / l1, (real)0.0, (real)1.0); }	//first is a point
+			else {
+				real c = glm::dot(d0, r);
+				if (l1 < c_eps) { s = std::clamp(-c / l0, (real)0.0, (real)1.0); }	//second is a point
+				else {
+					real b = glm::dot(d0, d1);
+					real denom = l0 * l1 - b * b;									//0 if parallel, then pick any s
+					s = denom > c_eps ? std::clamp((b * f - c * l1) / denom, (real)0.0, (real)1.0) : (real)0.0;
+					t = (b * s + f) / l1;
+					if (t < (real)0.0) { t = (real)0.0; s = std::clamp(-c / l0, (real)0.0, (real)1.0); }
+					else if (t > (real)1.0) { t = (real)1.0; s = std::clamp((b - c) / l0, (real)0.0, (real)1.0); }
+				}
+			}
+			p0W = a0W + s * d0;
+			p1W = a1W + t * d1;
+		}
+
+		/// <summary>
+		/// Compute the largest separation of a transformed polytope and a round shape. The candidate axes are the face normals
+		/// of the polytope, the cross products of its edges with the segment, and the directions between the closest points
+		/// of the edges and the segment. The separation along any axis is a lower bound for the distance.
+		/// </summary>
+		/// <param name="stop">Return as soon as the separation is larger than this.</param>
+		/// <returns>The largest separation found. If negative, the shapes overlap.</returns>
+		static real separation(const Polytope& polytope, const Transform& model, const RoundCore& core, real stop = std::numeric_limits<real>::max()) {
+			real max_sep = -std::numeric_limits<real>::max();
+			auto axis = [&](glmvec3 nW) {
+				real len = glm::length(nW);
+				if (len < c_eps) return false;
+				nW /= len;
+				real a = glm::dot(nW, core.m_aW), b = glm::dot(nW, core.m_bW);
+				max_sep = std::max({ max_sep, std::min(a, b) - core.m_radius - supportDistance(polytope, model, nW),
+					-supportDistance(polytope, model, -nW) - std::max(a, b) - core.m_radius });
+				return max_sep > stop;
+			};
+			glmvec3 segW = core.m_bW - core.m_aW;
+			for (auto& face : polytope.m_faces) { if (axis(model.normal(face.m_normalL))) return max_sep; }
+			for (auto& edge : polytope.m_edges) {
+				glmvec3 aW = model.point(edge.m_first_vertexL.m_positionL);
+				glmvec3 eW = model.vector(edge.m_edgeL);
+				glmvec3 pE, pC;
+				closestPointsSegments(aW, aW + eW, core.m_aW, core.m_bW, pE, pC);
+				if (axis(pC - pE) || axis(glm::cross(eW, segW))) return max_sep;	//also covers the vertices at both ends
+			}
+			return max_sep;
+		}
+
+		/// <summary>
+		/// Distance of two round shapes, negative if they overlap.
+		/// </summary>
+		static real separation(const RoundCore& coreA, const RoundCore& coreB) {
+			glmvec3 pA, pB;
+			closestPointsSegments(coreA.m_aW, coreA.m_bW, coreB.m_aW, coreB.m_bW, pA, pB);
+			return glm::length(pB - pA) - coreA.m_radius - coreB.m_radius;
+		}
+
+		/// <summary>
+		/// Smallest separation of the triangles of a mesh from a query region. The BVH finds the triangles whose boxes overlap 
+		/// the bounding sphere of the region grown by stop, all other triangles are further away than stop.
+		/// Each triangle is set into a local triangle polytope and passed to a separation function. The narrow phase triangle 
+		/// m_triangle is not touched, so queries can run during the narrow phase.
+		/// </summary>
+		/// <param name="mesh_body">The mesh body.</param>
+		/// <param name="model_mesh">Transform from mesh space to world space.</param>
+		/// <param name="centerW">Center of the bounding sphere of the query region.</param>
+		/// <param name="radius">Radius of the bounding sphere of the query region.</param>
+		/// <param name="stop">Triangles further away than this need not be tested.</param>
+		/// <param name="one_sided">If true, triangles behind which centerW lies are skipped, like in the narrow phase.</param>
+		/// <param name="separation_triangle">Returns the separation of the triangle polytope, placed with model_mesh, from the region.</param>
+		/// <returns>The smallest separation of the tested triangles, or the largest real if no triangle was tested.</returns>
+		static real separationMesh(const Body& mesh_body, const Transform& model_mesh, glmvec3 centerW, real radius, real stop, bool one_sided, auto&& separation_triangle) {
+			auto* mesh = static_cast<TriangleMesh*>(mesh_body.m_collider);
+			glmvec3 centerL = model_mesh.inverse().point(centerW);
+			glmvec3 extentL = (radius + std::max(stop, (real)0.0)) / glm::abs(mesh_body.m_scale);	//box around the grown sphere in local space
+			real min_sep = std::numeric_limits<real>::max();
+			Polytope triangle = TriangleMesh::makeTriangle();
+			mesh->query(centerL - extentL, centerL + extentL, [&](uint32_t i) {
+				if (one_sided && glm::dot(mesh->m_normalsL[i], centerL - mesh->m_positionsL[mesh->m_triangles[i][0]]) < (real)0.0) return;	//behind the triangle
+				mesh->setTriangle(triangle, i);
+				min_sep = std::min(min_sep, separation_triangle(triangle));
+			});
+			return min_sep;
+		}
+
+		/// <summary>
+		/// Largest separation of a transformed polytope and a body that is not a mesh. A compound gives its closest child.
+		/// </summary>
+		/// <returns>A lower bound for the distance. If negative, they overlap.</returns>
+		static real separation(const Polytope& polytope, const Transform& model, const Body& body, const Transform& model_body) {
+			if (!body.m_parts.empty()) {
+				auto& children = static_cast<Compound*>(body.m_collider)->m_children;
+				real min_sep = std::numeric_limits<real>::max();
+				for (size_t i = 0; i < children.size(); ++i) min_sep = std::min(min_sep, separation(polytope, model, *body.m_parts[i], model_body * children[i].m_transform));
+				return min_sep;
+			}
+			if (body.m_polytope) return separation(polytope, model, *body.m_polytope, model_body);
+			return separation(polytope, model, body.roundCore(model_body));
+		}
+
+		/// <summary>
+		/// Largest separation of two bodies of any shape, placed with the given transforms. See the functions above.
+		/// A triangle mesh gives the smallest separation of its one sided triangles near the other body.
+		/// </summary>
+		/// <param name="stop">Meshes only test triangles up to this distance, see separationMesh().</param>
+		/// <returns>A lower bound for the distance of the bodies. If negative, they overlap.</returns>
+		static real separation(const Body& bodyA, const Transform& modelA, const Body& bodyB, const Transform& modelB, real stop = std::numeric_limits<real>::max()) {
+			if (bodyB.m_collider->m_shape == SHAPE_MESH) return separation(bodyB, modelB, bodyA, modelA, stop);
+			if (bodyA.m_collider->m_shape == SHAPE_MESH) {
+				return separationMesh(bodyA, modelA, modelB.m_translation, bodyB.boundingSphereRadius(), stop, true,
+					[&](const Polytope& triangle) { return separation(triangle, modelA, bodyB, modelB); });
+			}
+			if (!bodyB.m_parts.empty() && bodyA.m_parts.empty()) return separation(bodyB, modelB, bodyA, modelA, stop);
+			if (!bodyA.m_parts.empty()) {										//closest child of a compound
+				auto& children = static_cast<Compound*>(bodyA.m_collider)->m_children;
+				real min_sep = std::numeric_limits<real>::max();
+				for (size_t i = 0; i < children.size(); ++i) min_sep = std::min(min_sep, separation(*bodyA.m_parts[i], modelA * children[i].m_transform, bodyB, modelB, stop));
+				return min_sep;
+			}
+			if (bodyA.m_polytope && bodyB.m_polytope) return separation(*bodyA.m_polytope, modelA, *bodyB.m_polytope, modelB);
+			if (bodyA.m_polytope) return separation(*bodyA.m_polytope, modelA, bodyB.roundCore(modelB));
+			if (bodyB.m_polytope) return separation(*bodyB.m_polytope, modelB, bodyA.roundCore(modelA));
+			return separation(bodyA.roundCore(modelA), bodyB.roundCore(modelB));
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//overlap queries
+
+		/// <summary>
+		/// Maximum distance of the vertices of a transformed polytope along a world space direction.
+		/// </summary>
+		/// <param name="polytope">The polytope.</param>
+		/// <param name="model">Transform from polytope space to world space.</param>
+		/// <param name="dirW">Direction in world space.</param>
+		/// <returns>Maximum of dot(dirW, vertex) over all vertices in world space.</returns>
+		static real supportDistance(const Polytope& polytope, const Transform& model, glmvec3 dirW) {
+			glmvec3 dirL = glm::transpose(model.m_linear) * dirW;		//dot(d, L*v + t) = dot(L^T*d, v) + dot(d, t)
+			real max_dist = -std::numeric_limits<real>::max();
+			for (auto& vertex : polytope.m_vertices) { max_dist = std::max(max_dist, glm::dot(dirL, vertex.m_positionL)); }
+			return max_dist + glm::dot(dirW, model.m_translation);
+		}
+
+		/// <summary>
+		/// Compute the largest separation of two transformed polytopes over the axes that SAT() uses: the face normals 
+		/// of both polytopes and the cross products of all edge pairs. No contact manifold is computed. 
+		/// The separation along any axis is a lower bound for the distance of the polytopes.
+		/// </summary>
+		/// <param name="stop">Return as soon as the separation is larger than this.</param>
+		/// <returns>The largest separation found. If negative, the polytopes overlap.</returns>
+		static real separation(const Polytope& polyA, const Transform& modelA, const Polytope& polyB, const Transform& modelB,
+			real stop = std::numeric_limits<real>::max()) {
+			real max_sep = -std::numeric_limits<real>::max();
+			auto axis = [&](glmvec3 nW) {				//separation along an axis, in both directions
+				real len = glm::length(nW);
+				if (len < c_eps) return false;			//parallel edges do not give an axis
+				nW /= len;
+				max_sep = std::max({ max_sep, -supportDistance(polyB, modelB, -nW) - supportDistance(polyA, modelA, nW),
+					-supportDistance(polyA, modelA, -nW) - supportDistance(polyB, modelB, nW) });
+				return max_sep > stop;
+			};
+			for (auto& face : polyA.m_faces) { if (axis(modelA.normal(face.m_normalL))) return max_sep; }
+			for (auto& face : polyB.m_faces) { if (axis(modelB.normal(face.m_normalL))) return max_sep; }
+			for (auto& edgeA : polyA.m_edges) {
+				glmvec3 eA = modelA.vector(edgeA.m_edgeL);
+				for (auto& edgeB : polyB.m_edges) { if (axis(glm::cross(eA, modelB.vector(edgeB.m_edgeL)))) return max_sep; }
+			}
+			return max_sep;
+		}
+
+		/// <summary>
+		/// Test whether two transformed polytopes overlap, i.e. no separating axis exists.
+		/// </summary>
+		/// <returns>True if the polytopes overlap.</returns>
+		static bool overlapPolytopes(const Polytope& polyA, const Transform& modelA, const Polytope& polyB, const Transform& modelB) {
+			return separation(polyA, modelA, polyB, modelB, (real)0.0) <= (real)0.0;
+		}
+
+		/// <summary>
+		/// Test whether a sphere overlaps a transformed polytope. The closest point of the polytope to the sphere center 
+		/// lies on a face, an edge or is a vertex, so the candidate axes are the face normals, and the directions 
+		/// from the center to the closest points of all edges and to all vertices.
+		/// </summary>
+		/// <returns>True if they overlap.</returns>
+		static bool overlapSpherePolytope(glmvec3 centerW, real radius, const Polytope& polytope, const Transform& model) {
+			return separation(polytope, model, RoundCore{ centerW, centerW, radius }, (real)0.0) <= (real)0.0;
+		}
+
+		/// <summary>
+		/// Run a test on the parts of a compound body, or on the body itself if it is not a compound.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <param name="test">Test for a body that is not a compound.</param>
+		/// <returns>True if the test is true for any part.</returns>
+		static bool anyPart(Body& body, auto&& test) {
+			if (body.m_parts.empty()) return test(body);
+			return std::ranges::any_of(body.m_parts, [&](auto& part) { return test(*part); });
+		}
+
+		/// <summary>
+		/// Find the bodies whose center is in grid cells that can overlap a bounding sphere, and the triangle meshes
+		/// of the global cell, and test them. The ground is not tested.
+		/// Results are written into a caller provided buffer, nothing is allocated.
+		/// </summary>
+		/// <param name="centerW">Center of the bounding sphere of the query region.</param>
+		/// <param name="radius">Radius of the bounding sphere of the query region.</param>
+		/// <param name="test">Exact test for a body.</param>
+		/// <param name="result">Buffer for the bodies.</param>
+		/// <returns>Number of overlapping bodies. If larger than result.size(), only the first result.size() are written.</returns>
+		size_t overlapQuery(glmvec3 centerW, real radius, auto&& test, std::span<std::shared_ptr<Body>> result) {
+			size_t num{ 0 };
+			auto test_cell = [&](const body_map& cell) {
+				for (auto& body : cell) {
+					if (body.second == m_ground) continue;
+					glmvec3 diff = body.second->m_positionW - centerW;
+					real rsum = radius + body.second->boundingSphereRadius();
+					if (glm::dot(diff, diff) > rsum * rsum || !test(*body.second)) continue;
+					if (num < result.size()) result[num] = body.second;
+					++num;
+				}
+			};
+
+			test_cell(m_global_cell);											//the meshes, they are not in the grid
+			int_t x0 = static_cast<int_t>((centerW.x - radius) / m_width) - 1;	//bodies can reach into neighboring cells
+			int_t x1 = static_cast<int_t>((centerW.x + radius) / m_width) + 1;
+			int_t z0 = static_cast<int_t>((centerW.z - radius) / m_width) - 1;
+			int_t z1 = static_cast<int_t>((centerW.z + radius) / m_width) + 1;
+			if ((real)(x1 - x0 + 1) * (real)(z1 - z0 + 1) >= (real)m_grid.size()) {	//cheaper to test all cells
+				for (auto& cell : m_grid) { test_cell(cell.second); }
+				return num;
+			}
+			for (int_t x = x0; x <= x1; ++x) {
+				for (int_t z = z0; z <= z1; ++z) {
+					auto it = m_grid.find(intpair_t{ x, z });
+					if (it != m_grid.end()) test_cell(it->second);
+				}
+			}
+			return num;
+		}
+
+		/// <summary>
+		/// Find all bodies overlapping a sphere, e.g. for explosions. Triangle meshes are reported if any triangle overlaps,
+		/// the ground is not reported.
+		/// </summary>
+		/// <param name="centerW">Center of the sphere.</param>
+		/// <param name="radius">Radius of the sphere.</param>
+		/// <param name="result">Buffer for the bodies.</param>
+		/// <returns>Number of overlapping bodies. If larger than result.size(), only the first result.size() are written.</returns>
+		size_t overlapSphere(glmvec3 centerW, real radius, std::span<std::shared_ptr<Body>> result) {
+			return overlapQuery(centerW, radius, [&](Body& body) { return anyPart(body, [&](Body& part) {
+				if (part.m_collider->m_shape == SHAPE_MESH) return separationMesh(part, part.m_model, centerW, radius, (real)0.0, false,
+					[&](const Polytope& triangle) { return separation(triangle, part.m_model, RoundCore{ centerW, centerW, radius }, (real)0.0); }) <= (real)0.0;
+				if (!part.m_polytope) return separation(part.roundCore(part.m_model), RoundCore{ centerW, centerW, radius }) <= (real)0.0;
+				return overlapSpherePolytope(centerW, radius, *part.m_polytope, part.m_model); }); }, result);
+		}
+
+		/// <summary>
+		/// Find all bodies overlapping an oriented box, e.g. for triggers or spawn clearance. Triangle meshes are reported
+		/// if any triangle overlaps, the ground is not reported.
+		/// </summary>
+		/// <param name="centerW">Center of the box.</param>
+		/// <param name="half_extents">Half of the box size along its local axes.</param>
+		/// <param name="orientationLW">Orientation of the box.</param>
+		/// <param name="result">Buffer for the bodies.</param>
+		/// <returns>Number of overlapping bodies. If larger than result.size(), only the first result.size() are written.</returns>
+		size_t overlapBox(glmvec3 centerW, glmvec3 half_extents, glmquat orientationLW, std::span<std::shared_ptr<Body>> result) {
+			return overlapPolytope(g_cube, Transform::fromTRS(centerW, orientationLW, (real)2.0 * half_extents), result);
+		}
+
+		/// <summary>
+		/// Find all bodies overlapping a transformed polytope. Triangle meshes are reported if any triangle overlaps,
+		/// the ground is not reported.
+		/// </summary>
+		/// <param name="polytope">The polytope.</param>
+		/// <param name="model">Transform from polytope space to world space.</param>
+		/// <param name="result">Buffer for the bodies.</param>
+		/// <returns>Number of overlapping bodies. If larger than result.size(), only the first result.size() are written.</returns>
+		size_t overlapPolytope(const Polytope& polytope, const Transform& model, std::span<std::shared_ptr<Body>> result) {
+			real radius{ 0 };
+			for (auto& vertex : polytope.m_vertices) { radius = std::max(radius, glm::length(model.vector(vertex.m_positionL))); }
+			return overlapQuery(model.m_translation, radius, [&](Body& body) { return anyPart(body, [&](Body& part) {
+				if (part.m_collider->m_shape == SHAPE_MESH) return separationMesh(part, part.m_model, model.m_translation, radius, (real)0.0, false,
+					[&](const Polytope& triangle) { return separation(polytope, model, triangle, part.m_model, (real)0.0); }) <= (real)0.0;
+				if (!part.m_polytope) return separation(polytope, model, part.roundCore(part.m_model), (real)0.0) <= (real)0.0;
+				return overlapPolytopes(polytope, model, *part.m_polytope, part.m_model); }); }, result);
+		}
+
+		//-----------------------------------------------------------------------------------------------------
+		//continuous collision detection
+
+		std::vector<std::shared_ptr<Body>> m_ccd_candidates;	//bodies near the sweep of a CCD body, grows to the largest number found and is reused
+
+		/// <summary>
+		/// Conservative advancement: find the first time in [0, 1] (fraction of dt) at which two bodies moving and rotating
+		/// with their current velocities come closer than the collision margin. The distance is bounded from below by the largest SAT
+		/// separation, and the bodies cannot approach faster than their relative speed plus the rotation of their bounding spheres.
+		/// </summary>
+		/// <param name="bodyA">First body.</param>
+		/// <param name="bodyB">Second body.</param>
+		/// <param name="dt">Time step.</param>
+		/// <returns>Time of impact as fraction of dt, 1 if there is no impact.</returns>
+		real timeOfImpact(Body& bodyA, Body& bodyB, real dt) {
+			real bound = (glm::length(bodyA.m_linear_velocityW - bodyB.m_linear_velocityW) 
+				+ glm::length(bodyA.m_angular_velocityW) * bodyA.boundingSphereRadius()
+				+ glm::length(bodyB.m_angular_velocityW) * bodyB.boundingSphereRadius()) * dt;	//max approach during the step
+			if (bound < c_eps) return (real)1.0;
+
+			auto model = [&](const Body& body, real t) {	//pose of a body at time t of the sweep, as in Body::integrate()
+				glmquat orientation = body.m_orientationLW;
+				real speed = glm::length(body.m_angular_velocityW);
+				if (speed > c_eps) orientation = glm::normalize(glm::angleAxis(speed * t * dt, body.m_angular_velocityW / speed) * orientation);
+				return Transform::fromTRS(body.m_positionW + t * dt * body.m_linear_velocityW, orientation, body.m_scale);
+			};
+
+			real t{ 0 };
+			for (int i = 0; i < m_ccd_iterations && t < (real)1.0; ++i) {
+				auto modelA = model(bodyA, t);
+				auto modelB = model(bodyB, t);
+				real dist = separation(bodyA, modelA, bodyB, modelB, bound);	//meshes only test triangles that can be reached
+				if (dist < m_collision_margin) return i == 0 ? (real)1.0 : t;	//if already touching, the narrow phase has the contact
+				t += (dist - (real)0.5 * m_collision_margin) / bound;	//stop inside the margin, so that the narrow phase finds the contact
+			}
+			return std::min(t, (real)1.0);
+		}
+
+		/// <summary>
+		/// For all awake CCD bodies that move fast compared to their size, find the time of impact with the bodies 
+		/// near their sweep, including triangle meshes, and the ground. In the position step these bodies only move up to this time, and the contact 
+		/// is then handled by the narrow phase and solver in the next step. With substeps this runs before the solver, because the
+		/// substeps already move the bodies, so the sweep uses the velocities at the start of the step and the contacts
+		/// found in this step are not yet included.
+		/// </summary>
+		/// <param name="dt">Time step.</param>
+		void computeTimesOfImpact(real dt) {
+			for (auto* body : m_active_bodies) {
+				body->m_toi = (real)1.0;
+				if (!body->m_ccd) continue;
+				real radius = body->boundingSphereRadius();
+				glmvec3 motion = body->m_linear_velocityW * dt;
+				if (glm::length(motion) < m_ccd_motion_factor * radius) continue;	//slow enough for discrete collision detection
+
+				glmvec3 centerW = body->m_positionW + (real)0.5 * motion;			//sphere around the sweep
+				real sweep_radius = (real)0.5 * glm::length(motion) + radius;
+				auto near = [&](Body& other) { return &other != body && shouldCollide(*body, other); };
+				size_t num = overlapQuery(centerW, sweep_radius, near, m_ccd_candidates);
+				if (num > m_ccd_candidates.size()) {
+					m_ccd_candidates.resize(num);
+					overlapQuery(centerW, sweep_radius, near, m_ccd_candidates);
+				}
+				if (shouldCollide(*body, *m_ground)) body->m_toi = timeOfImpact(*body, *m_ground, dt);
+				for (size_t i = 0; i < num; ++i) {
+					body->m_toi = std::min(body->m_toi, timeOfImpact(*body, *m_ccd_candidates[i], dt));
+					m_ccd_candidates[i] = nullptr;
+				}
+			}
+		}
+		std::vector<Body*> m_active_bodies;	//bodies that are not sleeping, only these are integrated and moved in the grid
+
+		//--------------------------------------------------------------------------------------------------
+		//transform output
+
+		/// <summary>
+		/// Each body owns a slot. Once per tick, the interpolated model matrices of all bodies that moved are written into 
+		/// m_transform_buffer at their slots, and the slots are listed in m_dirty_slots. The buffer is owned by the renderer, 
+		/// e.g. a mapped instance buffer, and must have at least numSlots() entries. Sleeping bodies are written once, after 
+		/// they have fallen asleep.
+		/// </summary>
+		std::span<glmmat4>		m_transform_buffer;		//renderer owned output buffer, indexed by body slot
+		std::vector<uint32_t>	m_dirty_slots;			//slots written in the last tick, each slot once
+		std::vector<Body*>		m_slot_bodies;			//body for each slot, nullptr if the slot is free
+		std::vector<uint32_t>	m_free_slots;			//slots that can be reused
+		std::vector<uint32_t>	m_slept_slots;			//bodies that fell asleep since the last output
+
+		/// <summary>
+		/// Set the buffer the interpolated transforms are written to.
+		/// </summary>
+		/// <param name="buffer">Renderer owned buffer, with at least numSlots() entries.</param>
+		void setTransformBuffer(std::span<glmmat4> buffer) {
+			m_transform_buffer = buffer;
+			for (auto* body : m_slot_bodies) {	//fill the new buffer once, sleeping bodies are not written again
+				if (body) writeTransform(body, (real)1.0);
+			}
+		}
+
+		/// <summary>
+		/// Get the number of slots, i.e. the minimum size of the transform buffer.
+		/// </summary>
+		/// <returns>Number of slots.</returns>
+		uint32_t numSlots() const {
+			return static_cast<uint32_t>(m_slot_bodies.size());
+		}
+
+		/// <summary>
+		/// Give a body a slot in the transform buffer. Free slots are reused first.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		void allocateSlot(Body* body) {
+			if (m_free_slots.empty()) {
+				body->m_slot = numSlots();
+				m_slot_bodies.push_back(body);
+				return;
+			}
+			body->m_slot = m_free_slots.back();
+			m_free_slots.pop_back();
+			m_slot_bodies[body->m_slot] = body;
+		}
+
+		/// <summary>
+		/// Release the slot of a body that is erased.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		void freeSlot(Body* body) {
+			m_slot_bodies[body->m_slot] = nullptr;
+			m_free_slots.push_back(body->m_slot);
+		}
+
+		/// <summary>
+		/// Write the interpolated model matrix of a body into its slot of the transform buffer.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <param name="alpha">Interpolation weight between previous and current time slot.</param>
+		/// <returns>False if the buffer is too small for the slot, then nothing is written.</returns>
+		bool writeTransform(Body* body, real alpha) {
+			if (body->m_slot >= m_transform_buffer.size()) return false;
+			glmvec3 pos;
+			glmquat quat;
+			body->interpolate(alpha, pos, quat);
+			m_transform_buffer[body->m_slot] = Transform::fromTRS(pos, quat, body->m_scale).matrix();
+			return true;
+		}
+
+		/// <summary>
+		/// Output stage of tick(). Write transforms of moving bodies and bodies that just fell asleep, and 
+		/// collect the written slots in the dirty list, each slot once. Also call m_on_move for these bodies, if set.
+		/// </summary>
+		void outputTransforms() {
+			real alpha = std::clamp((real)((m_current_time - m_last_slot) / m_sim_delta_time), (real)0.0, (real)1.0);
+			auto output = [&](Body* body) {
+				if (writeTransform(body, alpha)) m_dirty_slots.push_back(body->m_slot);
+				if (body->m_on_move) body->m_on_move(m_current_time - m_last_slot, body->shared_from_this());
+			};
+
+			m_dirty_slots.clear();
+			for (auto* body : m_active_bodies) { output(body); }
+			std::ranges::sort(m_slept_slots);	//a body can fall asleep more than once per tick, or be shifted after it slept
+			m_slept_slots.erase(std::ranges::unique(m_slept_slots).begin(), m_slept_slots.end());
+			for (auto slot : m_slept_slots) {
+				auto* body = m_slot_bodies[slot];
+				if (body && body->m_sleeping) output(body);	//the slot might have been freed or the body woken up again
+			}
+			m_slept_slots.clear();
+		}
+
+		/// <summary>
+		/// Test whether a body can move. The ground never moves.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <returns>True if the body is not sleeping.</returns>
+		bool isAwake(const Body* body) const {
+			return !body->m_sleeping && body != m_ground.get();
+		}
+
+		/// <summary>
+		/// Put a body into the active body list, so that it is integrated again. 
+		/// Call this after changing position, orientation or velocity of a body from the outside.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		void wakeBody(Body* body) {
+			if (!body->m_sleeping) return;
+			body->m_sleeping = false;
+			body->m_prev_positionW = body->m_positionW;	//do not interpolate from where the body was when it fell asleep
+			body->m_prev_orientationLW = body->m_orientationLW;
+			body->m_loop_last_active = m_loop;	//stay awake for at least m_sleep_loops loops
+			body->m_active_idx = m_active_bodies.size();
+			m_active_bodies.push_back(body);
+		}
+
+		/// <summary>
+		/// Remove a body from the active body list, and stop it.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		void sleepBody(Body* body) {
+			if (body->m_sleeping) return;
+			removeActive(body);
+			body->m_sleeping = true;
+			body->m_linear_velocityW = glmvec3{ 0,0,0 };
+			body->m_angular_velocityW = glmvec3{ 0,0,0 };
+			body->m_pbias = glmvec3{ 0,0,0 };
+			body->m_prev_positionW = body->m_positionW;		//rest at the current transform
+			body->m_prev_orientationLW = body->m_orientationLW;
+			m_slept_slots.push_back(body->m_slot);			//write the final transform once
+		}
+
+		/// <summary>
+		/// Remove a body from the active body list in O(1) by moving the last entry into its slot.
+		/// </summary>
+		/// <param name="body">The body, must not be sleeping.</param>
+		void removeActive(Body* body) {
+			auto idx = body->m_active_idx;
+			m_active_bodies[idx] = m_active_bodies.back();
+			m_active_bodies[idx]->m_active_idx = idx;
+			m_active_bodies.pop_back();
+		}
+
 
 		/// <summary>
 		/// Add a body to the 2D broadphase grid. This is a separate function, so we can later change the grid width.
@@ -964,7 +3118,26 @@ namespace vpe {
 		void addGrid(auto pbody) {
 			pbody->m_grid_x = static_cast<int_t>(pbody->m_positionW.x / m_width);	//2D coordinates in the broadphase grid
 			pbody->m_grid_z = static_cast<int_t>(pbody->m_positionW.z / m_width);
-			m_grid[intpair_t{ pbody->m_grid_x, pbody->m_grid_z }].insert({ pbody->m_owner, pbody }); //Put into broadphase grid
+			gridCell(pbody.get()).insert({ pbody->m_owner, pbody }); //Put into broadphase grid
+		}
+
+		/// <summary>
+		/// The broadphase cell of a body. Triangle meshes are large and static, so like the ground they are
+		/// kept in the global cell, which is paired with all cells.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <returns>The cell containing the body.</returns>
+		body_map& gridCell(Body* body) {
+			if (body->m_collider->m_shape == SHAPE_MESH) return m_global_cell;
+			return m_grid[intpair_t{ body->m_grid_x, body->m_grid_z }];
+		}
+
+		/// <summary>
+		/// Remove all bodies from the broadphase grid. The ground stays in the global cell.
+		/// </summary>
+		void clearGrid() {
+			m_grid.clear();
+			m_global_cell.erase_if([](auto& pair) { return pair.first != nullptr; });
 		}
 
 		/// <summary>
@@ -974,18 +3147,70 @@ namespace vpe {
 		void addBody(auto pbody) {
 			m_body = pbody;
 			m_bodies.insert({ pbody->m_owner, pbody });	//Put into body container
+			allocateSlot(pbody.get());
+			pbody->m_sleeping = true;
+			wakeBody(pbody.get());						//new bodies start awake
 			addGrid(pbody);	//add to broadphase grid.
 			pbody->updateMatrices();
 			++m_body_id;
 		}
 
+		/// <summary>
+		/// Add many new bodies to the physics world at once, e.g. when loading a level.
+		/// Containers are reserved once, and grid cells are filled in batches, one cell at a time.
+		/// The bodies are allocated from the body pool, so they must not outlive the world.
+		/// </summary>
+		/// <param name="descs">Descriptions of the new bodies.</param>
+		/// <returns>The new bodies, in the same order as the descriptions.</returns>
+		std::vector<std::shared_ptr<Body>> addBodies(std::span<const BodyDesc> descs) {
+			std::vector<std::shared_ptr<Body>> bodies;
+			bodies.reserve(descs.size());
+			m_bodies.reserve(m_bodies.size() + descs.size());
+			m_active_bodies.reserve(m_active_bodies.size() + descs.size());
+
+			for (auto& desc : descs) {	//the constructor computes inertia tensor and matrices
+				auto pbody = makeBody(desc.m_name, desc.m_owner, desc.m_collider, desc.m_scale, desc.m_positionW,
+					desc.m_orientationLW, desc.m_linear_velocityW, desc.m_angular_velocityW, desc.m_mass_inv, desc.m_restitution, desc.m_friction);
+				pbody->m_on_move = desc.m_on_move;
+				pbody->m_on_erase = desc.m_on_erase;
+				pbody->m_ccd = desc.m_ccd;
+				pbody->m_collision_category = desc.m_collision_category;
+				pbody->m_collision_mask = desc.m_collision_mask;
+				pbody->m_grid_x = static_cast<int_t>(pbody->m_positionW.x / m_width);	//2D coordinates in the broadphase grid
+				pbody->m_grid_z = static_cast<int_t>(pbody->m_positionW.z / m_width);
+				m_bodies.insert({ pbody->m_owner, pbody });	//Put into body container
+				allocateSlot(pbody.get());
+				pbody->m_sleeping = true;
+				wakeBody(pbody.get());						//new bodies start awake
+				bodies.push_back(pbody);
+			}
+
+			std::vector<std::shared_ptr<Body>> sorted;	//sort by cell, then insert each run of bodies into its cell
+			for (auto& pbody : bodies) {
+				if (pbody->m_collider->m_shape == SHAPE_MESH) m_global_cell.insert({ pbody->m_owner, pbody });
+				else sorted.push_back(pbody);
+			}
+			std::ranges::sort(sorted, [](auto& a, auto& b) { return intpair_t{ a->m_grid_x, a->m_grid_z } < intpair_t{ b->m_grid_x, b->m_grid_z }; });
+			for (auto first = sorted.begin(); first != sorted.end(); ) {
+				intpair_t cell{ (*first)->m_grid_x, (*first)->m_grid_z };
+				auto last = std::find_if(first, sorted.end(), [&](auto& b) { return intpair_t{ b->m_grid_x, b->m_grid_z } != cell; });
+				auto& grid_cell = m_grid[cell];
+				grid_cell.reserve(grid_cell.size() + (last - first));
+				for (; first != last; ++first) { grid_cell.insert({ (*first)->m_owner, *first }); }
+			}
+
+			if (!bodies.empty()) m_body = bodies.back();
+			m_body_id += bodies.size();
+			return bodies;
+		}
+
 		/// <summary>
 		/// Retrieve a body using the owner.
 		/// </summary>
 		/// <param name="owner">Pointer to the owner</param>
 		/// <returns>Shared pointer to the body.</returns>
 		auto getBody(auto* owner) {
-			return m_bodies[(void*)owner];
+			return m_bodies[(void*)owner].second;
 		}
 
 		/// <summary>
@@ -997,53 +3222,80 @@ namespace vpe {
 				if (b->m_on_erase) {	//if there is a callback for removing the owner
 					b->m_on_erase(b);	//call it first
 				}
+				b->m_contacts.clear();
+				b->m_constraints.clear();
 			}
-			m_constraints.clear();
-			m_collider.clear();
+			m_ground->m_contacts.clear();
+			m_event_contacts.clear();
+			m_contacts.clear();
+			forEachConstraintArray([](auto& array) { array.clear(); });
+			m_ignore_pairs.clear();
 			m_bodies.clear();
-			m_grid.clear();
+			m_active_bodies.clear();
+			m_slot_bodies.clear();
+			m_free_slots.clear();
+			m_slept_slots.clear();
+			m_dirty_slots.clear();
+			clearGrid();
 		}
 
 		/// <summary>
-		/// Erase one body.
+		/// Erase one body, together with its constraints and contacts. This takes time proportional to the number of 
+		/// constraints and contacts of the body. Touching contacts report end events in the next tick().
 		/// </summary>
 		/// <param name="body">(Shared) pointer to the body.</param>
 		void eraseBody(std::shared_ptr<Body> body) {
 			if (body->m_on_erase) body->m_on_erase(body);
-			m_collider.erase(body->m_owner);
+			eraseAdjacent(body.get());		//wakes the body, it is removed from the active list next
+			if (!body->m_sleeping) removeActive(body.get());
+			freeSlot(body.get());
 			m_bodies.erase(body->m_owner);
-			m_grid[intpair_t{ body->m_grid_x, body->m_grid_z }].erase(body->m_owner);
-			for (auto it = m_constraints.begin(); it != m_constraints.end();) {
-				if ((*it)->containsBody(body)) {
-					it = m_constraints.erase(it);
-				}
-				else ++it;
-			}
-
+			gridCell(body.get()).erase(body->m_owner);
 		}
 
 		/// <summary>
-		/// Erase one body.
+		/// Erase one body, together with its constraints and contacts.
 		/// </summary>
 		/// <param name="owner">A void pointer to the owner of the body.</param>
 		void eraseBody(auto* owner) {
-			std::shared_ptr<Body> body = m_bodies[(void*)owner];
-			if (body->m_on_erase) body->m_on_erase(body);
-			m_collider.erase(body->m_owner);
-			m_bodies.erase(owner);
-			m_grid[intpair_t{ body->m_grid_x, body->m_grid_z }].erase(body->m_owner);
+			eraseBody(m_bodies[(void*)owner].second);
 		}
 
-		void addCollider(std::shared_ptr<Body> body, callback_collide collider ) {
-			m_collider[body->m_owner] = collider;
+		/// <summary>
+		/// Remove all constraints and contacts of a body, using its adjacency lists. The bodies on the other side are woken,
+		/// since they may have rested on this body.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		void eraseAdjacent(Body* body) {
+			while (!body->m_constraints.empty()) removeConstraint(body->m_constraints.back());
+			while (!body->m_contacts.empty()) eraseContact(*body->m_contacts.back());
 		}
 
-		void eraseCollider(std::shared_ptr<Body> body) {
-			m_collider.erase(body->m_owner);
-		}
+		/// <summary>
+		/// Erase many bodies at once. Body container and grid cells are each traversed only once,
+		/// constraints and contacts are found through the bodies.
+		/// </summary>
+		/// <param name="bodies">(Shared) pointers to the bodies.</param>
+		void eraseBodies(std::span<const std::shared_ptr<Body>> bodies) {
+			std::unordered_set<Body*> erased;
+			std::unordered_map<intpair_t, std::unordered_set<void*>> cells;	//owners to remove from each grid cell
+			erased.reserve(bodies.size());
+			for (auto& body : bodies) {
+				if (!erased.insert(body.get()).second) continue;	//ignore duplicates
+				if (body->m_on_erase) body->m_on_erase(body);
+				freeSlot(body.get());
+				eraseAdjacent(body.get());
+				if (body->m_collider->m_shape == SHAPE_MESH) m_global_cell.erase(body->m_owner);
+				else cells[intpair_t{ body->m_grid_x, body->m_grid_z }].insert(body->m_owner);
+			}
 
-		void clearCollider() {
-			m_collider.clear();
+			m_bodies.erase_if([&](auto& pair) { return erased.contains(pair.second.get()); });
+			std::erase_if(m_active_bodies, [&](auto* body) { return erased.contains(body); });
+			for (size_t i = 0; i < m_active_bodies.size(); ++i) { m_active_bodies[i]->m_active_idx = i; }
+			for (auto& cell : cells) {
+				m_grid[cell.first].erase_if([&](auto& pair) { return cell.second.contains(pair.first); });
+			}
+			if (m_body && erased.contains(m_body.get())) m_body = nullptr;
 		}
 
 		/// <summary>
@@ -1051,14 +3303,62 @@ namespace vpe {
 		/// </summary>
 		/// <param name="pbody">The body that moved.</param>
 		void moveBodyInGrid(auto pbody) {
+			if (pbody->m_collider->m_shape == SHAPE_MESH) return;			//meshes are in the global cell
 			int_t x = static_cast<int_t>(pbody->m_positionW.x / m_width);	//2D grid coordinates
 			int_t z = static_cast<int_t>(pbody->m_positionW.z / m_width);
 			if (x != pbody->m_grid_x || z != pbody->m_grid_z) {				//Did they change?
-				m_grid[intpair_t{ pbody->m_grid_x, pbody->m_grid_z }].erase(pbody->m_owner); //Remove body from old cell
+				auto& cell = m_grid[intpair_t{ pbody->m_grid_x, pbody->m_grid_z }];
+				std::shared_ptr<Body> shared = cell[pbody->m_owner].second;	//the cell owns a shared pointer to the body
+				cell.erase(pbody->m_owner);									//Remove body from old cell
 				pbody->m_grid_x = x;
 				pbody->m_grid_z = z;
-				m_grid[intpair_t{ x, z }].insert({ pbody->m_owner, pbody }); //Put body in new cell
+				m_grid[intpair_t{ x, z }].insert({ pbody->m_owner, std::move(shared) }); //Put body in new cell
+			}
+		}
+
+		/// <summary>
+		/// Move the world origin to a new position, so that positions stay small and accurate when
+		/// using float far away from the origin. Everything is moved by -offset in one pass: bodies, contact points,
+		/// the broadphase grid, the ground plane, cloth mass points and joint anchors.
+		/// The owner of the world should move its own objects (e.g. cameras) in the callback m_on_shift_origin.
+		/// Sleeping bodies are written to the transform buffer once more by the next tick(), like bodies that just fell asleep.
+		/// </summary>
+		/// <param name="offset">Position of the new origin in current world coordinates.</param>
+		void shiftOrigin(glmvec3 offset) {
+			if (offset == glmvec3{ 0,0,0 }) return;
+			m_origin += glm::dvec3{ offset };				//remember the absolute origin in double
+			m_origin_focusW -= offset;
+			m_ground_height -= offset.y;					//the ground is a plane, only its height changes
+			m_ground->m_positionW.y -= offset.y;
+			m_ground->updateMatrices();
+
+			clearGrid();									//cell coordinates change, so rebuild the grid
+			for (auto& body : m_bodies) {
+				body.second->m_positionW -= offset;
+				body.second->m_prev_positionW -= offset;
+				body.second->updateMatrices();
+				addGrid(body.second);
+				if (body.second->m_sleeping) m_slept_slots.push_back(body.second->m_slot);	//output sleeping bodies once at their new position
+			}
+
+			for (auto& contact : m_contacts) {				//lever arms are relative and stay the same
+				for (auto& cp : contact.second.m_contact_points) cp.m_positionW -= offset;
+				for (auto& cp : contact.second.m_old_contact_points) cp.m_positionW -= offset;
 			}
+
+			forEachConstraint([&](auto& constraint) { constraint.shiftOrigin(offset); });
+			for (auto& cloth : m_cloths) { cloth.second->shiftOrigin(offset); }
+
+			if (m_on_shift_origin) m_on_shift_origin(offset);
+		}
+
+		/// <summary>
+		/// Set the focus point for automatic rebasing of the origin, e.g. the camera or player position.
+		/// If m_origin_rebase_distance > 0 and the focus is further away from the origin, tick() shifts the origin to the focus.
+		/// </summary>
+		/// <param name="focusW">Focus point in current world coordinates.</param>
+		void setOriginFocus(glmvec3 focusW) {
+			m_origin_focusW = focusW;
 		}
 
 		/// <summary>
@@ -1070,8 +3370,8 @@ namespace vpe {
 			auto B = new_bias;								//temp value
 			if (m_align_position_bias == 1) {				//Should we align thenew bias with the old one?
 				auto l = glm::length(current_bias);			//Length of current bias
-				if (l > 0.0_real) {							//if there is a current bias
-					auto f = std::max(glm::dot(new_bias, current_bias / l) - l, 0.0_real); //how much is already in this direction?
+				if (l > (real)0.0) {							//if there is a current bias
+					auto f = std::max(glm::dot(new_bias, current_bias / l) - l, (real)0.0); //how much is already in this direction?
 					B = new_bias - f * current_bias / l;	//add only the bias that goes beyong this
 				}
 			}
@@ -1087,8 +3387,8 @@ namespace vpe {
 		/// <param name="contact">Contact information..</param>
 		void positionBias(real query_separation, real face_separation, glmvec3 normalL, Contact& contact) {
 			if (query_separation < m_collision_margin) {
-				real weight = 1.0_real / (1.0_real + contact.m_body_inc.m_body->mass() * contact.m_body_ref.m_body->m_mass_inv);
-				auto pbias = -RTOWN(normalL) * (-query_separation) * (real)m_sim_frequency * (1.0_real - weight);
+				real weight = (real)1.0 / ((real)1.0 + contact.m_body_inc.m_body->mass() * contact.m_body_ref.m_body->m_mass_inv);
+				auto pbias = -RTOWN(normalL) * (-query_separation) * (real)m_sim_frequency * ((real)1.0 - weight);
 				addPositionBias(contact.m_body_ref.m_body->m_pbias, pbias);
 				pbias = RTOWN(normalL) * (-query_separation) * (real)m_sim_frequency * weight;
 				addPositionBias(contact.m_body_inc.m_body->m_pbias, pbias);
@@ -1108,10 +3408,12 @@ namespace vpe {
 		void tick(double dt) {
 			if (m_mode == SIMULATION_MODE_REALTIME) {		//if the engine is in realtime mode, advance time
 				m_current_time = m_last_time + dt;	//advance time by the time that went by since the last loop
-				if (dt != 0.0) m_fps = 1.0_real / (real)dt; //estimate for frames per second
+				if (dt != 0.0) m_fps = (real)1.0 / (real)dt; //estimate for frames per second
 			}
 
 			auto last_loop = m_loop;
+			m_contact_events.clear();	//events of the last tick() must have been read by now
+			std::swap(m_contact_events, m_erase_events);	//end events of bodies erased since then come first
 			while (m_current_time > m_next_slot) {	//compute position/vel only at time slots
 				++m_loop;				//increase loop counter
 				uint_t num_active{ 0 };	//set number currently active objects to 0
@@ -1119,16 +3421,47 @@ namespace vpe {
 				narrowPhase();			//Run the narrow phase
 				warmStart();			//Warm start the resting contacts if possible
 
-				for (auto& body : m_bodies) { body.second->stepVelocity(m_sim_delta_time); }	//Integration step for velocity
-				setupConstraints(m_sim_delta_time);												//Pre-calculate values the constraints need during iteration 
-				calculateImpulses(m_loops, m_sim_delta_time);									//Calculate and apply impulses (also solve constraints here)
+				forEachConstraint([&](auto& constraint) {	//bodies connected to an awake body must move as well
+					if (isAwake(constraint.body1()) || isAwake(constraint.body2())) {
+						wakeBody(constraint.body1());
+						wakeBody(constraint.body2());
+					}
+				});
+
+				for (auto* body : m_active_bodies) {					//remember the last slot for interpolation
+					body->m_prev_positionW = body->m_positionW;
+					body->m_prev_orientationLW = body->m_orientationLW;
+				}
+
+				double dt_position = m_sim_delta_time;
+				if (m_substeps > 1) {
+					computeTimesOfImpact((real)m_sim_delta_time);								//Sweep fast CCD bodies with the velocities of the last step
+					solveSubsteps(m_substeps, m_sim_delta_time);								//Integrate velocities and positions in substeps
+					solverEvents();
+					dt_position = 0.0;															//positions have been integrated already
+				}
+				else {
+					for (auto* body : m_active_bodies) { body->stepVelocity(m_sim_delta_time); }	//Integration step for velocity
+					setupConstraints(m_sim_delta_time);												//Pre-calculate values the constraints need during iteration 
+					calculateImpulses(m_loops, m_sim_delta_time);									//Calculate and apply impulses (also solve constraints here)
+					solverEvents();																	//Report begin and persist contact events
+					computeTimesOfImpact((real)m_sim_delta_time);									//Sweep fast CCD bodies
+				}
 
-				for (auto& body : m_bodies) {	//integrate positions and update the matrices for the bodies
-					if (body.second->stepPosition(m_sim_delta_time, body.second->m_positionW, body.second->m_orientationLW)) ++num_active;
-					body.second->updateMatrices();
+				for (size_t i = m_active_bodies.size(); i-- > 0; ) {	//integrate positions and update the matrices for the bodies
+					auto* body = m_active_bodies[i];
+					if (body->stepPosition(dt_position, body->m_positionW, body->m_orientationLW)) ++num_active;
+					if (body->m_toi < (real)1.0) {						//CCD body would hit something, stop at the time of impact
+						body->m_positionW = glm::mix(body->m_prev_positionW, body->m_positionW, body->m_toi);
+						body->m_orientationLW = glm::slerp(body->m_prev_orientationLW, body->m_orientationLW, body->m_toi);
+					}
+					body->updateMatrices();
+					if (m_use_sleeping == 1 && body->m_loop_last_active + m_sleep_loops < m_loop) {
+						sleepBody(body);	//swaps the last body into slot i, which has already been integrated
+					}
 				}
 
-				m_num_active = 0.9_real * m_num_active + 0.1_real * num_active; //smooth the number of active nodies
+				m_num_active = (real)0.9 * m_num_active + (real)0.1 * num_active; //smooth the number of active nodies
 				if (m_num_active < c_small) m_num_active = 0;					//If near 0, set to 0
 
 				//--------------------------Begin-Cloth-Simulation-Stuff----------------------------
@@ -1143,13 +3476,12 @@ namespace vpe {
 				m_next_slot += m_sim_delta_time;	//Move to next time slot as slong as we do not surpass current time
 			}
 			if (m_loop > last_loop) {	//if we have entered a new time slot bodies might have moved, so update broadphase grid
-				for (auto& body : m_bodies) { moveBodyInGrid(body.second); } //update grid
-			}
-			for (auto& body : m_bodies) {	//predict pos/vel at slot + delta, this is only a prediction for rendering, this is not stored anywhere
-				if (body.second->m_on_move) {
-					body.second->m_on_move(m_current_time - m_last_slot, body.second); //predict new pos/orient
+				if (m_origin_rebase_distance > 0 && glm::length(m_origin_focusW) > m_origin_rebase_distance) {
+					shiftOrigin(m_origin_focusW);	//focus is too far away from the origin, rebase (also rebuilds the grid)
 				}
+				for (auto* body : m_active_bodies) { moveBodyInGrid(body); } //update grid, sleeping bodies do not move
 			}
+			outputTransforms();	//interpolated transforms for rendering, only for bodies that moved
 
 			//----------------------------Begin-Cloth-Simulation-Stuff------------------------------
 			// by Felix Neumann
@@ -1172,17 +3504,96 @@ namespace vpe {
 		void makeBodyPairs(const body_map& cell, const body_map& neigh) {
 			for (auto& coll : cell) {
 				for (auto& neigh : neigh) {
-					if (coll.second->m_owner != neigh.second->m_owner) {
+					if (coll.second->m_owner != neigh.second->m_owner && coll.second->m_mass_inv + neigh.second->m_mass_inv > (real)0.0	//two static bodies cannot push each other
+						&& shouldCollide(*coll.second, *neigh.second)) {
 						auto it = m_contacts.find({ coll.second->m_owner, neigh.second->m_owner }); //if contact exists already
 						if (it != m_contacts.end()) { it->second.m_last_loop = m_loop; }			// yes - update loop count
 						else {
-							m_contacts.insert({ { coll.second->m_owner, neigh.second->m_owner }, {m_loop, {coll.second}, {neigh.second} } }); //no - make new
+							auto& contact = m_contacts.try_emplace({ coll.second->m_owner, neigh.second->m_owner }).first->second; //no - make new
+							contact.m_last_loop = m_loop;
+							contact.m_body_ref.m_body = coll.second;
+							contact.m_body_inc.m_body = neigh.second;
+							linkContact(contact);
 						}
 					}
 				}
 			}
 		}
 
+		/// <summary>
+		/// Append a new contact to the adjacency lists of its two bodies.
+		/// </summary>
+		/// <param name="contact">The contact, already in m_contacts.</param>
+		void linkContact(Contact& contact) {
+			for (auto* ptr : { &contact.m_body_ref, &contact.m_body_inc }) {
+				ptr->m_adjacency = (uint32_t)ptr->m_body->m_contacts.size();
+				ptr->m_body->m_contacts.push_back(&contact);
+			}
+		}
+
+		/// <summary>
+		/// Remove a contact from the adjacency lists of its two bodies, by moving the last contact of each list into its place.
+		/// </summary>
+		/// <param name="contact">The contact.</param>
+		void unlinkContact(Contact& contact) {
+			for (auto* ptr : { &contact.m_body_ref, &contact.m_body_inc }) {
+				Body* body = ptr->m_body.get();
+				Contact* last = body->m_contacts.back();
+				auto& last_ptr = last->m_body_ref.m_body.get() == body ? last->m_body_ref : last->m_body_inc;
+				last_ptr.m_adjacency = ptr->m_adjacency;
+				body->m_contacts[ptr->m_adjacency] = last;
+				body->m_contacts.pop_back();
+			}
+		}
+
+		/// <summary>
+		/// Remove a contact from the world, and wake its bodies, which lose their support. If the contact began, 
+		/// its end event is kept in m_erase_events, its ContactEvent holds the bodies until it is reported.
+		/// </summary>
+		/// <param name="contact">The contact.</param>
+		void eraseContact(Contact& contact) {
+			if (contact.m_touching) addContactEvent(CONTACT_EVENT_END, contact, m_erase_events);
+			std::erase(m_event_contacts, &contact);
+			wakeBody(contact.m_body_ref.m_body.get());
+			wakeBody(contact.m_body_inc.m_body.get());
+			unlinkContact(contact);
+			m_contacts.erase({ contact.m_body_ref.m_body->m_owner, contact.m_body_inc.m_body->m_owner });
+		}
+
+		/// <summary>
+		/// The contacts of a body, i.e. all pairs the broadphase found for it. A contact touches if it has contact points, 
+		/// so the bodies a crate touches are the other bodies of its contacts with non empty m_contact_points.
+		/// The list is changed by tick() and when bodies are erased.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <returns>Pointers to the contacts of the body.</returns>
+		const std::pmr::vector<Contact*>& bodyContacts(const std::shared_ptr<Body>& body) const {
+			return body->m_contacts;
+		}
+
+		/// <summary>
+		/// The constraints connecting a body to other bodies. Use getConstraint() to access them.
+		/// </summary>
+		/// <param name="body">The body.</param>
+		/// <returns>Handles of the constraints of the body.</returns>
+		const std::pmr::vector<ConstraintHandle>& bodyConstraints(const std::shared_ptr<Body>& body) const {
+			return body->m_constraints;
+		}
+
+		/// <summary>
+		/// Collision filter, evaluated before a contact is created. Two bodies collide if the category of each body is in the
+		/// mask of the other one, they are not connected by a constraint that ignores collisions, and m_pair_filter, if set, 
+		/// returns true. E.g. give debris its own category, and remove this category from the mask of the debris.
+		/// </summary>
+		/// <param name="body0">First body.</param>
+		/// <param name="body1">Second body.</param>
+		/// <returns>True if the bodies can collide.</returns>
+		bool shouldCollide(const Body& body0, const Body& body1) {
+			if ((body0.m_collision_category & body1.m_collision_mask) == 0 || (body1.m_collision_category & body0.m_collision_mask) == 0) return false;
+			if (!m_ignore_pairs.empty() && m_ignore_pairs.contains({ body0.m_owner, body1.m_owner })) return false;
+			return !m_pair_filter || m_pair_filter(body0, body1);
+		}
+
 		/// <summary>
 		/// Create pairs of objects that can touch each other. These are either in the same grid cell,
 		/// or in neighboring cells. Go through all pairs of neighboring cells and create possible 
@@ -1193,7 +3604,7 @@ namespace vpe {
 			const std::array<intpair_t, 5> c_pairs{ { {0,0}, {1,0}, {-1,-1}, {0,-1}, {1,-1} } }; //neighbor cells
 
 			for (auto& cell : m_grid) {		//loop through all cells that are currently not empty.
-				makeBodyPairs(m_global_cell, cell.second);		//test all bodies against the ground
+				makeBodyPairs(m_global_cell, cell.second);		//test all bodies against the ground and the meshes
 				for (auto& pi : c_pairs) {	//create pairs of neighborig cells and make body pairs.
 					intpair_t ni = { cell.first.first + pi.first, cell.first.second + pi.second };
 					if (m_grid.count(ni) > 0) { makeBodyPairs(cell.second, m_grid.at(ni)); }
@@ -1214,28 +3625,109 @@ namespace vpe {
 			for (auto it = std::begin(m_contacts); it != std::end(m_contacts); ) {
 				auto& contact = it->second;
 				if (contact.m_last_loop == m_loop) {	//is contact still possible?
-					contact.m_old_contact_points = std::move(contact.m_contact_points);
+					if (isSleeping(contact)) { ++it; continue; }	//nothing moved, keep the contact points
+
+					std::swap(contact.m_old_contact_points, contact.m_contact_points);	//swap to keep the capacity of both vectors
+					contact.m_contact_points.clear();
 
 					if (!warmStartContact(contact)) {	//Can we completely warm start the contact?
 						bool ct = false;
+						auto shape_ref = contact.m_body_ref.m_body->m_collider->m_shape;
+						auto shape_inc = contact.m_body_inc.m_body->m_collider->m_shape;
 						if (contact.m_body_ref.m_body->m_owner == nullptr) {
-							ct = groundTest(contact);		//is the ref body the ground?
+							ct = (this->*m_collide_ground[shape_inc])(contact);		//is the ref body the ground?
 						}
 						else {
 							glmvec3 diff = contact.m_body_inc.m_body->m_positionW - contact.m_body_ref.m_body->m_positionW;
 							real rsum = contact.m_body_ref.m_body->boundingSphereRadius() + contact.m_body_inc.m_body->boundingSphereRadius();
-							if (glm::dot(diff, diff) > rsum * rsum) { ++it;  continue; }
-							ct = SAT(it->second);						//yes - test it
+							if (glm::dot(diff, diff) <= rsum * rsum) ct = (this->*m_collide[shape_ref][shape_inc])(contact);	//bounding spheres overlap - test it
 						}
 						if (ct) {
-							if (m_collider.contains(contact.m_body_ref.m_body->m_owner)) m_collider[contact.m_body_ref.m_body->m_owner](contact.m_body_ref.m_body, contact.m_body_inc.m_body);
-							if (m_collider.contains(contact.m_body_inc.m_body->m_owner)) m_collider[contact.m_body_inc.m_body->m_owner](contact.m_body_inc.m_body, contact.m_body_ref.m_body);
+							wakeOther(contact.m_body_ref.m_body.get(), contact.m_body_inc.m_body.get());
+							wakeOther(contact.m_body_inc.m_body.get(), contact.m_body_ref.m_body.get());
 						}
 					}
+					touchEvents(contact);
 					++it;
 				}
-				else { it = m_contacts.erase(it); }				//no - erase from container
+				else {											//no - erase from container
+					if (contact.m_touching) addContactEvent(CONTACT_EVENT_END, contact, m_contact_events);
+					wakeBody(contact.m_body_ref.m_body.get());	//a sleeping body may have lost its support
+					wakeBody(contact.m_body_inc.m_body.get());
+					unlinkContact(contact);
+					it = m_contacts.erase(it);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Update the touching state of a contact after the narrow phase. End events are reported immediately, but only
+		/// for contacts whose begin event was reported. Begin and persist events need the impulses, so the contact is 
+		/// remembered and reported after the solver.
+		/// </summary>
+		/// <param name="contact">The contact.</param>
+		void touchEvents(Contact& contact) {
+			if (contact.m_contact_points.empty()) {
+				if (contact.m_touching) addContactEvent(CONTACT_EVENT_END, contact, m_contact_events);
+				contact.m_touching = false;
+			}
+			else if ((contact.m_body_ref.m_body->m_event_flags | contact.m_body_inc.m_body->m_event_flags) != 0) {
+				m_event_contacts.push_back(&contact);	//no contacts are inserted until the solver is done, so the pointer stays valid
+			}
+		}
+
+		/// <summary>
+		/// Report begin and persist events for the contacts remembered during the narrow phase, 
+		/// now that their impulses are known. A contact whose begin event is below the threshold tries to begin again 
+		/// in the next step, so that every end event follows a begin event.
+		/// </summary>
+		void solverEvents() {
+			for (auto* contact : m_event_contacts) {
+				if (contact->m_touching) addContactEvent(CONTACT_EVENT_PERSIST, *contact, m_contact_events);
+				else contact->m_touching = addContactEvent(CONTACT_EVENT_BEGIN, *contact, m_contact_events);
+			}
+			m_event_contacts.clear();
+		}
+
+		/// <summary>
+		/// Append a contact event to m_contact_events, if one of the bodies wants it and the impulse is large enough.
+		/// </summary>
+		/// <param name="type">Begin, persist or end.</param>
+		/// <param name="contact">The contact.</param>
+		/// <param name="events">The event list to append to.</param>
+		/// <returns>False if the impulse is below m_event_impulse_threshold. True otherwise, even if no body wants this type.</returns>
+		bool addContactEvent(contact_event_flags_t type, Contact& contact, std::vector<ContactEvent>& events) {
+			ContactEvent event{ type, contact.m_body_ref.m_body, contact.m_body_inc.m_body, glmvec3{ 0 }, contact.m_normalW, (real)0 };
+			if (type != CONTACT_EVENT_END) {
+				for (auto& cp : contact.m_contact_points) {
+					event.m_positionW += cp.m_positionW;
+					event.m_impulse += m_substeps > 1 ? cp.m_f_step : cp.m_f;	//the impulse of the whole step in both solvers
+				}
+				if (event.m_impulse < m_event_impulse_threshold) return false;
+				event.m_positionW /= (real)contact.m_contact_points.size();
 			}
+			if ((contact.m_body_ref.m_body->m_event_flags | contact.m_body_inc.m_body->m_event_flags) & type) events.push_back(std::move(event));
+			return true;
+		}
+
+		/// <summary>
+		/// Test whether both bodies of a contact are sleeping (or are the ground). Such contacts are neither
+		/// tested nor solved.
+		/// </summary>
+		/// <param name="contact">The contact.</param>
+		/// <returns>True if no body of the contact can move.</returns>
+		bool isSleeping(const Contact& contact) const {
+			return !isAwake(contact.m_body_ref.m_body.get()) && !isAwake(contact.m_body_inc.m_body.get());
+		}
+
+		/// <summary>
+		/// If a body touches a sleeping body and has recently moved, then wake the sleeping body.
+		/// Bodies that are awake but resting do not wake their neighbors, otherwise a stack would never fall asleep.
+		/// </summary>
+		/// <param name="body">The body that might have moved.</param>
+		/// <param name="other">The body that might be woken.</param>
+		void wakeOther(Body* body, Body* other) {
+			if (other->m_sleeping && isAwake(body) && body->m_loop_last_active + 2 > m_loop) wakeBody(other);
 		}
 
 		/// <summary>
@@ -1254,7 +3746,7 @@ namespace vpe {
 			}
 
 			for (auto& cp : contact.m_old_contact_points) {
-				auto F = cp.m_f * contact.m_normalW;
+				auto F = cp.m_f * cp.m_normalW;
 				contact.m_body_ref.m_body->m_linear_velocityW += -F * contact.m_body_ref.m_body->m_mass_inv;
 				contact.m_body_ref.m_body->m_angular_velocityW += contact.m_body_ref.m_body->m_inertia_invW * glm::cross(cp.m_r0W, -F);
 				contact.m_body_inc.m_body->m_linear_velocityW += F * contact.m_body_inc.m_body->m_mass_inv;
@@ -1269,52 +3761,57 @@ namespace vpe {
 		}
 
 		/// <summary>
-		/// A resting point can be warmstarted with its previous normal force. This
-		/// increases stacking stability. We warmstart with old resting points at the same position.
-		/// But we need a minimum number of old points, otherwise there is no warm starting.
+		/// A contact point that persists from the last loop is warmstarted with its previous normal and friction force. 
+		/// This increases stacking stability and convergence, and keeps bodies on slopes from creeping. Points are matched 
+		/// by their feature IDs. Points are created in the same order as in the last loop, so usually the old point at the 
+		/// same index matches. The tangent basis is computed anew in each loop, so the old friction force is projected
+		/// onto the new basis.
 		/// </summary>
 		void warmStart() {
 			if (m_use_warmstart == 0) return;
-			int num_old_points{ 0 };
 			for (auto& c : m_contacts) {
 				auto& contact = c.second;
-				auto num0 = contact.m_body_ref.m_body->m_num_resting;
-				auto num1 = contact.m_body_inc.m_body->m_num_resting;
-
-				if (num0 < 4 || num1 < 4 || contact.m_contact_points.size() == 0 || contact.m_old_contact_points.size() == 0) continue;
+				if (isSleeping(contact) || contact.m_old_contact_points.empty()) continue;
 
+				auto& old_points = contact.m_old_contact_points;
+				size_t k = 0;
 				for (auto& cp : contact.m_contact_points) {
-					if (cp.m_type != Contact::ContactPoint::resting || cp.m_f != 0.0_real) continue; //warmstart only once
-					for (auto& coldp : contact.m_old_contact_points) {
-						if (coldp.m_type != Contact::ContactPoint::resting) continue;			//warmstart only resting points
-						if (glm::length(cp.m_positionW - coldp.m_positionW) < c_small) {	//if old point is at same position
-							cp.m_f = coldp.m_f;		//remember old normal force
-
-							auto F = cp.m_f * contact.m_normalW;
-							contact.m_body_ref.m_body->m_linear_velocityW += -F * contact.m_body_ref.m_body->m_mass_inv;
-							contact.m_body_ref.m_body->m_angular_velocityW += contact.m_body_ref.m_body->m_inertia_invW * glm::cross(cp.m_r0W, -F);
-							contact.m_body_inc.m_body->m_linear_velocityW += F * contact.m_body_inc.m_body->m_mass_inv;
-							contact.m_body_inc.m_body->m_angular_velocityW += contact.m_body_inc.m_body->m_inertia_invW * glm::cross(cp.m_r1W, F);
-						}
+					if (k >= old_points.size() || old_points[k].m_id != cp.m_id) {	//not in order, search for it
+						auto it = std::ranges::find(old_points, cp.m_id, &Contact::ContactPoint::m_id);
+						if (it == old_points.end()) continue;
+						k = it - old_points.begin();
 					}
+					auto& old = old_points[k++];
+					cp.m_f = old.m_f;					//remember old normal force
+					glmvec3 FtW = old.m_t.x * old.m_tangentW[0] + old.m_t.y * old.m_tangentW[1];	//old friction force
+					cp.m_t = { glm::dot(FtW, cp.m_tangentW[0]), glm::dot(FtW, cp.m_tangentW[1]) };
+					auto len = glm::length(cp.m_t);
+					if (len > cp.m_f * cp.m_friction) cp.m_t *= cp.m_f * cp.m_friction / len;	//friction cone might have changed
+
+					auto F = cp.m_f * cp.m_normalW - cp.m_t.x * cp.m_tangentW[0] - cp.m_t.y * cp.m_tangentW[1];
+					contact.m_body_ref.m_body->m_linear_velocityW += -F * contact.m_body_ref.m_body->m_mass_inv;
+					contact.m_body_ref.m_body->m_angular_velocityW += contact.m_body_ref.m_body->m_inertia_invW * glm::cross(cp.m_r0W, -F);
+					contact.m_body_inc.m_body->m_linear_velocityW += F * contact.m_body_inc.m_body->m_mass_inv;
+					contact.m_body_inc.m_body->m_angular_velocityW += contact.m_body_inc.m_body->m_inertia_invW * glm::cross(cp.m_r1W, F);
 				}
 			}
 		}
 
 		/// <summary>
 		/// Test if a body collides with the ground. A vertex collides with the ground if its
-		/// y world coordinate is negative.
+		/// y world coordinate is below the ground height (0 unless the origin was shifted).
 		/// </summary>
 		/// <param name="contact">The contact information between the ground and the body.</param>
 		bool groundTest(Contact& contact) {
-			if (contact.m_body_inc.m_body->m_positionW.y > contact.m_body_inc.m_body->boundingSphereRadius()) return false; //early out test
+			if (contact.m_body_inc.m_body->m_positionW.y - m_ground_height > contact.m_body_inc.m_body->boundingSphereRadius()) return false; //early out test
 			real min_depth{ std::numeric_limits<real>::max() };
 			bool res = false;
 			for (auto& vL : contact.m_body_inc.m_body->m_polytope->m_vertices) {
 				auto vW = ITOWP(vL.m_positionL);							//world coordinates
-				if (vW.y <= m_collision_margin) {							//close to the ground?
-					min_depth = std::min(min_depth, vW.y);					//remember smalles y coordinate for calculating bias
-					addContactPoint(contact, vW, glmvec3{ 0,1,0 }, vW.y);	//add the contact point
+				real depth = vW.y - m_ground_height;						//height above the ground
+				if (depth <= m_collision_margin) {							//close to the ground?
+					min_depth = std::min(min_depth, depth);					//remember smalles y coordinate for calculating bias
+					addContactPoint(contact, vW, glmvec3{ 0,1,0 }, depth, vL.m_id);	//add the contact point, the vertex is its feature
 					res = true;
 				}
 			}
@@ -1322,6 +3819,314 @@ namespace vpe {
 			return res;
 		}
 
+		/// <summary>
+		/// Test if a sphere or capsule collides with the ground. The ends of the segment are the candidate contact points.
+		/// </summary>
+		/// <param name="contact">The contact information between the ground and the body.</param>
+		bool groundTestRound(Contact& contact) {
+			auto core = contact.m_body_inc.m_body->roundCore(contact.m_body_inc.m_body->m_model);
+			std::array<glmvec3, 2> ends{ core.m_aW, core.m_bW };
+			size_t num = core.m_aW == core.m_bW ? 1 : 2;					//a sphere has only one
+			real min_depth{ std::numeric_limits<real>::max() };
+			bool res = false;
+			for (size_t i = 0; i < num; ++i) {
+				real depth = ends[i].y - core.m_radius - m_ground_height;	//height of the lowest point above the ground
+				if (depth <= m_collision_margin) {
+					min_depth = std::min(min_depth, depth);
+					addContactPoint(contact, ends[i] - glmvec3{ 0, core.m_radius, 0 }, glmvec3{ 0,1,0 }, depth, i);
+					res = true;
+				}
+			}
+			positionBias(min_depth, min_depth, glmvec3{ 0,1,0 }, contact);
+			return res;
+		}
+
+		/// <summary>
+		/// Collide a polytope (reference body) with a sphere or capsule (incident body). The face normals, and the directions
+		/// between the closest points of the edges and the segment are tested as separating axes. For a face, the segment is
+		/// clipped against the side planes of the face, giving up to two contact points. For an edge, the closest points 
+		/// give one contact point. A sphere thus touches the closest feature of the polytope.
+		/// </summary>
+		/// <param name="contact">The contact between the two bodies.</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool collidePolytopeRound(Contact& contact) {
+			auto& body = *contact.m_body_ref.m_body;
+			auto& model = body.m_model;
+			auto core = contact.m_body_inc.m_body->roundCore(contact.m_body_inc.m_body->m_model);
+
+			Face* face_ref{ nullptr };							//face with the largest separation
+			glmvec3 face_nW{ 0 };
+			real face_dW{ 0 }, face_sep{ -std::numeric_limits<real>::max() };
+			for (auto& face : body.m_polytope->m_faces) {
+				glmvec3 nW = glm::normalize(model.normal(face.m_normalL));
+				real dW = glm::dot(nW, model.point(face.m_face_vertex_ptrs[0]->m_positionL));
+				real sep = std::min(glm::dot(nW, core.m_aW), glm::dot(nW, core.m_bW)) - dW - core.m_radius;
+				if (sep > m_collision_margin) return false;		//found a separating axis
+				if (sep > face_sep) { face_ref = &face; face_nW = nW; face_dW = dW; face_sep = sep; }
+			}
+
+			Edge* edge_ref{ nullptr };							//edge with the largest separation
+			glmvec3 edge_nW{ 0 }, edge_pW{ 0 };
+			real edge_sep{ -std::numeric_limits<real>::max() };
+			for (auto& edge : body.m_polytope->m_edges) {
+				glmvec3 aW = model.point(edge.m_first_vertexL.m_positionL);
+				glmvec3 pE, pC;
+				closestPointsSegments(aW, aW + model.vector(edge.m_edgeL), core.m_aW, core.m_bW, pE, pC);
+				glmvec3 nW = pC - pE;
+				real len = glm::length(nW);
+				if (len < c_eps) continue;						//the segment touches the edge, the faces decide
+				nW /= len;
+				real sep = std::min(glm::dot(nW, core.m_aW), glm::dot(nW, core.m_bW)) - core.m_radius - supportDistance(*body.m_polytope, model, nW);
+				if (sep > m_collision_margin) return false;		//found a separating axis
+				if (sep > edge_sep) { edge_ref = &edge; edge_nW = nW; edge_pW = pE; edge_sep = sep; }
+			}
+
+			bool res = false;
+			glmmat3 to_refL = glm::transpose(body.m_model.m_linear);	//brings world normals into the reference body, inverse of RTOWN
+			if (edge_ref == nullptr || edge_sep <= face_sep + (real)0.1 * m_collision_margin) {	//prefer faces
+				auto& verts = face_ref->m_face_vertex_ptrs;
+				glmvec3 centerW{ 0 };
+				for (auto* vertex : verts) centerW += model.point(vertex->m_positionL);
+				centerW /= (real)verts.size();
+
+				real t0{ 0 }, t1{ 1 };							//clip the segment against the side planes of the face
+				for (size_t i = 0; i < verts.size() && t0 <= t1; ++i) {
+					glmvec3 v0 = model.point(verts[i]->m_positionL);
+					glmvec3 sW = glm::cross(model.point(verts[(i + 1) % verts.size()]->m_positionL) - v0, face_nW);
+					if (glm::dot(sW, centerW - v0) > (real)0.0) sW = -sW;	//side plane normal points out of the face
+					real da = glm::dot(sW, core.m_aW - v0), db = glm::dot(sW, core.m_bW - v0);	//>0 means outside
+					if (da > (real)0.0 && db > (real)0.0) t0 = (real)2.0;
+					else if (da > (real)0.0) t0 = std::max(t0, da / (da - db));
+					else if (db > (real)0.0) t1 = std::min(t1, da / (da - db));
+				}
+				if (t0 <= t1) {
+					glmvec3 segW = core.m_bW - core.m_aW;
+					std::array<real, 2> ts{ t0, t1 };
+					for (size_t i = 0; i < (t1 - t0 > c_eps && segW != glmvec3{ 0 } ? 2 : 1); ++i) {
+						glmvec3 pW = core.m_aW + ts[i] * segW;
+						real depth = glm::dot(face_nW, pW) - face_dW - core.m_radius;
+						if (depth < m_collision_margin) {
+							addContactPoint(contact, pW - (depth + core.m_radius) * face_nW, face_nW, depth, face_ref->m_id | (uint64_t)i << 32);
+							res = true;
+						}
+					}
+					positionBias(face_sep, face_sep, to_refL * face_nW, contact);
+					return res;
+				}
+				if (edge_ref == nullptr) return false;			//outside of the face region, use the closest edge
+			}
+			if (edge_sep < m_collision_margin) {
+				addContactPoint(contact, edge_pW, edge_nW, edge_sep, edge_ref->m_id | (uint64_t)1 << 48);
+				positionBias(edge_sep, edge_sep, to_refL * edge_nW, contact);
+				res = true;
+			}
+			return res;
+		}
+
+		/// <summary>
+		/// Collide a sphere or capsule (reference body) with a polytope. The polytope becomes the reference body.
+		/// </summary>
+		/// <param name="contact">The contact between the two bodies.</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool collideRoundPolytope(Contact& contact) {
+			std::swap(contact.m_body_ref, contact.m_body_inc);
+			return collidePolytopeRound(contact);
+		}
+
+		/// <summary>
+		/// Collide two spheres or capsules. They touch at the closest points of their segments. Parallel capsules touch along
+		/// a line, then both ends of the overlap of the segments are contact points.
+		/// </summary>
+		/// <param name="contact">The contact between the two bodies.</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool collideRounds(Contact& contact) {
+			auto coreA = contact.m_body_ref.m_body->roundCore(contact.m_body_ref.m_body->m_model);
+			auto coreB = contact.m_body_inc.m_body->roundCore(contact.m_body_inc.m_body->m_model);
+			glmvec3 pA, pB;
+			closestPointsSegments(coreA.m_aW, coreA.m_bW, coreB.m_aW, coreB.m_bW, pA, pB);
+			real dist = glm::length(pB - pA);
+			real sep = dist - coreA.m_radius - coreB.m_radius;
+			if (sep > m_collision_margin) return false;
+			glmvec3 nW = dist > c_eps ? (pB - pA) / dist : glmvec3{ 0, 1, 0 };	//centers on top of each other, pick any normal
+
+			std::array<glmvec3, 2> points{ pA, pA };
+			size_t num = 1;
+			glmvec3 segA = coreA.m_bW - coreA.m_aW, segB = coreB.m_bW - coreB.m_aW;
+			real lenA2 = glm::dot(segA, segA), lenB2 = glm::dot(segB, segB);
+			if (lenA2 > c_eps && lenB2 > c_eps && glm::length2(glm::cross(segA, segB)) < (real)1.0e-4 * lenA2 * lenB2) {	//parallel
+				real s0 = std::clamp(glm::dot(coreB.m_aW - coreA.m_aW, segA) / lenA2, (real)0.0, (real)1.0);
+				real s1 = std::clamp(glm::dot(coreB.m_bW - coreA.m_aW, segA) / lenA2, (real)0.0, (real)1.0);
+				if (std::fabs(s1 - s0) * std::sqrt(lenA2) > m_collision_margin) {
+					points = { coreA.m_aW + s0 * segA, coreA.m_aW + s1 * segA };
+					num = 2;
+				}
+			}
+			for (size_t i = 0; i < num; ++i) {
+				real depth = glm::dot(closestPointSegment(points[i], coreB.m_aW, coreB.m_bW) - points[i], nW) - coreA.m_radius - coreB.m_radius;
+				addContactPoint(contact, points[i] + coreA.m_radius * nW, nW, depth, i);
+			}
+			positionBias(sep, sep, glm::transpose(contact.m_body_ref.m_body->m_model_it) * nW, contact);
+			return true;
+		}
+
+		std::vector<std::pair<std::shared_ptr<Body>, uint64_t>> m_parts_ref;	//parts of the reference body that can touch, reused
+		std::vector<std::pair<std::shared_ptr<Body>, uint64_t>> m_parts_inc;	//parts of the incident body that can touch, reused
+		Contact m_part_contact;													//contact between two parts, reused
+
+		/// <summary>
+		/// Find the parts of a body that can touch another body. A body that is not a compound is its own only part. For a compound, 
+		/// the hierarchy is queried with the box around the bounding sphere of the other body in compound space. Each part comes 
+		/// with a hash of its child index, to keep the feature IDs of different children apart.
+		/// </summary>
+		/// <param name="body">The body that is split into parts.</param>
+		/// <param name="other">The other body, if it is the ground all parts are returned.</param>
+		/// <param name="parts">Receives the parts.</param>
+		void bodyParts(const std::shared_ptr<Body>& body, Body& other, std::vector<std::pair<std::shared_ptr<Body>, uint64_t>>& parts) {
+			parts.clear();
+			if (body->m_parts.empty()) { parts.emplace_back(body, 0); return; }
+			auto hash = [](size_t i) { return (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ull; };
+			if (other.m_owner == nullptr) {
+				for (size_t i = 0; i < body->m_parts.size(); ++i) parts.emplace_back(body->m_parts[i], hash(i));
+				return;
+			}
+			glmvec3 centerL = body->m_model_inv.point(other.m_positionW);		//compound space is the body space without the scale
+			real radius = other.boundingSphereRadius() / body->m_scale.x;
+			static_cast<Compound*>(body->m_collider)->query(centerL - radius, centerL + radius, [&](uint32_t i) {
+				parts.emplace_back(body->m_parts[i], hash(i)); });
+		}
+
+		/// <summary>
+		/// Collide two bodies of which at least one is a compound. Each pair of parts that can touch is collided with the narrow 
+		/// phase function of their shapes, and the contact points are collected into one manifold. The points keep their own normals. 
+		/// The parts carry the mass and velocity of their bodies, so their position bias is passed on to the bodies.
+		/// </summary>
+		/// <param name="contact">The contact between the two bodies.</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool collideCompound(Contact& contact) {
+			auto& body_ref = contact.m_body_ref.m_body;
+			auto& body_inc = contact.m_body_inc.m_body;
+			bool ground = body_ref->m_owner == nullptr;
+			bodyParts(body_ref, *body_inc, m_parts_ref);
+			bodyParts(body_inc, *body_ref, m_parts_inc);
+
+			bool res = false;
+			for (auto& [part_ref, hash_ref] : m_parts_ref) {
+				for (auto& [part_inc, hash_inc] : m_parts_inc) {
+					if (!ground) {
+						glmvec3 diff = part_inc->m_positionW - part_ref->m_positionW;
+						real rsum = part_ref->boundingSphereRadius() + part_inc->boundingSphereRadius();
+						if (glm::dot(diff, diff) > rsum * rsum) continue;
+					}
+					auto& part = m_part_contact;
+					part.m_body_ref.m_body = part_ref;
+					part.m_body_inc.m_body = part_inc;
+					part.m_separating_axisW = glmvec3{ 0 };
+					part.m_contact_points.clear();
+					if (part_ref != body_ref) part_ref->m_pbias = glmvec3{ 0 };	//bodies that are not split get their bias directly
+					if (part_inc != body_inc) part_inc->m_pbias = glmvec3{ 0 };
+					auto shape_inc = part_inc->m_collider->m_shape;
+					if (!(ground ? (this->*m_collide_ground[shape_inc])(part) : (this->*m_collide[part_ref->m_collider->m_shape][shape_inc])(part))) continue;
+
+					real sign = part.m_body_ref.m_body == part_ref ? (real)1.0 : (real)-1.0;	//the function may have swapped the parts
+					for (auto& cp : part.m_contact_points) {
+						addContactPoint(contact, cp.m_positionW, sign * cp.m_normalW, cp.m_separation, cp.m_id ^ hash_ref ^ (hash_inc << 1));
+					}
+					if (part_ref != body_ref) addPositionBias(body_ref->m_pbias, part_ref->m_pbias);
+					if (part_inc != body_inc) addPositionBias(body_inc->m_pbias, part_inc->m_pbias);
+					res = true;
+				}
+			}
+			m_part_contact.m_body_ref.m_body = m_part_contact.m_body_inc.m_body = nullptr;	//do not keep the bodies alive
+			return res;
+		}
+
+		Polytope m_triangle = TriangleMesh::makeTriangle();		//moved to the triangles of meshes by the narrow phase
+		std::shared_ptr<Body> m_triangle_body = makeBody("Triangle", nullptr, &m_triangle, glmvec3{ 1, 1, 1 }, glmvec3{ 0, 0, 0 });	//proxy body of m_triangle
+		Contact m_triangle_contact;								//contact between a triangle and a body, reused
+
+		/// <summary>
+		/// Collide a triangle mesh with a body of another shape. The triangles whose boxes overlap the bounding sphere of the body 
+		/// are collided one by one, as a flat polytope, with the function for a polytope and the shape of the body. Triangles 
+		/// are one sided, so triangles behind which the center of the body lies are skipped. A contact normal that is not the
+		/// triangle normal is replaced by it, unless the contact point lies on an active edge. Thus bodies slide smoothly over
+		/// the inner edges of flat or concave regions.
+		/// </summary>
+		/// <param name="contact">The contact between the two bodies, one of them is the mesh.</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool collideMesh(Contact& contact) {
+			if (contact.m_body_inc.m_body->m_collider->m_shape == SHAPE_MESH) std::swap(contact.m_body_ref, contact.m_body_inc);
+			auto& mesh_body = *contact.m_body_ref.m_body;
+			auto& body = contact.m_body_inc.m_body;
+			if (body->m_collider->m_shape == SHAPE_COMPOUND) return collideCompound(contact);	//split the compound first
+			auto* mesh = static_cast<TriangleMesh*>(mesh_body.m_collider);
+
+			auto& proxy = *m_triangle_body;						//the triangles move with the mesh body
+			proxy.m_owner = mesh_body.m_owner;
+			proxy.m_positionW = mesh_body.m_positionW;
+			proxy.m_orientationLW = mesh_body.m_orientationLW;
+			proxy.m_scale = mesh_body.m_scale;
+			proxy.m_model = mesh_body.m_model;
+			proxy.m_model_inv = mesh_body.m_model_inv;
+			proxy.m_model_it = mesh_body.m_model_it;
+			proxy.m_restitution = mesh_body.m_restitution;
+			proxy.m_friction = mesh_body.m_friction;
+
+			glmvec3 centerL = mesh_body.m_model_inv.point(body->m_positionW);
+			glmvec3 extentL = (body->boundingSphereRadius() + m_collision_margin) / glm::abs(mesh_body.m_scale);	//box around the bounding sphere and the margin in local space
+			glmmat3 to_refL = glm::transpose(mesh_body.m_model.m_linear);					//brings world normals into the mesh, inverse of RTOWN
+			glmvec3 pbias = body->m_pbias;
+			bool res = false;
+			mesh->query(centerL - extentL, centerL + extentL, [&](uint32_t i) {
+				if (glm::dot(mesh->m_normalsL[i], centerL - mesh->m_positionsL[mesh->m_triangles[i][0]]) < (real)0.0) return;	//behind the triangle
+				mesh->setTriangle(m_triangle, i);
+				auto& part = m_triangle_contact;
+				part.m_body_ref.m_body = m_triangle_body;
+				part.m_body_inc.m_body = body;
+				part.m_separating_axisW = glmvec3{ 0 };
+				part.m_feature.m_type = Contact::FeatureCache::FEATURE_NONE;	//the triangle polytope changed
+				part.m_contact_points.clear();
+				if (!(this->*m_collide[SHAPE_POLYTOPE][body->m_collider->m_shape])(part)) return;
+
+				real sign = part.m_body_ref.m_body == m_triangle_body ? (real)1.0 : (real)-1.0;	//the function may have swapped the bodies
+				glmvec3 face_nW = glm::normalize(mesh_body.m_model.normal(mesh->m_normalsL[i]));
+				glmvec3 nW = face_nW;
+				real min_sep = std::numeric_limits<real>::max();
+				uint64_t hash = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ull;
+				for (auto& cp : part.m_contact_points) {
+					glmvec3 cp_nW = sign * cp.m_normalW;
+					if (glm::dot(cp_nW, face_nW) < (real)1.0 - c_eps && mesh->activeEdge(i, mesh_body.m_model_inv.point(cp.m_positionW))) nW = cp_nW;
+					else cp_nW = face_nW;						//inner edge, push along the triangle normal
+					addContactPoint(contact, cp.m_positionW, cp_nW, cp.m_separation, cp.m_id ^ hash);
+					min_sep = std::min(min_sep, cp.m_separation);
+				}
+				body->m_pbias = pbias;							//replace the bias of the triangle function by a bias along the used normal
+				positionBias(min_sep, min_sep, to_refL * nW, contact);
+				pbias = body->m_pbias;
+				res = true;
+			});
+			m_triangle_contact.m_body_inc.m_body = nullptr;		//do not keep the body alive
+			return res;
+		}
+
+		using collide_fct = bool (BasicVPEWorld::*)(Contact&);	//computes the contact manifold of two bodies, true if they touch
+
+		/// <summary>
+		/// Narrow phase functions for each pair of shapes, indexed by the shapes of the reference and the incident body.
+		/// Functions may swap reference and incident body. Entries can be replaced, e.g. by a different algorithm.
+		/// </summary>
+		std::array<std::array<collide_fct, SHAPE_NUM>, SHAPE_NUM> m_collide{ {
+			{ &BasicVPEWorld::collidePolytopes,		&BasicVPEWorld::collidePolytopeRound,	&BasicVPEWorld::collidePolytopeRound,	&BasicVPEWorld::collideCompound,	&BasicVPEWorld::collideMesh },	//polytope
+			{ &BasicVPEWorld::collideRoundPolytope,	&BasicVPEWorld::collideRounds,			&BasicVPEWorld::collideRounds,			&BasicVPEWorld::collideCompound,	&BasicVPEWorld::collideMesh },	//sphere
+			{ &BasicVPEWorld::collideRoundPolytope,	&BasicVPEWorld::collideRounds,			&BasicVPEWorld::collideRounds,			&BasicVPEWorld::collideCompound,	&BasicVPEWorld::collideMesh },	//capsule
+			{ &BasicVPEWorld::collideCompound,		&BasicVPEWorld::collideCompound,		&BasicVPEWorld::collideCompound,		&BasicVPEWorld::collideCompound,	&BasicVPEWorld::collideMesh },	//compound
+			{ &BasicVPEWorld::collideMesh,			&BasicVPEWorld::collideMesh,			&BasicVPEWorld::collideMesh,			&BasicVPEWorld::collideMesh,		nullptr }						//mesh, two meshes are static
+		} };
+
+		/// <summary>
+		/// Narrow phase functions for the ground, indexed by the shape of the other body.
+		/// </summary>
+		std::array<collide_fct, SHAPE_NUM> m_collide_ground{ &BasicVPEWorld::groundTest, &BasicVPEWorld::groundTestRound, &BasicVPEWorld::groundTestRound, &BasicVPEWorld::collideCompound, nullptr };
+
 		/// <summary>
 		/// For a given contact, go through all contact points and apply a small impulse to satisfy the 
 		/// desired velocity. Since impulses in any loop can be negative, assure that the total impulses in
@@ -1338,16 +4143,16 @@ namespace vpe {
 				auto vref = contact.m_body_ref.m_body->totalVelocityW(cp.m_positionW);	//Veloity at contact point of reference body
 				auto vinc = contact.m_body_inc.m_body->totalVelocityW(cp.m_positionW);	//Veloity at contact point of incident body
 				auto vrel = vinc - vref;							//Velocity difference
-				auto dN = glm::dot(vrel, contact.m_normalW);		//Closing speed, if negative then there is a collision
-				real f{ 0.0_real }, t0{ 0.0_real }, t1{ 0.0_real };	//The impulses to be calculated
+				auto dN = glm::dot(vrel, cp.m_normalW);		//Closing speed, if negative then there is a collision
+				real f{ (real)0.0 }, t0{ (real)0.0 }, t1{ (real)0.0 };	//The impulses to be calculated
 
 				if (m_solver == 0) {	//All in one solver
-					auto F = cp.m_K_inv * (-cp.m_restitution * (dN + m_use_vbias * cp.m_vbias) * contact.m_normalW - vrel);
-					f = glm::dot(F, contact.m_normalW);
-					auto Fn = f * contact.m_normalW;
+					auto F = cp.m_K_inv * (-cp.m_restitution * (dN + m_use_vbias * cp.m_vbias) * cp.m_normalW - vrel);
+					f = glm::dot(F, cp.m_normalW);
+					auto Fn = f * cp.m_normalW;
 					auto Ft = F - Fn;
-					t0 = -glm::dot(Ft, contact.m_tangentW[0]);
-					t1 = -glm::dot(Ft, contact.m_tangentW[1]);
+					t0 = -glm::dot(Ft, cp.m_tangentW[0]);
+					t1 = -glm::dot(Ft, cp.m_tangentW[1]);
 				}
 
 				if (m_solver == 1) {						//Separate normal and tangent solver
@@ -1356,22 +4161,22 @@ namespace vpe {
 
 					glmmat3 K = -mc1 * contact.m_body_inc.m_body->m_inertia_invW * mc1 - mc0 * contact.m_body_ref.m_body->m_inertia_invW * mc0;
 
-					auto dV = -cp.m_restitution * dN * contact.m_normalW - vrel;
-					auto kn = contact.m_body_ref.m_body->m_mass_inv + contact.m_body_inc.m_body->m_mass_inv + glm::dot(K * contact.m_normalW, contact.m_normalW);
-					f = (glm::dot(dV, contact.m_normalW) + m_use_vbias * cp.m_vbias) / kn;
-					cp.m_vbias = 0.0_real;
+					auto dV = -cp.m_restitution * dN * cp.m_normalW - vrel;
+					auto kn = contact.m_body_ref.m_body->m_mass_inv + contact.m_body_inc.m_body->m_mass_inv + glm::dot(K * cp.m_normalW, cp.m_normalW);
+					f = (glm::dot(dV, cp.m_normalW) + m_use_vbias * cp.m_vbias) / kn;
+					cp.m_vbias = (real)0.0;
 
 					auto kt0 = contact.m_body_ref.m_body->m_mass_inv + contact.m_body_inc.m_body->m_mass_inv +
-						glm::dot(K * contact.m_tangentW[0], contact.m_tangentW[0]);
-					t0 = -glm::dot(dV, contact.m_tangentW[0]) / kt0;
+						glm::dot(K * cp.m_tangentW[0], cp.m_tangentW[0]);
+					t0 = -glm::dot(dV, cp.m_tangentW[0]) / kt0;
 
 					auto kt1 = contact.m_body_ref.m_body->m_mass_inv + contact.m_body_inc.m_body->m_mass_inv +
-						glm::dot(K * contact.m_tangentW[1], contact.m_tangentW[1]);
-					t1 = -glm::dot(dV, contact.m_tangentW[1]) / kt1;
+						glm::dot(K * cp.m_tangentW[1], cp.m_tangentW[1]);
+					t1 = -glm::dot(dV, cp.m_tangentW[1]) / kt1;
 				}
 
 				auto tmp = cp.m_f;		//make sure that aggregated normal impulse is not negative
-				cp.m_f = std::max(tmp + f, 0.0_real);
+				cp.m_f = std::max(tmp + f, (real)0.0);
 				f = cp.m_f - tmp;
 
 				glmvec2 dt{ t0, t1 };		//make sure that aggregated tangent impulse is not negative
@@ -1383,39 +4188,213 @@ namespace vpe {
 					dt = cp.m_t - tmpt;
 				}
 
-				auto F = f * contact.m_normalW - dt.x * contact.m_tangentW[0] - dt.y * contact.m_tangentW[1]; //total impulse
+				auto F = f * cp.m_normalW - dt.x * cp.m_tangentW[0] - dt.y * cp.m_tangentW[1]; //total impulse
 
 				contact.m_body_ref.m_body->m_linear_velocityW += -F * contact.m_body_ref.m_body->m_mass_inv;
 				contact.m_body_ref.m_body->m_angular_velocityW += contact.m_body_ref.m_body->m_inertia_invW * glm::cross(cp.m_r0W, -F);
 				contact.m_body_inc.m_body->m_linear_velocityW += F * contact.m_body_inc.m_body->m_mass_inv;
 				contact.m_body_inc.m_body->m_angular_velocityW += contact.m_body_inc.m_body->m_inertia_invW * glm::cross(cp.m_r1W, F);
 			}
-			return res;
-		}
+			return res;
+		}
+
+		/// <summary>
+		/// Go through all contacts and calculate and apply impulses. Do this until number of loops or time 
+		/// run out.
+		/// Also solve all constraints once per iteration
+		/// </summary>
+		/// <param name="loops">Max number of loops through the contacts.</param>
+		/// <param name="max_time">Max time you have.</param>
+		void calculateImpulses(uint64_t loops, double max_time) {
+			uint64_t num = loops;
+			auto start = std::chrono::high_resolution_clock::now();
+			auto elapsed = std::chrono::high_resolution_clock::now() - start;
+			do {
+				uint64_t res = 0;
+				for (auto& contact : m_contacts) { 			//loop over all contacts
+					if (isSleeping(contact.second)) continue;
+					auto nres = calculateContactPointImpules(contact.second);
+					res = std::max(nres, (uint64_t)res);
+				}
+				solveConstraints();		//loop over all constraints
+				num = num + res - 1;
+				elapsed = std::chrono::high_resolution_clock::now() - start;
+			} while (num > 0 && (m_mode == SIMULATION_MODE_DEBUG || std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() < 1.0e6 * max_time));
+		}
+
+		//----------------------------------------------------------------------------------------------------
+		// Substepped solver with soft contacts, following the TGS soft solver of Box2D v3:
+		// https://box2d.org/posts/2024/02/solver2d/
+		// The contact manifold is computed once per step. Each substep integrates velocities, solves contacts
+		// and constraints with few loops, integrates positions, and relaxes the contacts without bias.
+		// Penetration is updated from the motion of the contact anchors, so no position bias is needed.
+
+		/// <summary>
+		/// Coefficients of a soft constraint, computed from its stiffness and damping.
+		/// </summary>
+		struct Softness {
+			real m_bias_rate{ 0 };		//fraction of the penetration removed per second
+			real m_mass_scale{ 1 };		//scales the effective mass
+			real m_impulse_scale{ 0 };	//scales the accumulated impulse
+		};
+
+		/// <summary>
+		/// Compute the softness of contacts for a given substep.
+		/// </summary>
+		/// <param name="h">Substep duration.</param>
+		/// <returns>The soft constraint coefficients.</returns>
+		Softness contactSoftness(real h) {
+			real hertz = std::min(m_contact_hertz, (real)0.25 / h);		//stay well below the substep frequency
+			real omega = (real)2.0 * glm::pi<real>() * hertz;
+			real a1 = (real)2.0 * m_contact_damping_ratio + h * omega;
+			real a2 = h * omega * a1;
+			real a3 = (real)1.0 / ((real)1.0 + a2);
+			return { omega / a1, a2 * a3, a3 };
+		}
+
+		/// <summary>
+		/// Apply an impulse at a contact point to both bodies of a contact.
+		/// </summary>
+		/// <param name="contact">The contact.</param>
+		/// <param name="cp">The contact point.</param>
+		/// <param name="F">Impulse in world space, acting on the incident body.</param>
+		void applyContactImpulse(Contact& contact, typename Contact::ContactPoint& cp, glmvec3 F) {
+			contact.m_body_ref.m_body->m_linear_velocityW += -F * contact.m_body_ref.m_body->m_mass_inv;
+			contact.m_body_ref.m_body->m_angular_velocityW += contact.m_body_ref.m_body->m_inertia_invW * glm::cross(cp.m_r0W, -F);
+			contact.m_body_inc.m_body->m_linear_velocityW += F * contact.m_body_inc.m_body->m_mass_inv;
+			contact.m_body_inc.m_body->m_angular_velocityW += contact.m_body_inc.m_body->m_inertia_invW * glm::cross(cp.m_r1W, F);
+		}
+
+		/// <summary>
+		/// Velocity of the incident relative to the reference body at a contact point.
+		/// </summary>
+		glmvec3 relativeVelocity(Contact& contact, typename Contact::ContactPoint& cp) {
+			auto& ref = *contact.m_body_ref.m_body;
+			auto& inc = *contact.m_body_inc.m_body;
+			return inc.m_linear_velocityW + glm::cross(inc.m_angular_velocityW, cp.m_r1W) - ref.m_linear_velocityW - glm::cross(ref.m_angular_velocityW, cp.m_r0W);
+		}
+
+		/// <summary>
+		/// Solve the contact points of a contact once, within a substep. The current penetration is the penetration
+		/// when the contact was found, plus the motion of the contact anchors of both bodies along the normal.
+		/// Separated points are solved speculatively, i.e. the bodies may approach until they touch.
+		/// </summary>
+		/// <param name="contact">Contact manifold of two bodies.</param>
+		/// <param name="h">Substep duration.</param>
+		/// <param name="soft">Softness of the contact, used if there is penetration.</param>
+		/// <param name="use_bias">If false, then only relax the velocities, do not push bodies apart.</param>
+		void solveContactSoft(Contact& contact, real h, const Softness& soft, bool use_bias) {
+			auto& ref = *contact.m_body_ref.m_body;
+			auto& inc = *contact.m_body_inc.m_body;
+			for (auto& cp : contact.m_contact_points) {
+				real sep = cp.m_separation + glm::dot(inc.m_positionW + cp.m_r1W - ref.m_positionW - cp.m_r0W, cp.m_normalW);
+
+				real bias{ 0 }, mass_scale{ 1 }, impulse_scale{ 0 };
+				if (sep > (real)0.0) { bias = sep / h; }	//speculative
+				else if (use_bias) {
+					bias = std::max(soft.m_bias_rate * std::min((real)0.0, sep + m_slop), -m_max_push_velocity);
+					mass_scale = soft.m_mass_scale;
+					impulse_scale = soft.m_impulse_scale;
+				}
+
+				auto vrel = relativeVelocity(contact, cp);
+				auto dN = glm::dot(vrel, cp.m_normalW);
+				real kn = glm::dot(cp.m_K * cp.m_normalW, cp.m_normalW);
+				if (kn <= c_eps) continue;					//both bodies have infinite mass
+				real f = -mass_scale * (dN + bias) / kn - impulse_scale * cp.m_f;
+
+				auto tmp = cp.m_f;		//make sure that aggregated normal impulse is not negative
+				cp.m_f = std::max(tmp + f, (real)0.0);
+				f = cp.m_f - tmp;
+				cp.m_f_max = std::max(cp.m_f_max, cp.m_f);
+				applyContactImpulse(contact, cp, f * cp.m_normalW);
+
+				vrel = relativeVelocity(contact, cp);		//friction with the updated velocities
+				real kt0 = glm::dot(cp.m_K * cp.m_tangentW[0], cp.m_tangentW[0]);
+				real kt1 = glm::dot(cp.m_K * cp.m_tangentW[1], cp.m_tangentW[1]);
+				glmvec2 dt{ glm::dot(vrel, cp.m_tangentW[0]) / kt0, glm::dot(vrel, cp.m_tangentW[1]) / kt1 };
+				auto tmpt = cp.m_t;
+				cp.m_t += dt;
+				auto len = glm::length(cp.m_t);
+				if (len > fabs(cp.m_f * cp.m_friction)) {			//friction still allowed?
+					cp.m_t *= fabs(cp.m_f * cp.m_friction) / len;	//no -> reduce to max allowed length cp.m_f * cp.m_friction
+					dt = cp.m_t - tmpt;
+				}
+				applyContactImpulse(contact, cp, -dt.x * cp.m_tangentW[0] - dt.y * cp.m_tangentW[1]);
+			}
+		}
+
+		/// <summary>
+		/// Advance active bodies by one step, split into substeps. Replaces velocity integration, calculateImpulses() and
+		/// the position integration of the normal solver. Accumulated impulses are kept over the substeps and warm start 
+		/// the next substep. Restitution is applied once at the end.
+		/// </summary>
+		/// <param name="substeps">Number of substeps.</param>
+		/// <param name="dt">Duration of the step.</param>
+		void solveSubsteps(int substeps, double dt) {
+			real h = (real)dt / substeps;
+			auto soft = contactSoftness(h);
+
+			for (auto& c : m_contacts) {		//remember the anchors in the body frames
+				auto& contact = c.second;
+				if (isSleeping(contact)) continue;
+				for (auto& cp : contact.m_contact_points) {
+					cp.m_r0L = glm::inverse(contact.m_body_ref.m_body->m_orientationLW) * cp.m_r0W;
+					cp.m_r1L = glm::inverse(contact.m_body_inc.m_body->m_orientationLW) * cp.m_r1W;
+					cp.m_vn0 = glm::dot(relativeVelocity(contact, cp), cp.m_normalW);
+					cp.m_f_max = (real)0.0;
+					cp.m_f_step = (real)0.0;
+				}
+			}
+
+			for (int i = 0; i < substeps; ++i) {
+				for (auto* body : m_active_bodies) { body->stepVelocity(h); }
+				for (auto& c : m_contacts) {	//move anchors with the bodies and warm start with the last substep
+					auto& contact = c.second;
+					if (isSleeping(contact)) continue;
+					for (auto& cp : contact.m_contact_points) {
+						cp.m_r0W = contact.m_body_ref.m_body->m_orientationLW * cp.m_r0L;
+						cp.m_r1W = contact.m_body_inc.m_body->m_orientationLW * cp.m_r1L;
+						if (i > 0) applyContactImpulse(contact, cp, cp.m_f * cp.m_normalW - cp.m_t.x * cp.m_tangentW[0] - cp.m_t.y * cp.m_tangentW[1]);
+					}
+				}
+				setupConstraints(h);
+
+				for (int loop = 0; loop < m_substep_loops; ++loop) {
+					for (auto& contact : m_contacts) {
+						if (isSleeping(contact.second)) continue;
+						solveContactSoft(contact.second, h, soft, true);
+					}
+					solveConstraints();
+				}
+
+				for (auto* body : m_active_bodies) {	//integrate positions
+					body->integrate(h, body->m_positionW, body->m_orientationLW);
+					body->updateMatrices();
+				}
+
+				for (auto& contact : m_contacts) {		//relax, remove the velocity added by the bias
+					if (isSleeping(contact.second)) continue;
+					solveContactSoft(contact.second, h, soft, false);
+					for (auto& cp : contact.second.m_contact_points) cp.m_f_step += cp.m_f;	//m_f is the impulse of this substep
+				}
+			}
 
-		/// <summary>
-		/// Go through all contacts and calculate and apply impulses. Do this until number of loops or time 
-		/// run out.
-		/// Also solve all constraints once per iteration
-		/// </summary>
-		/// <param name="loops">Max number of loops through the contacts.</param>
-		/// <param name="max_time">Max time you have.</param>
-		void calculateImpulses(uint64_t loops, double max_time) {
-			uint64_t num = loops;
-			auto start = std::chrono::high_resolution_clock::now();
-			auto elapsed = std::chrono::high_resolution_clock::now() - start;
-			do {
-				uint64_t res = 0;
-				for (auto& contact : m_contacts) { 			//loop over all contacts
-					auto nres = calculateContactPointImpules(contact.second);
-					res = std::max(nres, (uint64_t)res);
+			for (auto& c : m_contacts) {	//restitution
+				auto& contact = c.second;
+				if (isSleeping(contact)) continue;
+				for (auto& cp : contact.m_contact_points) {
+					if (cp.m_restitution == (real)0.0 || cp.m_vn0 > -m_sep_velocity || cp.m_f_max == (real)0.0) continue;
+					auto dN = glm::dot(relativeVelocity(contact, cp), cp.m_normalW);
+					real kn = glm::dot(cp.m_K * cp.m_normalW, cp.m_normalW);
+					if (kn <= c_eps) continue;
+					real f = -(dN + cp.m_restitution * cp.m_vn0) / kn;
+					auto tmp = cp.m_f;
+					cp.m_f = std::max(tmp + f, (real)0.0);
+					cp.m_f_step += cp.m_f - tmp;
+					applyContactImpulse(contact, cp, (cp.m_f - tmp) * cp.m_normalW);
 				}
-				for (const auto& constraint : m_constraints) { //loop over all constraints
-					constraint->solveVelocity();
-				}				
-				num = num + res - 1;
-				elapsed = std::chrono::high_resolution_clock::now() - start;
-			} while (num > 0 && (m_mode == SIMULATION_MODE_DEBUG || std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() < 1.0e6 * max_time));
+			}
 		}
 
 		//----------------------------------------------------------------------------------------------------
@@ -1456,7 +4435,7 @@ namespace vpe {
 		/// <param name="vertex">A pointer to a vertex, to make sure that axis points away from ref object.</param>
 		/// <returns>Distance between the object. If negative, this is the seperating distance. Also return ref and inc vertex.</returns>
 		SatQuery sat_query(Contact& contact, glmvec3 nR) {
-			auto nW = glm::normalize(RTOWN(nR));
+			auto nW = RTOWN(nR);
 			Vertex* vertA = contact.m_body_ref.m_body->support(nR);			//find support point in direction n
 			Vertex* vertB = contact.m_body_inc.m_body->support(RTOIN(-nR));	//find support point in direction n
 			real maxA = glm::dot(nW, RTOWP(vertA->m_positionL));					//distance in this direction for ref object
@@ -1474,28 +4453,128 @@ namespace vpe {
 		/// 
 		bool SAT(Contact& contact) {
 			contact.m_body_ref.m_to_other = contact.m_body_inc.m_body->m_model_inv * contact.m_body_ref.m_body->m_model; //transform to bring space A to space B
-			contact.m_body_ref.m_to_other_it = glm::transpose(glm::inverse(glmmat3{ contact.m_body_ref.m_to_other }));	//transform for a normal vector
 			contact.m_body_inc.m_to_other = contact.m_body_ref.m_body->m_model_inv * contact.m_body_inc.m_body->m_model; //transform to bring space B to space A
-			contact.m_body_inc.m_to_other_it = glm::transpose(glm::inverse(glmmat3{ contact.m_body_inc.m_to_other }));	//transform for a normal vector
 
 			if (contact.m_separating_axisW != glmvec3{ 0,0,0 } &&	//try old separating axis
 				sat_query(contact, WTORN(contact.m_separating_axisW)).m_separation > m_collision_margin) {
 				return false;
 			}
 
-			FaceQuery fq0 = queryFaceDirections(contact);			//Query all normal vectors of faces of first body
+			if (useFeatureCache(contact)) return SATLocal(contact);	//the bodies moved little, search around the last feature
+			contact.m_feature.m_type = Contact::FeatureCache::FEATURE_NONE;
+
+			FaceQuery fq0 = queryFaceDirections(contact, contact.m_body_ref.m_body->m_polytope->m_faces);	//Query all normal vectors of faces of first body
 			if (fq0.m_separation > m_collision_margin) { return false; };	//found a separating axis with face normal
 
 			std::swap(contact.m_body_ref, contact.m_body_inc);		//body 0 is the reference body having the reference face
-			FaceQuery fq1 = queryFaceDirections(contact);			//Query all normal vectors of faces of second body
+			FaceQuery fq1 = queryFaceDirections(contact, contact.m_body_ref.m_body->m_polytope->m_faces);	//Query all normal vectors of faces of second body
 			if (fq1.m_separation > m_collision_margin) { return false; };	//found a separating axis with face normal
 
 			std::swap(contact.m_body_ref, contact.m_body_inc);		//prevent flip flopping
-			EdgeQuery eq = queryEdgeDirections(contact);			//Query cross product of edge pairs from body 0 and 1	
+			EdgeQuery eq = queryEdgeDirections(contact, contact.m_body_ref.m_body->m_polytope->m_edges, contact.m_body_inc.m_body->m_polytope->m_edges);	//Query cross product of edge pairs from body 0 and 1	
 			if (eq.m_separation > m_collision_margin) { return false; }	//found a separating axis with edge-edge normal
 
+			createContact(contact, fq0, fq1, eq);
+			return true;
+		}
+
+		/// <summary>
+		/// Test whether the feature cached in the contact can be used. This is the case if the polytopes are the same,
+		/// and their relative position and rotation changed less than m_feature_cache_distance and m_feature_cache_rotation
+		/// since the last full SAT. The translation is in the local space of the reference polytope, so it is compared 
+		/// relative to its size. The columns of the relative rotation are compared relative to their lengths, which
+		/// approximates the rotation angle. Bodies are swapped to the reference and incident body the feature was stored with.
+		/// </summary>
+		/// <param name="contact">The contact between two polytopes, with the transforms between the bodies.</param>
+		/// <returns>True if SATLocal() can be used.</returns>
+		bool useFeatureCache(Contact& contact) {
+			auto& cache = contact.m_feature;
+			if (cache.m_type == Contact::FeatureCache::FEATURE_NONE) return false;
+			if (cache.m_ref == contact.m_body_inc.m_body.get()) std::swap(contact.m_body_ref, contact.m_body_inc);
+			if (cache.m_polytope_ref != contact.m_body_ref.m_body->m_polytope || cache.m_polytope_inc != contact.m_body_inc.m_body->m_polytope) return false;
+
+			auto& to_ref = contact.m_body_inc.m_to_other;
+			real size = cache.m_polytope_ref->m_bounding_sphere_radius;
+			if (glm::length(to_ref.m_translation - cache.m_inc_to_ref.m_translation) > m_feature_cache_distance * size) return false;
+			for (int i = 0; i < 3; ++i) {
+				real len = glm::length(cache.m_inc_to_ref.m_linear[i]);
+				if (glm::length(to_ref.m_linear[i] - cache.m_inc_to_ref.m_linear[i]) > m_feature_cache_rotation * len) return false;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Remember the feature that created the contact manifold, and the relative transform of the bodies.
+		/// </summary>
+		/// <param name="contact">The contact between two polytopes.</param>
+		/// <param name="type">Face or edge feature.</param>
+		/// <param name="ref">Index of the face or edge of the reference body.</param>
+		/// <param name="inc">Index of the face or edge of the incident body.</param>
+		void storeFeature(Contact& contact, typename Contact::FeatureCache::feature_t type, uint_t ref, uint_t inc) {
+			contact.m_feature = { type, contact.m_body_ref.m_body.get(), contact.m_body_ref.m_body->m_polytope, 
+				contact.m_body_inc.m_body->m_polytope, ref, inc, contact.m_body_inc.m_to_other };
+		}
+
+		std::vector<Face*> m_sat_faces_ref;		//faces around the cached feature of the reference body, reused
+		std::vector<Face*> m_sat_faces_inc;		//faces around the cached feature of the incident body, reused
+		std::vector<Edge*> m_sat_edges_ref;		//edges around the cached feature of the reference body, reused
+		std::vector<Edge*> m_sat_edges_inc;		//edges around the cached feature of the incident body, reused
+
+		/// <summary>
+		/// SAT restricted to the faces and edges that share a vertex with the cached features. Since the bodies moved 
+		/// little since the last full SAT, the feature with the largest separation is among them, or it is the same again.
+		/// The new feature is cached with the pose of the last full SAT, so that slow drift eventually runs the full SAT again.
+		/// </summary>
+		/// <param name="contact">The contact between two polytopes, swapped by useFeatureCache().</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool SATLocal(Contact& contact) {
+			auto& cache = contact.m_feature;
+			auto around = [&](Polytope* polytope, uint_t idx, std::vector<Face*>& faces, std::vector<Edge*>& edges) {
+				faces.clear();
+				edges.clear();
+				auto add = [&](Vertex* vertex) {
+					faces.insert(faces.end(), vertex->m_vertex_face_ptrs.begin(), vertex->m_vertex_face_ptrs.end());
+					edges.insert(edges.end(), vertex->m_vertex_edge_ptrs.begin(), vertex->m_vertex_edge_ptrs.end());
+				};
+				if (cache.m_type == Contact::FeatureCache::FEATURE_FACE) { for (auto* vertex : polytope->m_faces[idx].m_face_vertex_ptrs) add(vertex); }
+				else { add(&polytope->m_edges[idx].m_first_vertexL); add(&polytope->m_edges[idx].m_second_vertexL); }
+				std::ranges::sort(faces);
+				faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+				std::ranges::sort(edges);
+				edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+			};
+			around(contact.m_body_ref.m_body->m_polytope, cache.m_feature_ref, m_sat_faces_ref, m_sat_edges_ref);
+			around(contact.m_body_inc.m_body->m_polytope, cache.m_feature_inc, m_sat_faces_inc, m_sat_edges_inc);
+			cache.m_type = Contact::FeatureCache::FEATURE_NONE;		//stored again if the bodies touch
+			const Body* ref = cache.m_ref;
+			Transform pose = cache.m_inc_to_ref;
+
+			FaceQuery fq0 = queryFaceDirections(contact, m_sat_faces_ref);
+			if (fq0.m_separation > m_collision_margin) { return false; };
+
+			std::swap(contact.m_body_ref, contact.m_body_inc);
+			FaceQuery fq1 = queryFaceDirections(contact, m_sat_faces_inc);
+			if (fq1.m_separation > m_collision_margin) { return false; };
+
+			std::swap(contact.m_body_ref, contact.m_body_inc);
+			EdgeQuery eq = queryEdgeDirections(contact, m_sat_edges_ref, m_sat_edges_inc);
+			if (eq.m_separation > m_collision_margin) { return false; }
+
+			createContact(contact, fq0, fq1, eq);
+			cache.m_inc_to_ref = cache.m_ref == ref ? pose : pose.inverse();	//the new feature may have swapped the bodies
+			return true;
+		}
+
+		/// <summary>
+		/// Create the contact manifold from the results of the face and edge queries of SAT.
+		/// </summary>
+		/// <param name="contact">The contact between two polytopes.</param>
+		/// <param name="fq0">Face query with the first body as reference.</param>
+		/// <param name="fq1">Face query with the second body as reference.</param>
+		/// <param name="eq">Edge query.</param>
+		void createContact(Contact& contact, FaceQuery& fq0, FaceQuery& fq1, EdgeQuery& eq) {
 			contact.m_separating_axisW = glmvec3{ 0,0,0 };		//no separating axis found
-			if (fq0.m_separation >= eq.m_separation * 1.001_real || fq1.m_separation >= eq.m_separation * 1.001_real) {	//max separation is a face-vertex contact
+			if (fq0.m_separation >= eq.m_separation * (real)1.001 || fq1.m_separation >= eq.m_separation * (real)1.001) {	//max separation is a face-vertex contact
 				if (fq0.m_separation >= fq1.m_separation) { createFaceContact(contact, fq0); }
 				else {
 					std::swap(contact.m_body_ref, contact.m_body_inc);	//body 0 is the reference body having the reference face
@@ -1503,7 +4582,15 @@ namespace vpe {
 				}
 			}
 			else { createEdgeContact(contact, eq); } //max separation is an edge-edge contact 
-			return true;
+		}
+
+		/// <summary>
+		/// Access a face or an edge in a container holding them or pointers to them.
+		/// </summary>
+		template<typename F>
+		static auto& feature(F& f) {
+			if constexpr (std::is_pointer_v<F>) return *f;
+			else return f;
 		}
 
 		/// <summary>
@@ -1513,15 +4600,18 @@ namespace vpe {
 		/// is the true reference!
 		/// </summary>
 		/// <param name="contact">The pair contact struct.</param>
+		/// <param name="faces">Faces of the reference body to test, or pointers to them.</param>
 		/// <returns>Negative: overlap of bodies along this axis. Positive: distance between the bodies.</returns>
-		FaceQuery queryFaceDirections(Contact& contact) {
+		template<typename R>
+		FaceQuery queryFaceDirections(Contact& contact, R& faces) {
 			FaceQuery result{ -std::numeric_limits<real>::max(), nullptr, nullptr };
-			auto sat = [&](auto& face) {							//Run this function for each reference face
+			auto sat = [&](auto& f) {							//Run this function for each reference face
+				Face& face = feature(f);
 				auto sat = sat_query(contact, face.m_normalL);	//Call the sat, get distance
 				if (sat.m_separation > result.m_separation) result = { sat.m_separation, &face, sat.m_vertB }; //remember max distance
 				return sat.m_separation > m_collision_margin;	//if distance positive, stop - we found a separating axis
 			};
-			auto face = std::ranges::find_if(contact.m_body_ref.m_body->m_polytope->m_faces, sat);
+			std::ranges::find_if(faces, sat);
 			return result;
 		}
 
@@ -1532,14 +4622,17 @@ namespace vpe {
 		/// Return a negative number if there is overlap. Return a positive number if there is no overlap.
 		/// </summary>
 		/// <param name="contact">The contact pair.</param>
-		/// <param name="AtoB">Transform from object space A to B.</param>
-		/// <param name="BtoA">Transform from object space B to A.</param>
+		/// <param name="edges_ref">Edges of the reference body to test, or pointers to them.</param>
+		/// <param name="edges_inc">Edges of the incident body to test, or pointers to them.</param>
 		/// <returns>Negative: overlap of bodies along this axis. Positive: distance between the bodies.</returns>
-		EdgeQuery queryEdgeDirections(Contact& contact) {
+		template<typename R, typename I>
+		EdgeQuery queryEdgeDirections(Contact& contact, R& edges_ref, I& edges_inc) {
 			EdgeQuery result{ -std::numeric_limits<real>::max(), nullptr, nullptr };
 
-			for (auto& edgeA : contact.m_body_ref.m_body->m_polytope->m_edges) {	//loop over all edge-edge pairs
-				for (auto& edgeB : contact.m_body_inc.m_body->m_polytope->m_edges) {
+			for (auto& a : edges_ref) {	//loop over all edge-edge pairs
+				Edge& edgeA = feature(a);
+				for (auto& b : edges_inc) {
+					Edge& edgeB = feature(b);
 					glmvec3 n = glm::cross(edgeA.m_edgeL, ITORV(edgeB.m_edgeL));	//axis n is cross product of both edges
 					if (n == glmvec3{ 0,0,0 }) continue;
 					if (glm::dot(n, edgeA.m_first_vertexL.m_positionL) < 0)	n = -n;		//n must be oriented away from center of A								
@@ -1568,6 +4661,7 @@ namespace vpe {
 			glmvec3 An = glm::normalize(-RTOIN(fq.m_face_ref->m_normalL)); //transform normal vector of ref face to inc body
 			Face* inc_face = maxFaceAlignment(An, fq.m_vertex_inc->m_vertex_face_ptrs);	//Find best incident face
 			real sep = clipFaceFace(contact, fq.m_face_ref, inc_face);					//Project and clip it against reference face
+			storeFeature(contact, Contact::FeatureCache::FEATURE_FACE, fq.m_face_ref->m_id, inc_face->m_id);
 			positionBias(fq.m_separation, sep, fq.m_face_ref->m_normalL, contact);		//Add position bias if necessary
 		}
 
@@ -1587,12 +4681,16 @@ namespace vpe {
 				points.emplace_back(pT.x, pT.z);				//add as 2D point
 			}
 			std::vector<glmvec2> newPolygon;
-			geometry::SutherlandHodgman(points, face_ref->m_face_vertex2D_T, newPolygon); //clip B's face against A's face
+			std::vector<geometry::clip_feature_t> features;		//edges meeting at each clipped point
+			geometry::SutherlandHodgman(points, face_ref->m_face_vertex2D_T, newPolygon, features); //clip B's face against A's face
 
 			if (newPolygon.size() > 4) {										//more than 4 contact points -> reduce to 4
-				auto support = [](auto& dir, auto& newPoly, auto& supp) {		//2D support mapping function
+				std::vector<size_t> supp_idx;
+				auto support = [&](auto& dir, auto& newPoly, auto& supp) {		//2D support mapping function
 					auto compare = [&](auto& a, auto& b) { return glm::dot(dir, a) < glm::dot(dir, b); };
-					supp.push_back(*std::ranges::max_element(newPoly, compare));//find support points and push into vector
+					auto it = std::ranges::max_element(newPoly, compare);
+					supp.push_back(*it);										//find support points and push into vector
+					supp_idx.push_back(it - newPoly.begin());					//and remember their features
 				};
 
 				std::vector<glmvec2> dirs0{ {0,1}, {1,0}, {0,-1}, {-1,0}, {1,1}, {-1,1}, {-1,-1}, {1,-1} }; //along these directions
@@ -1608,21 +4706,28 @@ namespace vpe {
 				real A1 = fabs(glm::determinant(glmmat3{ {supp[4].x, supp[4].y, 1}, {supp[5].x, supp[5].y, 1}, {supp[6].x, supp[6].y, 1} }) +
 					glm::determinant(glmmat3{ {supp[4].x, supp[4].y, 1}, {supp[5].x, supp[5].y, 1}, {supp[7].x, supp[7].y, 1} }));
 
-				if (A0 > A1) { newPolygon = std::vector<glmvec2>{ supp[0], supp[1], supp[2], supp[3] }; }	//First quadrilateral is bigger
-				else { newPolygon = std::vector<glmvec2>{ supp[4], supp[5], supp[6], supp[7] }; }			//Second quadrilateral is bigger
-
+				size_t first = A0 > A1 ? 0 : 4;		//First or second quadrilateral is bigger
+				auto all_features = features;
+				newPolygon = std::vector<glmvec2>{ supp[first], supp[first + 1], supp[first + 2], supp[first + 3] };
+				features.clear();
+				for (size_t k = first; k < first + 4; ++k) features.push_back(all_features[supp_idx[k]]);
 			}
-			real min = 0.0_real;
-			for (auto& p2D : newPolygon) {					//Go through all clip points
-				auto p = glmvec3{ p2D.x, 0.0_real, p2D.y }; //cannot put comma into macro 
+
+			uint64_t faces_id = (face_ref->m_id & 0x7fff) | (uint64_t)(face_inc->m_id & 0xffff) << 16;	//ID of the face pair
+			if (contact.m_body_ref.m_body.get() < contact.m_body_inc.m_body.get()) faces_id |= 0x8000;	//distinguish swapped bodies
+			real min = (real)0.0;
+			for (size_t k = 0; k < newPolygon.size(); ++k) {	//Go through all clip points
+				auto& p2D = newPolygon[k];
+				uint64_t id = faces_id | (uint64_t)features[k].m_in << 32 | (uint64_t)features[k].m_out << 48;
+				auto p = glmvec3{ p2D.x, (real)0.0, p2D.y }; //cannot put comma into macro 
 				glmvec3 posRW = RTTOWP(p);					//Bring them to world coordinates
 				glmvec3 posIT = WTOTIP(posRW);				//Bring them to the tangent space of the incident face
-				posIT.y = 0.0_real;							//Project to incident face
+				posIT.y = (real)0.0;							//Project to incident face
 				glmvec3 posIW = ITTOWP(posIT);			//Bring back to world coordinates
 				auto dist = glm::dot(posIW - posRW, RTOWN(face_ref->m_normalL));	//Distance between the two points in world coordinates
 				if (dist < m_collision_margin) {			//If close enough the touch
 					min = std::min(min, dist);				//Remember the minimum distance
-					addContactPoint(contact, posRW, RTOWN(face_ref->m_normalL), dist);
+					addContactPoint(contact, posRW, RTOWN(face_ref->m_normalL), dist, id);
 				}
 			}
 			return min;
@@ -1635,8 +4740,8 @@ namespace vpe {
 		/// <param name="contact">Contact between the two bodies.</param>
 		/// <param name="eq">Result of edge query.</param>
 		void createEdgeContact(Contact& contact, EdgeQuery& eq) {
-			Face* ref_face = maxFaceAlignment(eq.m_normalL, eq.m_edge_ref->m_edge_face_ptrs, fabs);	//face of A best aligned with the contact normal
-			Face* inc_face = maxFaceAlignment(-RTOIN(eq.m_normalL), eq.m_edge_inc->m_edge_face_ptrs, fabs);	//face of B best aligned with the contact normal
+			Face* ref_face = maxFaceAlignment(eq.m_normalL, eq.m_edge_ref->m_edge_face_ptrs, [](real x) { return std::fabs(x); });	//face of A best aligned with the contact normal
+			Face* inc_face = maxFaceAlignment(-RTOIN(eq.m_normalL), eq.m_edge_inc->m_edge_face_ptrs, [](real x) { return std::fabs(x); });	//face of B best aligned with the contact normal
 
 			real dp_ref = fabs(glm::dot(eq.m_normalL, ref_face->m_normalL));	//Use the better aligned face as reference face.
 			real dp_inc = fabs(glm::dot(eq.m_normalL, inc_face->m_normalL));
@@ -1646,9 +4751,294 @@ namespace vpe {
 				std::swap(eq.m_edge_ref, eq.m_edge_inc);
 			}
 			real sep = clipFaceFace(contact, ref_face, inc_face);		//Project and clip faces			
+			storeFeature(contact, Contact::FeatureCache::FEATURE_EDGE, eq.m_edge_ref->m_id, eq.m_edge_inc->m_id);
 			positionBias(eq.m_separation, sep, eq.m_normalL, contact);	//Add possibe position bias
 		}
 
+		//----------------------------------------------------------------------------------------------------
+		//GJK and EPA
+		//G. van den Bergen, Collision Detection in Interactive 3D Environments, chapters 4.3 and 4.4
+
+		/// <summary>
+		/// Compute the contact manifold of two polytopes. The polytopes select SAT or GJK/EPA with m_narrow_phase, 
+		/// if both leave it to the engine then GJK is used if SAT would test more than m_gjk_cost face normals and edge pairs.
+		/// </summary>
+		/// <param name="contact">The contact between the two bodies.</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool collidePolytopes(Contact& contact) {
+			auto* poly_ref = contact.m_body_ref.m_body->m_polytope;
+			auto* poly_inc = contact.m_body_inc.m_body->m_polytope;
+			if (poly_ref->m_narrow_phase == Polytope::NARROW_PHASE_GJK || poly_inc->m_narrow_phase == Polytope::NARROW_PHASE_GJK) return GJK(contact);
+			if (poly_ref->m_narrow_phase == Polytope::NARROW_PHASE_SAT || poly_inc->m_narrow_phase == Polytope::NARROW_PHASE_SAT) return SAT(contact);
+			size_t cost = poly_ref->m_faces.size() + poly_inc->m_faces.size() + poly_ref->m_edges.size() * poly_inc->m_edges.size();
+			return cost > m_gjk_cost ? GJK(contact) : SAT(contact);
+		}
+
+		static constexpr real c_gjk_tolerance = sizeof(real) > sizeof(float) ? (real)1.0e-8 : (real)1.0e-4;	//GJK and EPA stop if a support point improves less
+
+		/// <summary>
+		/// A point of the Minkowski difference of the reference and the incident polytope.
+		/// </summary>
+		struct SupportPoint {
+			glmvec3 m_w;	//vertex of the reference body minus vertex of the incident body, in world space
+			uint_t	m_ref;	//index of the vertex of the reference polytope
+			uint_t	m_inc;	//index of the vertex of the incident polytope
+		};
+
+		/// <summary>
+		/// A triangle of the polytope that EPA expands towards the boundary of the Minkowski difference.
+		/// </summary>
+		struct EpaFace {
+			std::array<uint32_t, 3> m_points;	//indices into m_epa_points, counter clockwise seen from outside
+			glmvec3	m_normalW;					//outwards pointing normal
+			real	m_distance;					//distance of the origin to the plane of the triangle
+		};
+
+		std::vector<SupportPoint> m_epa_points;	//points of the EPA polytope, reused
+		std::vector<EpaFace> m_epa_faces;		//triangles of the EPA polytope, reused
+		std::vector<std::pair<uint32_t, uint32_t>> m_epa_horizon;	//edges between visible and hidden triangles, reused
+
+		/// <summary>
+		/// Point of the Minkowski difference from two vertices.
+		/// </summary>
+		/// <param name="contact">The contact between two polytopes.</param>
+		/// <param name="ref">Vertex index in the reference polytope.</param>
+		/// <param name="inc">Vertex index in the incident polytope.</param>
+		/// <returns>The support point.</returns>
+		SupportPoint supportPoint(Contact& contact, uint_t ref, uint_t inc) {
+			return { RTOWP(contact.m_body_ref.m_body->m_polytope->m_vertices[ref].m_positionL) - ITOWP(contact.m_body_inc.m_body->m_polytope->m_vertices[inc].m_positionL), ref, inc };
+		}
+
+		/// <summary>
+		/// Support mapping of the Minkowski difference of the reference and the incident polytope.
+		/// </summary>
+		/// <param name="contact">The contact between two polytopes.</param>
+		/// <param name="dirW">Search direction in world space.</param>
+		/// <returns>The point of the Minkowski difference farthest in this direction.</returns>
+		SupportPoint supportPoint(Contact& contact, glmvec3 dirW) {
+			Vertex* vert_ref = contact.m_body_ref.m_body->support(WTORN(dirW));
+			Vertex* vert_inc = contact.m_body_inc.m_body->support(glm::transpose(contact.m_body_inc.m_body->m_model.m_linear) * -dirW);
+			return supportPoint(contact, vert_ref->m_id, vert_inc->m_id);
+		}
+
+		/// <summary>
+		/// Find the point of a simplex closest to the origin by testing the Voronoi regions of its features,
+		/// see C. Ericson, Real-Time Collision Detection, chapter 5.1. The simplex is reduced to the feature 
+		/// containing this point.
+		/// </summary>
+		/// <param name="s">The simplex, is reduced.</param>
+		/// <param name="n">Number of simplex points, is reduced.</param>
+		/// <returns>The closest point, or zero if the origin is inside the tetrahedron.</returns>
+		static glmvec3 closestSimplex(std::array<SupportPoint, 4>& s, uint32_t& n) {
+			auto vertex = [&](const SupportPoint& a) { s[0] = a; n = 1; return a.m_w; };
+
+			auto segment = [&](SupportPoint a, SupportPoint b) {
+				glmvec3 ab = b.m_w - a.m_w;
+				real t = -glm::dot(a.m_w, ab);
+				real l = glm::dot(ab, ab);
+				if (t <= (real)0.0 || l <= c_eps) return vertex(a);
+				if (t >= l) return vertex(b);
+				s[0] = a; s[1] = b; n = 2;
+				return a.m_w + ab * (t / l);
+			};
+
+			auto triangle = [&](SupportPoint a, SupportPoint b, SupportPoint c) {
+				glmvec3 ab = b.m_w - a.m_w, ac = c.m_w - a.m_w;
+				real d1 = -glm::dot(ab, a.m_w), d2 = -glm::dot(ac, a.m_w);
+				if (d1 <= (real)0.0 && d2 <= (real)0.0) return vertex(a);
+				real d3 = -glm::dot(ab, b.m_w), d4 = -glm::dot(ac, b.m_w);
+				if (d3 >= (real)0.0 && d4 <= d3) return vertex(b);
+				real vc = d1 * d4 - d3 * d2;
+				if (vc <= (real)0.0 && d1 >= (real)0.0 && d3 <= (real)0.0) return segment(a, b);
+				real d5 = -glm::dot(ab, c.m_w), d6 = -glm::dot(ac, c.m_w);
+				if (d6 >= (real)0.0 && d5 <= d6) return vertex(c);
+				real vb = d5 * d2 - d1 * d6;
+				if (vb <= (real)0.0 && d2 >= (real)0.0 && d6 <= (real)0.0) return segment(a, c);
+				real va = d3 * d6 - d5 * d4;
+				if (va <= (real)0.0 && d4 - d3 >= (real)0.0 && d5 - d6 >= (real)0.0) return segment(b, c);
+				real sum = va + vb + vc;
+				if (sum <= c_eps) {			//the points are on a line, keep the longest segment
+					glmvec3 bc = c.m_w - b.m_w;
+					real lab = glm::dot(ab, ab), lac = glm::dot(ac, ac), lbc = glm::dot(bc, bc);
+					return lab >= lac && lab >= lbc ? segment(a, b) : (lac >= lbc ? segment(a, c) : segment(b, c));
+				}
+				s[0] = a; s[1] = b; s[2] = c; n = 3;
+				return a.m_w + ab * (vb / sum) + ac * (vc / sum);
+			};
+
+			auto tetrahedron = [&](SupportPoint a, SupportPoint b, SupportPoint c, SupportPoint d) {
+				std::array<std::array<SupportPoint, 4>, 4> faces{ { { a, b, c, d }, { a, c, d, b }, { a, d, b, c }, { b, d, c, a } } };	//each face and the opposite point
+				real min = std::numeric_limits<real>::max();
+				glmvec3 result{ 0 };
+				std::array<SupportPoint, 4> min_s{ a, b, c, d };
+				uint32_t min_n = 4;
+				for (auto& f : faces) {
+					glmvec3 normal = glm::cross(f[1].m_w - f[0].m_w, f[2].m_w - f[0].m_w);
+					if (-glm::dot(normal, f[0].m_w) * glm::dot(normal, f[3].m_w - f[0].m_w) > (real)0.0) continue;	//origin and opposite point on the same side
+					glmvec3 p = triangle(f[0], f[1], f[2]);
+					if (glm::dot(p, p) < min) { min = glm::dot(p, p); result = p; min_s = s; min_n = n; }
+				}
+				s = min_s; n = min_n;
+				return result;
+			};
+
+			switch (n) {
+			case 1: return s[0].m_w;
+			case 2: return segment(s[0], s[1]);
+			case 3: return triangle(s[0], s[1], s[2]);
+			default: return tetrahedron(s[0], s[1], s[2], s[3]);
+			}
+		}
+
+		/// <summary>
+		/// GJK distance query for two polytopes, starting with the simplex cached in the contact. If the polytopes
+		/// overlap, EPA finds the penetration depth. The resulting normal selects the reference and incident faces
+		/// best aligned with it, and clipFaceFace() computes the contact manifold from them like in SAT().
+		/// </summary>
+		/// <param name="contact">The contact between the two bodies.</param>
+		/// <returns>True if the bodies touch.</returns>
+		bool GJK(Contact& contact) {
+			contact.m_body_ref.m_to_other = contact.m_body_inc.m_body->m_model_inv * contact.m_body_ref.m_body->m_model; //transform to bring space A to space B
+			contact.m_body_inc.m_to_other = contact.m_body_ref.m_body->m_model_inv * contact.m_body_inc.m_body->m_model; //transform to bring space B to space A
+
+			auto& cache = contact.m_simplex;
+			bool swapped = cache.m_ref == contact.m_body_inc.m_body.get();	//SAT or an earlier GJK may have swapped the bodies
+			size_t num_ref = contact.m_body_ref.m_body->m_polytope->m_vertices.size();
+			size_t num_inc = contact.m_body_inc.m_body->m_polytope->m_vertices.size();
+			std::array<SupportPoint, 4> s;
+			uint32_t n = 0;
+			for (uint32_t i = 0; i < cache.m_size; ++i) {
+				uint_t ref = swapped ? cache.m_vertex_inc[i] : cache.m_vertex_ref[i];
+				uint_t inc = swapped ? cache.m_vertex_ref[i] : cache.m_vertex_inc[i];
+				if (ref < num_ref && inc < num_inc) s[n++] = supportPoint(contact, ref, inc);	//a reused contact may hold a simplex of other polytopes
+			}
+			if (n == 0) s[n++] = supportPoint(contact, contact.m_body_inc.m_body->m_positionW - contact.m_body_ref.m_body->m_positionW);
+
+			auto store = [&]() {
+				cache.m_ref = contact.m_body_ref.m_body.get();
+				cache.m_size = n;
+				for (uint32_t i = 0; i < n; ++i) { cache.m_vertex_ref[i] = s[i].m_ref; cache.m_vertex_inc[i] = s[i].m_inc; }
+			};
+
+			glmvec3 v = closestSimplex(s, n);		//closest point of the simplex to the origin
+			bool overlap = false;
+			for (int i = 0; i < m_gjk_iterations; ++i) {
+				real vv = glm::dot(v, v);
+				if (n == 4 || vv <= c_eps) { overlap = true; break; }	//the origin is inside the Minkowski difference
+				SupportPoint w = supportPoint(contact, -v);
+				real vw = glm::dot(v, w.m_w);
+				if (vw > (real)0.0 && vw * vw > vv * m_collision_margin * m_collision_margin) { store(); return false; }	//vw/|v| is a lower bound of the distance
+				bool known = std::any_of(s.begin(), s.begin() + n, [&](auto& p) { return p.m_ref == w.m_ref && p.m_inc == w.m_inc; });
+				if (known || vv - vw <= c_gjk_tolerance * vv) break;	//no progress, v is the closest point
+				s[n++] = w;
+				v = closestSimplex(s, n);
+			}
+			store();
+
+			glmvec3 normalW;	//from the reference to the incident body
+			real separation;
+			if (!overlap) {
+				separation = glm::length(v);
+				if (separation > m_collision_margin) return false;
+				normalW = -v / separation;
+			}
+			else if (!EPA(contact, s, n, normalW, separation)) return SAT(contact);	//Minkowski difference is flat
+
+			glmvec3 nR = glm::normalize(WTORN(normalW));
+			glmvec3 nI = glm::normalize(glm::transpose(contact.m_body_inc.m_body->m_model.m_linear) * -normalW);
+			Face* ref_face = maxFaceAlignment(nR, contact.m_body_ref.m_body->support(nR)->m_vertex_face_ptrs);	//faces at the supporting vertices
+			Face* inc_face = maxFaceAlignment(nI, contact.m_body_inc.m_body->support(nI)->m_vertex_face_ptrs);
+
+			real dp_ref = glm::dot(RTOWN(ref_face->m_normalL), normalW);	//Use the better aligned face as reference face
+			real dp_inc = -glm::dot(glm::normalize(contact.m_body_inc.m_body->m_model.normal(inc_face->m_normalL)), normalW);
+			if (dp_inc > dp_ref) {
+				std::swap(contact.m_body_ref, contact.m_body_inc);
+				std::swap(ref_face, inc_face);
+				normalW = -normalW;
+			}
+			contact.m_separating_axisW = glmvec3{ 0,0,0 };
+			real sep = clipFaceFace(contact, ref_face, inc_face);		//Project and clip faces
+			positionBias(separation, sep, glm::normalize(WTORN(normalW)), contact);	//Add possibe position bias, the reference body may have been swapped
+			return true;
+		}
+
+		/// <summary>
+		/// Expanding polytope algorithm. Starting with the GJK simplex that contains the origin, add support points 
+		/// until the triangle of the polytope closest to the origin is on the boundary of the Minkowski difference.
+		/// </summary>
+		/// <param name="contact">The contact between two polytopes.</param>
+		/// <param name="s">Final GJK simplex.</param>
+		/// <param name="n">Number of simplex points.</param>
+		/// <param name="normalW">Returns the normal from the reference to the incident body.</param>
+		/// <param name="separation">Returns the negative penetration depth.</param>
+		/// <returns>False if no tetrahedron could be found, because the Minkowski difference is flat.</returns>
+		bool EPA(Contact& contact, const std::array<SupportPoint, 4>& s, uint32_t n, glmvec3& normalW, real& separation) {
+			auto& points = m_epa_points;
+			auto& faces = m_epa_faces;
+			points.assign(s.begin(), s.begin() + n);
+
+			auto extend = [&](const std::initializer_list<glmvec3>& dirs, auto&& useful) {	//add the first support point that makes the simplex larger
+				for (auto& dir : dirs) {
+					SupportPoint w = supportPoint(contact, dir);
+					if (useful(w.m_w)) { points.push_back(w); return; }
+				}
+			};
+			if (points.size() == 1) {	//GJK may stop early with the origin on a vertex, edge, or triangle
+				extend({ { 1,0,0 }, { -1,0,0 }, { 0,1,0 }, { 0,-1,0 }, { 0,0,1 }, { 0,0,-1 } }, [&](glmvec3 w) { return glm::length(w - points[0].m_w) > c_gjk_tolerance; });
+			}
+			if (points.size() == 2) {
+				glmvec3 d = glm::normalize(points[1].m_w - points[0].m_w);
+				glmvec3 axis = std::fabs(d.x) < (real)0.5 ? glmvec3{ 1,0,0 } : glmvec3{ 0,1,0 };
+				glmvec3 p = glm::normalize(glm::cross(d, axis)), q = glm::cross(d, p);
+				extend({ p, -p, q, -q }, [&](glmvec3 w) { return glm::length(glm::cross(w - points[0].m_w, d)) > c_gjk_tolerance; });
+			}
+			if (points.size() == 3) {
+				glmvec3 normal = glm::normalize(glm::cross(points[1].m_w - points[0].m_w, points[2].m_w - points[0].m_w));
+				extend({ normal, -normal }, [&](glmvec3 w) { return std::fabs(glm::dot(normal, w - points[0].m_w)) > c_gjk_tolerance; });
+			}
+			if (points.size() < 4) return false;
+
+			auto addFace = [&](uint32_t a, uint32_t b, uint32_t c) {
+				glmvec3 normal = glm::cross(points[b].m_w - points[a].m_w, points[c].m_w - points[a].m_w);
+				real l = glm::length(normal);
+				if (l <= c_eps) { faces.push_back({ { a, b, c }, glmvec3{ 0 }, std::numeric_limits<real>::max() }); return; }	//never closest, never visible
+				normal /= l;
+				faces.push_back({ { a, b, c }, normal, glm::dot(normal, points[a].m_w) });
+			};
+
+			faces.clear();
+			glmvec3 center = (points[0].m_w + points[1].m_w + points[2].m_w + points[3].m_w) * (real)0.25;
+			for (auto [a, b, c] : { std::array<uint32_t, 3>{ 0, 1, 2 }, { 0, 3, 1 }, { 0, 2, 3 }, { 1, 3, 2 } }) {
+				glmvec3 normal = glm::cross(points[b].m_w - points[a].m_w, points[c].m_w - points[a].m_w);
+				if (glm::dot(normal, points[a].m_w - center) < (real)0.0) std::swap(b, c);	//point outwards
+				addFace(a, b, c);
+			}
+
+			for (int i = 0; i < m_gjk_iterations; ++i) {
+				auto& closest = *std::ranges::min_element(faces, {}, &EpaFace::m_distance);
+				normalW = closest.m_normalW;
+				separation = -closest.m_distance;
+				SupportPoint w = supportPoint(contact, normalW);
+				if (glm::dot(w.m_w, normalW) + separation <= c_gjk_tolerance * std::max((real)1.0, -separation)) break;	//the triangle is on the boundary
+
+				uint32_t idx = (uint32_t)points.size();
+				points.push_back(w);
+				m_epa_horizon.clear();
+				std::erase_if(faces, [&](EpaFace& f) {	//remove the triangles that see the new point, and find the horizon
+					if (glm::dot(f.m_normalW, w.m_w - points[f.m_points[0]].m_w) <= (real)0.0) return false;
+					for (uint32_t k = 0; k < 3; ++k) {
+						std::pair<uint32_t, uint32_t> edge{ f.m_points[k], f.m_points[(k + 1) % 3] };
+						auto it = std::ranges::find(m_epa_horizon, std::pair{ edge.second, edge.first });
+						if (it != m_epa_horizon.end()) m_epa_horizon.erase(it);		//edge between two removed triangles
+						else m_epa_horizon.push_back(edge);
+					}
+					return true;
+				});
+				for (auto& [a, b] : m_epa_horizon) addFace(a, b, idx);	//connect the horizon to the new point
+			}
+			return true;
+		}
+
 
 		// -----------------Begin Constraints Implementation -------------------------
 		// by Julian Schneebaur
@@ -1663,35 +5053,195 @@ namespace vpe {
 		/// </summary>
 		/// <param name="dt">Elapsed time</param>
 		void setupConstraints(double dt) {
-			for (const auto& constraint : m_constraints) {
-				constraint->setUp((real)dt);
-			}
+			forEachConstraintArray([&](auto& array) {
+				for (auto& constraint : array.m_constraints) {
+					if (!isAwake(constraint.body1()) && !isAwake(constraint.body2())) continue;
+					constraint.setUp((real)dt);
+				}
+			});
+		}
+
+		/// <summary>
+		/// Solve the velocity constraints of all constraints with an awake body, one constraint type after the other.
+		/// </summary>
+		void solveConstraints() {
+			forEachConstraintArray([&](auto& array) {
+				for (auto& constraint : array.m_constraints) {
+					if (!isAwake(constraint.body1()) && !isAwake(constraint.body2())) continue;
+					constraint.solveVelocity();
+				}
+			});
+		}
+
+		/// <summary>
+		/// Adds a constraint to the physics simulation. The constraint is copied into the array of its type.
+		/// </summary>
+		/// <param name="constraint">The constraint to be added, e.g. a HingeJoint</param>
+		/// <returns>Handle for accessing or removing the constraint later.</returns>
+		template<typename C>
+		ConstraintHandle addConstraint(C constraint) {
+			ignorePair(constraint, true);
+			auto& array = std::get<ConstraintArray<C>>(m_constraints);
+			Body* body1 = constraint.body1();
+			Body* body2 = constraint.body2();
+			uint32_t slot = array.add(std::move(constraint));
+			ConstraintHandle handle{ constraintType<C>(), slot, array.m_generations[slot] };
+			body1->m_constraints.push_back(handle);
+			body2->m_constraints.push_back(handle);
+			return handle;
+		}
+
+		/// <summary>
+		/// Access a constraint, e.g. to change its motor or limits.
+		/// The pointer is invalidated when any constraint of the same type is added or removed.
+		/// </summary>
+		/// <param name="handle">Handle returned by addConstraint()</param>
+		/// <returns>Pointer to the constraint, or nullptr if it was removed or is not of type C.</returns>
+		template<typename C>
+		C* getConstraint(ConstraintHandle handle) {
+			if (handle.m_type != constraintType<C>()) return nullptr;
+			return std::get<ConstraintArray<C>>(m_constraints).get(handle.m_slot, handle.m_generation);
+		}
+
+		/// <summary>
+		/// Removes a constraint from the physics simulation and wakes its bodies
+		/// </summary>
+		/// <param name="handle">Handle of the constraint to be removed</param>
+		void removeConstraint(ConstraintHandle handle) {
+			uint32_t type = 0;
+			forEachConstraintArray([&](auto& array) {
+				if (type++ != handle.m_type) return;
+				if (auto* constraint = array.get(handle.m_slot, handle.m_generation)) {
+					wakeBody(constraint->body1());		//the bodies may have been held by the constraint
+					wakeBody(constraint->body2());
+					ignorePair(*constraint, false);
+					std::erase(constraint->body1()->m_constraints, handle);
+					std::erase(constraint->body2()->m_constraints, handle);
+					array.erase(array.m_indices[handle.m_slot]);
+				}
+			});
+		}
+
+		/// <summary>
+		/// Call a function for each constraint. The function is instantiated for each constraint type, so it
+		/// can call the constraint's methods without virtual dispatch.
+		/// </summary>
+		/// <param name="func">Called with each constraint, as its actual type.</param>
+		template<typename F>
+		void forEachConstraint(F&& func) {
+			forEachConstraintArray([&](auto& array) { for (auto& constraint : array.m_constraints) func(constraint); });
+		}
+
+		/// <summary>
+		/// Call a function for the constraint array of each type, in the order of m_constraints.
+		/// </summary>
+		/// <param name="func">Called with each ConstraintArray.</param>
+		template<typename F>
+		void forEachConstraintArray(F&& func) {
+			std::apply([&](auto&... arrays) { (func(arrays), ...); }, m_constraints);
 		}
 
 		/// <summary>
-		/// Adds a constraint to the physics simulation
+		/// Index of a constraint type in m_constraints, stored in its handles.
 		/// </summary>
-		/// <param name="constraint">Pointer to the constraint to be added</param>
-		void addConstraint(std::shared_ptr<Constraint> constraint) {
-			m_constraints.push_back(constraint);
+		template<typename C>
+		static constexpr uint32_t constraintType() {
+			return []<typename... A>(std::tuple<A...>*) {
+				uint32_t type = 0;
+				((std::is_same_v<A, ConstraintArray<C>> ? false : (++type, true)) && ...);
+				return type;
+			}((constraint_arrays_t*)nullptr);
 		}
 
 		/// <summary>
-		/// Removes a constraint from the physics simulation
+		/// Constraints of one type in a contiguous array, which is what the solver iterates over. Handles refer to slots, 
+		/// and each slot maps to an index in the array, so that a constraint can be removed in O(1) by moving the last one into its place.
+		/// </summary>
+		template<typename C>
+		struct ConstraintArray {
+			std::pmr::vector<C>			m_constraints;	//the constraints of this type
+			std::pmr::vector<uint32_t>	m_slots;		//slot of each constraint
+			std::pmr::vector<uint32_t>	m_indices;		//index into m_constraints of each slot
+			std::pmr::vector<uint32_t>	m_generations;	//incremented when a slot is freed, so old handles become invalid
+			std::pmr::vector<uint32_t>	m_free_slots;	//slots that can be reused
+
+			ConstraintArray(std::pmr::memory_resource* resource) 
+				: m_constraints{ resource }, m_slots{ resource }, m_indices{ resource }, m_generations{ resource }, m_free_slots{ resource } {}
+
+			/// <summary>
+			/// Append a constraint and return its slot.
+			/// </summary>
+			uint32_t add(C&& constraint) {
+				uint32_t slot = (uint32_t)m_indices.size();
+				if (m_free_slots.empty()) {
+					m_indices.push_back(0);
+					m_generations.push_back(0);
+				}
+				else {
+					slot = m_free_slots.back();
+					m_free_slots.pop_back();
+				}
+				m_indices[slot] = (uint32_t)m_constraints.size();
+				m_slots.push_back(slot);
+				m_constraints.push_back(std::move(constraint));
+				return slot;
+			}
+
+			/// <summary>
+			/// Return the constraint in a slot, or nullptr if the slot was freed since.
+			/// </summary>
+			C* get(uint32_t slot, uint32_t generation) {
+				if (slot >= m_indices.size() || m_generations[slot] != generation) return nullptr;
+				return &m_constraints[m_indices[slot]];
+			}
+
+			/// <summary>
+			/// Erase the constraint at an index of m_constraints by moving the last constraint into its place.
+			/// </summary>
+			void erase(uint32_t index) {
+				uint32_t slot = m_slots[index];
+				++m_generations[slot];
+				m_free_slots.push_back(slot);
+				if (index + 1 < m_constraints.size()) {
+					m_constraints[index] = std::move(m_constraints.back());
+					m_slots[index] = m_slots.back();
+					m_indices[m_slots[index]] = index;
+				}
+				m_constraints.pop_back();
+				m_slots.pop_back();
+			}
+
+			/// <summary>
+			/// Erase all constraints, invalidating their handles.
+			/// </summary>
+			void clear() {
+				while (!m_constraints.empty()) erase((uint32_t)m_constraints.size() - 1);
+			}
+		};
+
+		/// <summary>
+		/// Add or remove the two bodies of a constraint to the pairs that do not collide, unless the constraint sets m_collide_connected.
 		/// </summary>
-		/// <param name="constraint">Pointer to the constraint to be removed</param>
-		void removeConstraint(std::shared_ptr<Constraint> constraint) {
-			std::erase(m_constraints, constraint);
+		/// <param name="constraint">The constraint.</param>
+		/// <param name="add">True if the constraint is added, false if it is removed.</param>
+		void ignorePair(const Constraint& constraint, bool add) {
+			if (constraint.m_collide_connected) return;
+			voidppair_t key{ constraint.body1()->m_owner, constraint.body2()->m_owner };
+			if (add) { ++m_ignore_pairs[key]; return; }
+			auto it = m_ignore_pairs.find(key);
+			if (it != m_ignore_pairs.end() && --it->second == 0) m_ignore_pairs.erase(it);
 		}
 
 		/// <summary>
 		/// Base class for all constraints. 
 		/// A constraint enforces a condition between two bodies' relative movement.
-		/// It does this by computing and applying impulses that make sure the bodies only move in a way that doesn't violate the constraint
+		/// It does this by computing and applying impulses that make sure the bodies only move in a way that doesn't violate the constraint.
+		/// Each constraint type implements setUp(real dt) to pre-compute values for the loop iterations, and solveVelocity() to apply
+		/// the constraint impulses. These are not virtual, the world keeps each type in its own array and solves the arrays one after the other.
 		/// </summary>
 		class Constraint {
 		protected:
-			static constexpr real epsilon = 0.0000001_real;
+			static constexpr real epsilon = (real)0.0000001;
 			std::shared_ptr<Body> m_body1;	// First body
 			std::shared_ptr<Body> m_body2;	// Second body
 
@@ -1702,19 +5252,15 @@ namespace vpe {
 			real m_body1_factor = !(m_body1->m_mass_inv <= Constraint::epsilon); // Use this factor whenever adding angular velocity to body1
 			real m_body2_factor = !(m_body2->m_mass_inv <= Constraint::epsilon); // Use this factor whenever adding angular velocity to body2
 		public:
+			bool m_collide_connected{ false };	//if false then the two bodies do not collide with each other, set it before addConstraint()
+
 			Constraint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2) : m_body1 { body1 }, m_body2{ body2 } {}
-			virtual ~Constraint() {}
 
 			/// <summary>
-			/// Computes values that are needed for subsequent loop iteration
-			/// These values don't change when applying impulses during the loop, so computing them here gives us much better performance
+			/// Called if the origin of the world is shifted. Constraints storing world space data hide this and move it by -offset.
 			/// </summary>
-			/// <param name="dt">Simulation time step</param>
-			virtual void setUp(real dt) = 0;
-			/// <summary>
-			/// Computes and applies constraint forces by solving the velocity constraint
-			/// </summary>
-			virtual void solveVelocity() = 0;
+			/// <param name="offset">Position of the new origin in old world coordinates</param>
+			void shiftOrigin(const glmvec3& /*offset*/) {}
 
 			/// <summary>
 			/// Should return true if the body is part of the constraint
@@ -1725,6 +5271,16 @@ namespace vpe {
 				return body == m_body1 || body == m_body2;
 			}
 
+			/// <summary>
+			/// Returns the first body of the constraint
+			/// </summary>
+			Body* body1() const { return m_body1.get(); }
+
+			/// <summary>
+			/// Returns the second body of the constraint
+			/// </summary>
+			Body* body2() const { return m_body2.get(); }
+
 		};
 
 		/// <summary>
@@ -1732,17 +5288,22 @@ namespace vpe {
 		/// Given two bodies, the constraint makes sure there is always a given distance between their center points
 		/// </summary>
 		class DistanceConstraint : public Constraint {
+			using Constraint::m_body1;						// Members of the base class, which is dependent on the template parameter
+			using Constraint::m_body2;
+			using Constraint::m_body1_factor;
+			using Constraint::m_body2_factor;
+
 			real m_distance;							// The distance the constraint has to maintain
-			real m_bias_factor = 0.1_real;				// Bias factor for Baumgarte stabilization
+			real m_bias_factor = (real)0.1;				// Bias factor for Baumgarte stabilization
 
 			// These values are computed once in setUp() before each constraint loop, as they don't change between iterations
-			glmvec3 m_rel_pos{ 0.0_real };				// Relative position of the bodies
-			real m_body_distance = 0.0_real;			// Distance between bodies
-			real m_offset = 0.0_real;					// The constraint error
-			glmvec3 m_j1{ 0.0_real };					// First entry of jacobian matrix
-			glmvec3 m_j2{ 0.0_real };					// Second entry of jacobian matrix
-			real m_inv_constraint_mass = 0.0_real;		// Inverse effective constraint mass
-			real m_bias = 0.0_real;						// Bias for Baumgarte stabilization
+			glmvec3 m_rel_pos{ (real)0.0 };				// Relative position of the bodies
+			real m_body_distance = (real)0.0;			// Distance between bodies
+			real m_offset = (real)0.0;					// The constraint error
+			glmvec3 m_j1{ (real)0.0 };					// First entry of jacobian matrix
+			glmvec3 m_j2{ (real)0.0 };					// Second entry of jacobian matrix
+			real m_inv_constraint_mass = (real)0.0;		// Inverse effective constraint mass
+			real m_bias = (real)0.0;						// Bias for Baumgarte stabilization
 		public:
 			/// <summary>
 			/// Constructor
@@ -1751,7 +5312,6 @@ namespace vpe {
 			/// <param name="body2">Second body</param>
 			/// <param name="distance">Distance the constraint should maintain</param>
 			DistanceConstraint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2, real distance) : Constraint(body1, body2), m_distance{ distance } {}
-			~DistanceConstraint() {}
 
 			/// <summary>
 			/// Use to update the Baumgarte stabilization bias
@@ -1761,7 +5321,7 @@ namespace vpe {
 				m_bias_factor = new_bias;
 			}
 
-			void setUp(real dt) override {
+			void setUp(real dt) {
 				// Compute distance between the objects' center, their distance and the difference to the constraint distance
 				m_rel_pos = m_body1->m_positionW - m_body2->m_positionW;
 				m_body_distance = glm::length(m_rel_pos);
@@ -1773,7 +5333,7 @@ namespace vpe {
 
 				// Compute total constraint mass and invert it if possible
 				real total_mass = m_body1->m_mass_inv + m_body2->m_mass_inv;
-				m_inv_constraint_mass = total_mass < Constraint::epsilon ? 0.0_real : 1.0_real / total_mass;
+				m_inv_constraint_mass = total_mass < Constraint::epsilon ? (real)0.0 : (real)1.0 / total_mass;
 
 				// Compute bias for Baumgarte stabilization
 				m_bias = (m_bias_factor * m_offset) / dt;
@@ -1782,8 +5342,8 @@ namespace vpe {
 			/// <summary>
 			/// Compute and apply constraint impulses
 			/// </summary>
-			void solveVelocity() override {
-				if (abs(m_offset) > Constraint::epsilon) {
+			void solveVelocity() {
+				if (fabs(m_offset) > Constraint::epsilon) {
 					// Compute dot product of Jacobian and velocity vector; keep in mind that j2 = -j1, so the original expression can be simplified
 					real jv = glm::dot(m_body1->m_linear_velocityW - m_body2->m_linear_velocityW, m_j1);
 					real lambda = m_inv_constraint_mass * -(jv - m_bias);
@@ -1802,7 +5362,12 @@ namespace vpe {
 		/// They can rotate around the anchor point freely, but no relative translation is allowed
 		/// </summary>
 		class BallSocketJoint : public Constraint {
-			real m_bias_factor = 0.15_real;					// Bias factor for Baumgarte stabilization
+			using Constraint::m_body1;						// Members of the base class, which is dependent on the template parameter
+			using Constraint::m_body2;
+			using Constraint::m_body1_factor;
+			using Constraint::m_body2_factor;
+
+			real m_bias_factor = (real)0.15;					// Bias factor for Baumgarte stabilization
 
 			// These values are set when the Joint is created
 			glmvec3 m_anchor_w;								// Anchor point in world space
@@ -1810,15 +5375,15 @@ namespace vpe {
 			glmvec3 m_anchor_body2;							// Anchor point in local space of body2
 
 			// These values are computed once before each loop as they don't change between iterations		
-			glmvec3 m_r1{ 0.0_real };						// vector from body1's center to body1's anchor in world space
-			glmvec3 m_r2{ 0.0_real };						// vector from body2's center to body2's anchor in world space
-			glmvec3 m_offset{ 0.0_real };					// Constraint error
-			glmmat3 m_j1{ 0.0_real };						// First part of Jacobian
-			glmmat3 m_j2{ 0.0_real };;						// Second part of Jacobian
-			glmmat3 m_j3{ 0.0_real };						// Third part of Jacobian
-			glmmat3 m_j4{ 0.0_real };						// Fourth part of Jacobian
-			glmmat3 m_inv_constraint_mass{ 0.0_real };		// Inverse effective constraint mass
-			glmvec3 m_bias{ 0.0_real };						// Bias to be used for Baumgarte stabilization
+			glmvec3 m_r1{ (real)0.0 };						// vector from body1's center to body1's anchor in world space
+			glmvec3 m_r2{ (real)0.0 };						// vector from body2's center to body2's anchor in world space
+			glmvec3 m_offset{ (real)0.0 };					// Constraint error
+			glmmat3 m_j1{ (real)0.0 };						// First part of Jacobian
+			glmmat3 m_j2{ (real)0.0 };;						// Second part of Jacobian
+			glmmat3 m_j3{ (real)0.0 };						// Third part of Jacobian
+			glmmat3 m_j4{ (real)0.0 };						// Fourth part of Jacobian
+			glmmat3 m_inv_constraint_mass{ (real)0.0 };		// Inverse effective constraint mass
+			glmvec3 m_bias{ (real)0.0 };						// Bias to be used for Baumgarte stabilization
 		public:
 			/// <summary>
 			/// Constructor
@@ -1828,10 +5393,9 @@ namespace vpe {
 			/// <param name="anchor">Anchor point in world space</param>
 			BallSocketJoint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2, glmvec3 anchor) : Constraint(body1, body2), m_anchor_w{ anchor } {
 				// Move the anchor point to local space for each body
-				m_anchor_body1 = m_body1->m_model_inv * glmvec4(m_anchor_w, 1.0_real);
-				m_anchor_body2 = m_body2->m_model_inv * glmvec4(m_anchor_w, 1.0_real);
+				m_anchor_body1 = m_body1->m_model_inv.point(m_anchor_w);
+				m_anchor_body2 = m_body2->m_model_inv.point(m_anchor_w);
 			}
-			~BallSocketJoint() {}
 
 			/// <summary>
 			/// Use to update the Baumgarte stabilization bias for the translation constraint
@@ -1841,14 +5405,22 @@ namespace vpe {
 				m_bias_factor = new_bias;
 			}
 
+			/// <summary>
+			/// Move the world space anchor if the origin of the world is shifted
+			/// </summary>
+			/// <param name="offset">Position of the new origin in old world coordinates</param>
+			void shiftOrigin(const glmvec3& offset) {
+				m_anchor_w -= offset;
+			}
+
 			/// <summary>
 			/// Computes values that remain static within one loop/timestep
 			/// </summary>
 			/// <param name="dt">Simulation timestep</param>
-			void setUp(real dt) override {
+			void setUp(real dt) {
 				// Move anchor points back to world space
-				glmvec3 anchor1 = m_body1->m_model * glmvec4(m_anchor_body1, 1.0_real);
-				glmvec3 anchor2 = m_body2->m_model * glmvec4(m_anchor_body2, 1.0_real);
+				glmvec3 anchor1 = m_body1->m_model.point(m_anchor_body1);
+				glmvec3 anchor2 = m_body2->m_model.point(m_anchor_body2);
 
 				// compute vector from body center to bodies' anchor in world space
 				m_r1 = anchor1 - m_body1->m_positionW;
@@ -1856,22 +5428,22 @@ namespace vpe {
 				m_offset = anchor2 - anchor1;
 
 				// Compute components of Jacobian matrix
-				m_j1 = glm::mat3(-1.0_real);
+				m_j1 = glmmat3(-(real)1.0);
 				m_j2 = glm::matrixCross3(m_r1);
-				m_j3 = glm::mat3(1.0_real);
+				m_j3 = glmmat3((real)1.0);
 				m_j4 = -glm::matrixCross3(m_r2);
 
 				// Compute total constraint mass
-				glmmat3 constraint_mass = m_body1->m_mass_inv * glmmat3(1.0_real) + m_j2 * m_body1->m_inertia_invW * glm::transpose(m_j2) + m_body2->m_mass_inv * glmmat3(1.0_real) + (-m_j4) * m_body2->m_inertia_invW * glm::transpose(-m_j4);
+				glmmat3 constraint_mass = m_body1->m_mass_inv * glmmat3((real)1.0) + m_j2 * m_body1->m_inertia_invW * glm::transpose(m_j2) + m_body2->m_mass_inv * glmmat3((real)1.0) + (-m_j4) * m_body2->m_inertia_invW * glm::transpose(-m_j4);
 				// only invert if matrix is actually invertible - can happen when two bodies with infinite mass are involved
-				m_inv_constraint_mass = glm::determinant(constraint_mass) < Constraint::epsilon ? glmmat3(0.0_real) : glm::inverse(constraint_mass);
+				m_inv_constraint_mass = glm::determinant(constraint_mass) < Constraint::epsilon ? glmmat3((real)0.0) : glm::inverse(constraint_mass);
 				m_bias = (m_bias_factor / dt) * m_offset;
 			};
 
 			/// <summary>
 			/// Computes and applies constraint impulses
 			/// </summary>
-			void solveVelocity() override {
+			void solveVelocity() {
 				glmvec3 abs_offset = glm::abs(m_offset);
 				if (abs_offset.x > Constraint::epsilon || abs_offset.y > Constraint::epsilon || abs_offset.z > Constraint::epsilon) {
 					// Compute product of jacobian (3x12 matrix) and velocity vector (12x1 matrix) with submatrices
@@ -1903,10 +5475,15 @@ namespace vpe {
 		/// Supports angle limits and a motor
 		/// </summary>
 		class HingeJoint : public Constraint {
-			std::shared_ptr<BallSocketJoint> m_ballsocket;		// Used for the translation constraint
-			real m_bias_factor_rot = 0.15_real;					// Bias factor for translation constraint Baumgarte stabilization
-			real m_bias_factor_trans = 0.15_real;				// Bias factor for rotation constraint Baumgarte stabilization
-			real m_bias_factor_limit = 0.1_real;				// Bias factor for limit constraint Baumgarte stabilization
+			using Constraint::m_body1;						// Members of the base class, which is dependent on the template parameter
+			using Constraint::m_body2;
+			using Constraint::m_body1_factor;
+			using Constraint::m_body2_factor;
+
+			BallSocketJoint m_ballsocket;		// Used for the translation constraint
+			real m_bias_factor_rot = (real)0.15;					// Bias factor for translation constraint Baumgarte stabilization
+			real m_bias_factor_trans = (real)0.15;				// Bias factor for rotation constraint Baumgarte stabilization
+			real m_bias_factor_limit = (real)0.1;				// Bias factor for limit constraint Baumgarte stabilization
 
 			// These values are set once when the Joint is created
 			glmvec3 m_rot_axis_w;								// Hinge axis in world space
@@ -1919,31 +5496,31 @@ namespace vpe {
 			glmquat m_init_orientation_inv;						// Inverse of initial orientation between the two bodies
 
 			bool m_motor_active = false;						// Flag that enables the motor (if active, the constraint tries to maintain a certain angular velocity along the hinge axis)
-			real m_fmotor = 0.0_real;							// The speed of the motor in radians/s, i.e. the angular speed that should be maintained
-			real m_fmotor_max = 0.0_real;						// The maximum force the motor is allowed to apply per iteration, can be used to controll ramp up time to motor speed
+			real m_fmotor = (real)0.0;							// The speed of the motor in radians/s, i.e. the angular speed that should be maintained
+			real m_fmotor_max = (real)0.0;						// The maximum force the motor is allowed to apply per iteration, can be used to controll ramp up time to motor speed
 			bool m_body1_motor_factor = true;					// Whether body1 should be affected by motor forces
 			bool m_body2_motor_factor = true;					// Whether body2 should be affected by motor forces
 
 			// These values are computed in setUp() before each loop as they don't change between iterations
-			glmvec3 m_axis1_world{ 0.0_real };					// Hinge axis of body1 moved to world space
-			glmvec3 m_axis2_world{ 0.0_real };					// Hinge axis of body2 moved to world space
+			glmvec3 m_axis1_world{ (real)0.0 };					// Hinge axis of body1 moved to world space
+			glmvec3 m_axis2_world{ (real)0.0 };					// Hinge axis of body2 moved to world space
 
 			// Angle limit 
-			real m_bias_limit_min = 0.0_real;					// Baumgarte bias to be used for lower angle limit
-			real m_bias_limit_max = 0.0_real;					// Baumgarte bias to be used for upper angle limit
-			real m_theta = 0.0_real;							// Angle between the bodies along the hinge axis
-			real m_inv_constraint_mass_limit = 0.0_real;		// Inverted effective constraint mass for angle limit
+			real m_bias_limit_min = (real)0.0;					// Baumgarte bias to be used for lower angle limit
+			real m_bias_limit_max = (real)0.0;					// Baumgarte bias to be used for upper angle limit
+			real m_theta = (real)0.0;							// Angle between the bodies along the hinge axis
+			real m_inv_constraint_mass_limit = (real)0.0;		// Inverted effective constraint mass for angle limit
 
 			// Motor
-			real m_offset_motor = 0.0_real;						// Constraint error for motor
-			real m_inv_constraint_mass_motor = 0.0_real;		// Inverted effective constraint mass for motor
+			real m_offset_motor = (real)0.0;						// Constraint error for motor
+			real m_inv_constraint_mass_motor = (real)0.0;		// Inverted effective constraint mass for motor
 
 			// Rotation
-			glmvec2 m_offset_rotation{ 0.0_real };				// Constraint error for rotation constraint
-			glmvec3 m_bCa{ 0.0_real };							// Cross product needed for Jacobian and mass
-			glmvec3 m_cCa{ 0.0_real };							// Cross product needed for Jacobian and mass
-			glmmat2 m_inv_constraint_mass_rot{ 0.0_real };		// Inverted effective constraint mass for rotation constraint
-			glmvec2 m_bias_rotation{ 0.0_real };				// Baumgarte bias to be used for rotation constraint
+			glmvec2 m_offset_rotation{ (real)0.0 };				// Constraint error for rotation constraint
+			glmvec3 m_bCa{ (real)0.0 };							// Cross product needed for Jacobian and mass
+			glmvec3 m_cCa{ (real)0.0 };							// Cross product needed for Jacobian and mass
+			glmmat2 m_inv_constraint_mass_rot{ (real)0.0 };		// Inverted effective constraint mass for rotation constraint
+			glmvec2 m_bias_rotation{ (real)0.0 };				// Baumgarte bias to be used for rotation constraint
 
 			/// <summary>
 			/// Returns the inverse mass matrix for the motor and limit constraints
@@ -1952,7 +5529,7 @@ namespace vpe {
 			/// <returns></returns>
 			real getMotorAndLimitMass() const {
 				real mass = glm::dot(m_axis1_world * m_body1->m_inertia_invW, m_axis1_world) + glm::dot(m_axis1_world * m_body2->m_inertia_invW, m_axis1_world);
-				return mass < Constraint::epsilon ? 0.0_real : 1.0_real / mass;
+				return mass < Constraint::epsilon ? (real)0.0 : (real)1.0 / mass;
 			}
 
 		public:
@@ -1963,17 +5540,15 @@ namespace vpe {
 			/// <param name="body2">Second body</param>
 			/// <param name="anchor">Anchor point in world space</param>
 			/// <param name="axis">Hinge axis in world space</param>
-			HingeJoint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2, glmvec3 anchor, glmvec3 axis) : Constraint(body1, body2) {
+			HingeJoint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2, glmvec3 anchor, glmvec3 axis) : Constraint(body1, body2), m_ballsocket{ body1, body2, anchor } {
 				// Initialize ballsocket joint for translation constraint
-				m_ballsocket = std::make_shared<VPEWorld::BallSocketJoint>(m_body1, m_body2, anchor);
-				m_ballsocket->setTranslationBias(m_bias_factor_trans);
+				m_ballsocket.setTranslationBias(m_bias_factor_trans);
 				// Move rotation axis to local space of each body
 				m_rot_axis_w = glm::normalize(axis);
-				m_rot_axis_body1 = glm::normalize(m_body1->m_model_inv * glmvec4(m_rot_axis_w, 0.0_real));
-				m_rot_axis_body2 = glm::normalize(m_body2->m_model_inv * glmvec4(m_rot_axis_w, 0.0_real));
+				m_rot_axis_body1 = glm::normalize(m_body1->m_model_inv.vector(m_rot_axis_w));
+				m_rot_axis_body2 = glm::normalize(m_body2->m_model_inv.vector(m_rot_axis_w));
 			};
 
-			~HingeJoint() {}
 			
 			/// <summary>
 			/// Use this to specify whether body1 should be affected by the motor force or not
@@ -1997,7 +5572,15 @@ namespace vpe {
 			/// <param name="new_bias"></param>
 			void setTranslationBias(real new_bias) {
 				m_bias_factor_trans = new_bias;
-				m_ballsocket->setTranslationBias(m_bias_factor_trans);
+				m_ballsocket.setTranslationBias(m_bias_factor_trans);
+			}
+
+			/// <summary>
+			/// Move the anchor of the translation constraint if the origin of the world is shifted
+			/// </summary>
+			/// <param name="offset">Position of the new origin in old world coordinates</param>
+			void shiftOrigin(const glmvec3& offset) {
+				m_ballsocket.shiftOrigin(offset);
 			}
 
 			/// <summary>
@@ -2025,8 +5608,8 @@ namespace vpe {
 			/// <param name="max_angle">Angle that the hinge should be able to rotate around in the positive direction in radians in range [0,  2*pi]</param>
 			void enableLimit(real min_angle, real max_angle) {
 				assert(min_angle < max_angle);
-				assert(min_angle <= 0.0_real);
-				assert(max_angle >= 0.0_real);
+				assert(min_angle <= (real)0.0);
+				assert(max_angle >= (real)0.0);
 
 				m_limit_min = min_angle;
 				m_limit_max = max_angle;
@@ -2050,7 +5633,7 @@ namespace vpe {
 			/// <param name="motor_speed">The angular speed in radians/sec that the motor should maintain</param>
 			/// <param name="max_force">The maximum force in newton meters that can be applied per iteration. Use this to controll ramp up time</param>
 			void enableMotor(real motor_speed, real max_force) {
-				assert(max_force > 0.0_real);
+				assert(max_force > (real)0.0);
 				m_fmotor = motor_speed;
 				m_fmotor_max = max_force;
 				m_motor_active = true;
@@ -2061,8 +5644,8 @@ namespace vpe {
 			/// </summary>
 			void disableMotor() {
 				m_motor_active = false;
-				m_fmotor = 0.0_real;
-				m_fmotor_max = 0.0_real;
+				m_fmotor = (real)0.0;
+				m_fmotor_max = (real)0.0;
 			}
 
 			/// <summary>
@@ -2071,12 +5654,12 @@ namespace vpe {
 			/// We do this to allow the entire system to tilt, i.e. for the hinge axis to also be able to rotate. Using m_rot_axis_w would lead to the system always trying to keep the same orientation which can become quite unstable
 			/// </summary>
 			/// <param name="dt">Simulation timestep</param>
-			void setUp(real dt) override {
-				m_ballsocket->setUp(dt);
+			void setUp(real dt) {
+				m_ballsocket.setUp(dt);
 
 				// Move hinge axis back to world space for each body
-				m_axis1_world = glm::normalize(m_body1->m_model * glmvec4(m_rot_axis_body1, 0.0_real));
-				m_axis2_world = glm::normalize(m_body2->m_model * glmvec4(m_rot_axis_body2, 0.0_real));
+				m_axis1_world = glm::normalize(m_body1->m_model.vector(m_rot_axis_body1));
+				m_axis2_world = glm::normalize(m_body2->m_model.vector(m_rot_axis_body2));
 
 				if (m_limit_active) {
 					glmquat current_orientation = m_body2->m_orientationLW * glm::inverse(m_body1->m_orientationLW);
@@ -2088,10 +5671,10 @@ namespace vpe {
 					glmvec3 rel_rot_axis(diff_orientation.x, diff_orientation.y, diff_orientation.z);
 					// Two quaternions q and -q encode the same rotation; take whichever one points in the same direction as the hinge axis
 					real w = diff_orientation.w;
-					if (glm::dot(rel_rot_axis, m_axis1_world) < 0.0_real) w = -w; // axes point in different directions
+					if (glm::dot(rel_rot_axis, m_axis1_world) < (real)0.0) w = -w; // axes point in different directions
 
 					// This calculates the angle in [0; 2pi] and converts it to [-pi, pi]
-					real theta = std::remainder(2.0_real * std::atan2(glm::length(rel_rot_axis), w), pi2);
+					real theta = std::remainder((real)2.0 * std::atan2(glm::length(rel_rot_axis), w), pi2);
 
 					// Our angle is now in [-pi; pi], so negative values go in one direction and positive ones in the other
 					// However, a positive rotation can also be the continuation of a negative one (since it flips over when you go lower than -pi) and vice versa
@@ -2142,14 +5725,14 @@ namespace vpe {
 				// Column major!
 				glmmat2 constraint_mass(a, c, b, d);
 				// Only invert if matrix is actually invertible
-				m_inv_constraint_mass_rot = glm::determinant(constraint_mass) < Constraint::epsilon ? glmmat2(0.0_real) : glm::inverse(constraint_mass);
+				m_inv_constraint_mass_rot = glm::determinant(constraint_mass) < Constraint::epsilon ? glmmat2((real)0.0) : glm::inverse(constraint_mass);
 			};
 
 			/// <summary>
 			/// Computes and applies constraint forces if necessary
 			/// </summary>
 			/// <param name="dt">Delta time since last frame</param>
-			void solveVelocity() override {
+			void solveVelocity() {
 				// Handle limit constraints
 				if (m_limit_active) {
 					if (m_theta < m_limit_min) {
@@ -2207,7 +5790,7 @@ namespace vpe {
 					m_body2->m_angular_velocityW += m_body2_motor_factor * m_body2_factor * m_body2->m_inertia_invW * impulse2;
 				}
 
-				m_ballsocket->solveVelocity();
+				m_ballsocket.solveVelocity();
 			
 				glmvec2 abs_offset = glm::abs(m_offset_rotation);
 		
@@ -2246,16 +5829,21 @@ namespace vpe {
 		/// If you use a body with infinite mass to fixate it, setting the anchor point to the other, non-fixed body increases stiffness
 		/// </summary>
 		class FixedJoint : public Constraint {
-			std::shared_ptr<BallSocketJoint> m_ballsocket;		// Used for the translation constraint
-			real m_bias_factor_trans = 0.2_real;				// Bias factor for translation constraint Baumgarte stabilization
-			real m_bias_factor_rot = 0.1_real;					// Bias factor for rotation constraint Baumgarte stabilization
+			using Constraint::m_body1;						// Members of the base class, which is dependent on the template parameter
+			using Constraint::m_body2;
+			using Constraint::m_body1_factor;
+			using Constraint::m_body2_factor;
+
+			BallSocketJoint m_ballsocket;		// Used for the translation constraint
+			real m_bias_factor_trans = (real)0.2;				// Bias factor for translation constraint Baumgarte stabilization
+			real m_bias_factor_rot = (real)0.1;					// Bias factor for rotation constraint Baumgarte stabilization
 
 			// This is computed when the Joint is created
 			glmquat m_init_orientation_inv;						// Initial orientation of the two bodies
 
 			// This is computed before each loop in setUp()
-			glmmat3 m_inv_constraint_mass_rot{ 0.0_real };		// Inverse effective constraint mass
-			glmvec3 m_bias_rot{ 0.0_real };						// Baumgarte bias to be used for the rotation constraint
+			glmmat3 m_inv_constraint_mass_rot{ (real)0.0 };		// Inverse effective constraint mass
+			glmvec3 m_bias_rot{ (real)0.0 };						// Baumgarte bias to be used for the rotation constraint
 		public:
 			/// <summary>
 			/// Constructor
@@ -2263,13 +5851,11 @@ namespace vpe {
 			/// <param name="body1">First body</param>
 			/// <param name="body2">Second body</param>
 			/// <param name="anchor">Anchor point in world space</param>
-			FixedJoint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2, glmvec3 anchor) : Constraint(body1, body2) {
-				m_ballsocket = std::make_shared<VPEWorld::BallSocketJoint>(m_body1, m_body2, anchor);
-				m_ballsocket->setTranslationBias(m_bias_factor_trans);
+			FixedJoint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2, glmvec3 anchor) : Constraint(body1, body2), m_ballsocket{ body1, body2, anchor } {
+				m_ballsocket.setTranslationBias(m_bias_factor_trans);
 				// Compute inverse of initial orientation between the bodies
 				m_init_orientation_inv = glm::inverse(m_body2->m_orientationLW) * m_body1->m_orientationLW;
 			}
-			~FixedJoint() {}
 
 			/// <summary>
 			/// Use to change the Baumgarte stabilization bias factor for the translation constraint
@@ -2277,7 +5863,15 @@ namespace vpe {
 			/// <param name="new_bias"></param>
 			void setTranslationBias(real new_bias) {
 				m_bias_factor_trans = new_bias;
-				m_ballsocket->setTranslationBias(m_bias_factor_trans);
+				m_ballsocket.setTranslationBias(m_bias_factor_trans);
+			}
+
+			/// <summary>
+			/// Move the anchor of the translation constraint if the origin of the world is shifted
+			/// </summary>
+			/// <param name="offset">Position of the new origin in old world coordinates</param>
+			void shiftOrigin(const glmvec3& offset) {
+				m_ballsocket.shiftOrigin(offset);
 			}
 
 			/// <summary>
@@ -2293,19 +5887,19 @@ namespace vpe {
 			/// </summary>
 			/// <param name="dt">Simulation timestep</param>
 			void setUp(real dt) {
-				m_ballsocket->setUp(dt);
+				m_ballsocket.setUp(dt);
 
 				// Compute constraint mass and invert it if possible
 				glmmat3 constraint_mass = m_body1->m_inertia_invW + m_body2->m_inertia_invW;
-				m_inv_constraint_mass_rot = glm::determinant(constraint_mass) < Constraint::epsilon ? glmmat3(0.0_real) : glm::inverse(constraint_mass);
+				m_inv_constraint_mass_rot = glm::determinant(constraint_mass) < Constraint::epsilon ? glmmat3((real)0.0) : glm::inverse(constraint_mass);
 
 				// Compute constraint error (relative rotation) and Baumgarte bias
 				glmquat offset = m_body2->m_orientationLW * m_init_orientation_inv * glm::inverse(m_body1->m_orientationLW);
-				m_bias_rot = (m_bias_factor_rot / dt) * 2.0_real * glmvec3(offset.x, offset.y, offset.z);
+				m_bias_rot = (m_bias_factor_rot / dt) * (real)2.0 * glmvec3(offset.x, offset.y, offset.z);
 			}
 
 			void solveVelocity() {
-				m_ballsocket->solveVelocity();
+				m_ballsocket.solveVelocity();
 
 				// Compute product of 3x12 Jacobian and 12x1 velocity vector
 				// Since the Jacobian is (0 -I 0 I) (I being the 3x3 identity matrix), this is pretty simple here
@@ -2327,63 +5921,68 @@ namespace vpe {
 		/// If you use a body with infinite mass to fixate it, setting the anchor point to the other, non-fixed body increases stiffness
 		/// </summary>
 		class SliderJoint : public Constraint {
-			real m_bias_factor_trans = 0.2_real;				// Bias factor for translation constraint Baumgarte stabilization
-			real m_bias_factor_rot = 0.2_real;					// Bias factor for rotation constraint Baumgarte stabilization
-			real m_bias_factor_limit = 0.1_real;				// Bias factor for limit constraint Baumgarte stabilization
+			using Constraint::m_body1;						// Members of the base class, which is dependent on the template parameter
+			using Constraint::m_body2;
+			using Constraint::m_body1_factor;
+			using Constraint::m_body2_factor;
+
+			real m_bias_factor_trans = (real)0.2;				// Bias factor for translation constraint Baumgarte stabilization
+			real m_bias_factor_rot = (real)0.2;					// Bias factor for rotation constraint Baumgarte stabilization
+			real m_bias_factor_limit = (real)0.1;				// Bias factor for limit constraint Baumgarte stabilization
 
 			bool m_limit_active = false;						// Whether the constraint should limit the min and max relative distance between the bodies
 			real m_limit_min = -std::numeric_limits<real>::max(); // The lower limit for relative distance, i.e. distance limit in negative direction
 			real m_limit_max = std::numeric_limits<real>::max();  // The upper limit for relative distance, i.e. distance limit in positive direction
 
 			bool m_motor_active = false;						// Whether the motor should be active
-			real m_fmotor = 0.0_real;							// Linear motor speed in m/s
-			real m_fmotor_max = 0.0_real;						// Max motor force applied per timestep in Newton
+			real m_fmotor = (real)0.0;							// Linear motor speed in m/s
+			real m_fmotor_max = (real)0.0;						// Max motor force applied per timestep in Newton
 			bool m_body1_motor_factor = true;					// Whether body1 should be affected by motor forces
 			bool m_body2_motor_factor = true;					// Whether body2 should be affected by motor forces
 
 			// This is computed when the Joint is created
-			glmvec3 m_anchor_world{ 0.0_real };
+			glmvec3 m_anchor_world{ (real)0.0 };
 			glmvec3 m_anchor_body1;								// Anchor point in local space of body1
 			glmvec3 m_anchor_body2;								// Anchor point in local space of body2
-			glmvec3 m_axis_world{ 0.0_real };					// Translation axis in world space
-			glmvec3 m_axis_body1{ 0.0_real };					// Axis in local space of body 1
+			glmvec3 m_axis_world{ (real)0.0 };					// Translation axis in world space
+			glmvec3 m_axis_body1{ (real)0.0 };					// Axis in local space of body 1
 			glmquat m_init_orientation_inv;						// Initial orientation of the two bodies
 
 			// The following values are computed before each loop in setUp()
 			// Translation constraint
-			glmmat2 m_inv_constraint_mass_trans{ 0.0_real };	// Inverse effective constraint mass for translation constraint
-			glmvec2 m_bias_trans{ 0.0_real };					// Baumgarte bias to be used for the translation constraint
-			glmvec3 m_r1{ 0.0_real };							// vector from body1's center to body1's anchor in world space
-			glmvec3 m_r2{ 0.0_real };							// vector from body2's center to body2's anchor in world space
-			glmvec3 m_axis_body1_w{ 0.0_real };					// Translation axis of body1 moved to world space
-			glmvec3 m_anchor_diff{ 0.0_real };					// Relative position difference of the two bodies' anchor points
+			glmmat2 m_inv_constraint_mass_trans{ (real)0.0 };	// Inverse effective constraint mass for translation constraint
+			glmvec2 m_bias_trans{ (real)0.0 };					// Baumgarte bias to be used for the translation constraint
+			glmvec3 m_r1{ (real)0.0 };							// vector from body1's center to body1's anchor in world space
+			glmvec3 m_r2{ (real)0.0 };							// vector from body2's center to body2's anchor in world space
+			glmvec3 m_axis_body1_w{ (real)0.0 };					// Translation axis of body1 moved to world space
+			glmvec3 m_anchor_diff{ (real)0.0 };					// Relative position difference of the two bodies' anchor points
 
 			// Entries for the translation constraint Jacobian
-			glmvec3 m_j11{ 0.0_real };
-			glmvec3 m_j12{ 0.0_real };
-			glmvec3 m_j13{ 0.0_real };
-			glmvec3 m_j14{ 0.0_real };
-			glmvec3 m_j21{ 0.0_real };
-			glmvec3 m_j22{ 0.0_real };
-			glmvec3 m_j23{ 0.0_real };
-			glmvec3 m_j24{ 0.0_real };
+			glmvec3 m_j11{ (real)0.0 };
+			glmvec3 m_j12{ (real)0.0 };
+			glmvec3 m_j13{ (real)0.0 };
+			glmvec3 m_j14{ (real)0.0 };
+			glmvec3 m_j21{ (real)0.0 };
+			glmvec3 m_j22{ (real)0.0 };
+			glmvec3 m_j23{ (real)0.0 };
+			glmvec3 m_j24{ (real)0.0 };
 
 			// Rotation Constraint
-			glmmat3 m_inv_constraint_mass_rot{ 0.0_real };		// Inverse effective constraint mass for the rotaion constraint
-			glmvec3 m_bias_rot{ 0.0_real };						// Baumgarte bias to be used for the rotation constraint
+			glmmat3 m_inv_constraint_mass_rot{ (real)0.0 };		// Inverse effective constraint mass for the rotaion constraint
+			glmvec3 m_bias_rot{ (real)0.0 };						// Baumgarte bias to be used for the rotation constraint
 
 			// Limit Constraint
-			real m_inv_constraint_mass_limit = 0.0_real;		// Inverse effective constraint mass for the limit constraint
-			real m_bias_limit_min = 0.0_real;					// The Baumgarte bias value for the minimum limit constraint
-			real m_bias_limit_max = 0.0_real;					// The Baumgarte bias value for the maximum limit constraint
-			real m_current_distance = 0.0_real;					// The current distance between the bodies
+			real m_inv_constraint_mass_limit = (real)0.0;		// Inverse effective constraint mass for the limit constraint
+			real m_bias_limit_min = (real)0.0;					// The Baumgarte bias value for the minimum limit constraint
+			real m_bias_limit_max = (real)0.0;					// The Baumgarte bias value for the maximum limit constraint
+			real m_current_distance = (real)0.0;					// The current distance between the bodies
 			// Used for jacobian entries for limit constraint
-			glmvec3 m_r1_anchor_axis{ 0.0_real };
-			glmvec3 m_r2_axis{ 0.0_real };
+			glmvec3 m_r1_anchor_axis{ (real)0.0 };
+			glmvec3 m_r2_axis{ (real)0.0 };
 
 			// Motor constraint
-			real m_inv_constraint_mass_motor = 0.0_real;		// Inverse effective constraint mass for the motor
-			real m_offset_motor = 0.0_real;						// Constraint error for the motor
+			real m_inv_constraint_mass_motor = (real)0.0;		// Inverse effective constraint mass for the motor
+			real m_offset_motor = (real)0.0;						// Constraint error for the motor
 
 		public:
 			/// <summary>
@@ -2395,13 +5994,12 @@ namespace vpe {
 			/// <param name="anchor">Translation axis in world space</param>
 			SliderJoint(std::shared_ptr<Body> body1, std::shared_ptr<Body> body2, glmvec3 anchor, glmvec3 axis) : Constraint(body1, body2), m_anchor_world{ anchor }, m_axis_world{ glm::normalize(axis) } {
 				// Move anchor point into local space for each body
-				m_anchor_body1 = m_body1->m_model_inv * glmvec4(m_anchor_world, 1.0_real);
-				m_anchor_body2 = m_body2->m_model_inv * glmvec4(m_anchor_world, 1.0_real);
-				m_axis_body1 = glm::normalize(m_body1->m_model_inv * glmvec4(m_axis_world, 0.0_real));
+				m_anchor_body1 = m_body1->m_model_inv.point(m_anchor_world);
+				m_anchor_body2 = m_body2->m_model_inv.point(m_anchor_world);
+				m_axis_body1 = glm::normalize(m_body1->m_model_inv.vector(m_axis_world));
 				// Compute current (inverse) orientation between the bodies
 				m_init_orientation_inv = glm::inverse(m_body2->m_orientationLW) * m_body1->m_orientationLW;
 			}
-			~SliderJoint() {}
 
 			/// <summary>
 			/// Use to change the Baumgarte stabilization bias factor for the translation constraint
@@ -2411,6 +6009,14 @@ namespace vpe {
 				m_bias_factor_trans = new_bias;
 			}
 
+			/// <summary>
+			/// Move the world space anchor if the origin of the world is shifted
+			/// </summary>
+			/// <param name="offset">Position of the new origin in old world coordinates</param>
+			void shiftOrigin(const glmvec3& offset) {
+				m_anchor_world -= offset;
+			}
+
 			/// <summary>
 			/// Use to change the Baumgarte stabilization bias factor for the rotation constraint
 			/// </summary>
@@ -2436,8 +6042,8 @@ namespace vpe {
 			/// <param name="max_distance">Maximum relative distance between the bodies, i.e. how far can they translate in the positive direction; in range [0; inf]</param>
 			void enableLimit(real min_distance, real max_distance) {
 				assert(min_distance < max_distance);
-				assert(min_distance <= 0.0_real);
-				assert(max_distance >= 0.0_real);
+				assert(min_distance <= (real)0.0);
+				assert(max_distance >= (real)0.0);
 
 				m_limit_min = min_distance;
 				m_limit_max = max_distance;
@@ -2473,7 +6079,7 @@ namespace vpe {
 			/// <param name="motor_speed">The linear motor speed in m/s</param>
 			/// <param name="max_force">The maximum force in Newton that can be applied per iteration step. Use this to controll ramp up time</param>
 			void enableMotor(real motor_speed, real max_force) {
-				assert(max_force > 0.0_real);
+				assert(max_force > (real)0.0);
 				m_fmotor = motor_speed;
 				m_fmotor_max = max_force;
 				m_motor_active = true;
@@ -2484,8 +6090,8 @@ namespace vpe {
 			/// </summary>
 			void disableMotor() {
 				m_motor_active = false;
-				m_fmotor = 0.0_real;
-				m_fmotor_max = 0.0_real;
+				m_fmotor = (real)0.0;
+				m_fmotor_max = (real)0.0;
 			}
 
 			/// <summary>
@@ -2496,14 +6102,14 @@ namespace vpe {
 			void setUp(real dt) {
 				// Translation Constraint
 				// Move body1's axis back to world space
-				m_axis_body1_w = glm::normalize(m_body1->m_model * glmvec4(m_axis_body1, 0.0_real));
+				m_axis_body1_w = glm::normalize(m_body1->m_model.vector(m_axis_body1));
 				// Compute two orthogonal unit vectors to the axis to use for the Jacobian and mass matrices
 				glmvec3 n1 = geometry::orthoUnitVector(m_axis_body1_w);
 				glmvec3 n2 = glm::normalize(glm::cross(m_axis_body1_w, n1));
 
 				// Move anchor points back to world space for each body
-				glmvec3 anchor1 = m_body1->m_model * glmvec4(m_anchor_body1, 1.0_real);
-				glmvec3 anchor2 = m_body2->m_model * glmvec4(m_anchor_body2, 1.0_real);
+				glmvec3 anchor1 = m_body1->m_model.point(m_anchor_body1);
+				glmvec3 anchor2 = m_body2->m_model.point(m_anchor_body2);
 
 				// compute vector from body center to bodies' anchor in world space
 				m_r1 = anchor1 - m_body1->m_positionW;
@@ -2538,16 +6144,16 @@ namespace vpe {
 				// Column major!
 				glmmat2 constraint_mass_trans(a, c, b, d);
 				// Only invert if matrix is actually invertible
-				m_inv_constraint_mass_trans = glm::determinant(constraint_mass_trans) < Constraint::epsilon ? glmmat2(0.0_real) : glm::inverse(constraint_mass_trans);
+				m_inv_constraint_mass_trans = glm::determinant(constraint_mass_trans) < Constraint::epsilon ? glmmat2((real)0.0) : glm::inverse(constraint_mass_trans);
 
 				// Rotation Constraint
 				// Compute constraint mass and invert it if possible
 				glmmat3 constraint_mass_rot = m_body1->m_inertia_invW + m_body2->m_inertia_invW;
-				m_inv_constraint_mass_rot = glm::determinant(constraint_mass_rot) < Constraint::epsilon ? glmmat3(0.0_real) : glm::inverse(constraint_mass_rot);
+				m_inv_constraint_mass_rot = glm::determinant(constraint_mass_rot) < Constraint::epsilon ? glmmat3((real)0.0) : glm::inverse(constraint_mass_rot);
 
 				// Compute constraint error (relative rotation) and Baumgarte bias
 				glmquat offset = m_body2->m_orientationLW * m_init_orientation_inv * glm::inverse(m_body1->m_orientationLW);
-				m_bias_rot = (m_bias_factor_rot / dt) * 2.0_real * glmvec3(offset.x, offset.y, offset.z);
+				m_bias_rot = (m_bias_factor_rot / dt) * (real)2.0 * glmvec3(offset.x, offset.y, offset.z);
 
 				// Limit constraint
 				if (m_limit_active) {
@@ -2555,7 +6161,7 @@ namespace vpe {
 					m_r2_axis = glm::cross(m_r2, m_axis_body1_w);
 
 					real limit_mass = m_body1->m_mass_inv + m_body2->m_mass_inv + glm::dot(m_r1_anchor_axis, m_body1->m_inertia_invW * m_r1_anchor_axis) + glm::dot(m_r2_axis, m_body2->m_inertia_invW * m_r2_axis);
-					m_inv_constraint_mass_limit = limit_mass < Constraint::epsilon ? 0.0_real : 1.0_real / limit_mass;
+					m_inv_constraint_mass_limit = limit_mass < Constraint::epsilon ? (real)0.0 : (real)1.0 / limit_mass;
 
 					m_current_distance = glm::dot(m_anchor_diff, m_axis_body1_w);
 					m_bias_limit_min = (m_bias_factor_limit / dt) * (m_current_distance - m_limit_min);
@@ -2616,7 +6222,7 @@ namespace vpe {
 
 				// Handle motor constraint
 				if (m_motor_active) {
-					if (std::abs(m_offset_motor) > 0.0_real) {
+					if (std::abs(m_offset_motor) > (real)0.0) {
 						// Missing compontents of Jacobian matrix are 0
 						glmvec3 j1 = m_axis_body1_w;
 						glmvec3 j3 = -m_axis_body1_w;
@@ -2677,10 +6283,17 @@ namespace vpe {
 			}
 		};
 
+		using constraint_arrays_t = std::tuple<ConstraintArray<DistanceConstraint>, ConstraintArray<BallSocketJoint>, ConstraintArray<HingeJoint>, ConstraintArray<FixedJoint>, ConstraintArray<SliderJoint>>;
+		constraint_arrays_t m_constraints{ m_memory_resource, m_memory_resource, m_memory_resource, m_memory_resource, m_memory_resource };	//all constraints, an array for each type
+
 	public:
 		
-		VPEWorld() {};				///Constructor of class VPEWorld
-		virtual ~VPEWorld() {};		///Destructor of class VPEWorld
+		/// <summary>
+		/// Constructor of class BasicVPEWorld.
+		/// </summary>
+		/// <param name="resource">Upstream memory resource for the pools and all other memory of the world.</param>
+		BasicVPEWorld(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : m_memory_resource{ resource } {};
+		virtual ~BasicVPEWorld() {};		///Destructor of class BasicVPEWorld
 
 	//--------------------------------Begin-Cloth-Simulation-Stuff----------------------------------
 	// by Felix Neumann
@@ -2696,13 +6309,13 @@ namespace vpe {
 		/// back an owner if the cloth moves. With this key, the body can also be found.
 		/// So best if there is a 1:1 correspondence. E.g., the owner can be a specific VESceneNode.
 		/// </summary>
-		std::unordered_map<void*, std::shared_ptr<VPEWorld::Cloth>> m_cloths;
+		std::unordered_map<void*, std::shared_ptr<Cloth>> m_cloths;
 
 		/// <summary>
 		/// Add a new cloth to the physics world.
 		/// </summary>
 		/// <param name="pbody"> The new body.</param>
-		void addCloth(std::shared_ptr<VPEWorld::Cloth> pCloth) {
+		void addCloth(std::shared_ptr<Cloth> pCloth) {
 			m_cloths.insert({ pCloth->m_owner, pCloth });
 		}
 
@@ -2776,11 +6389,11 @@ namespace vpe {
 			bool isFixed;																			// true ... transformations are fully applied, false ... point is dragged along by the simulation
 
 		private:
-			const real c_small = 0.01_real;															// Small threshold value
-			const real c_verySmall = c_small / 50.0_real;											// Even smaller threshold value
-			const real c_collisionMargin = 0.045_real;												// Margin for collision detection with polytopes to avoid glitches
-			const real c_friction = 300._real;														// Amount of friction when colliding with polytopes or the ground
-			const real c_damping = 0.1_real;														// Amount of damping
+			const real c_small = (real)0.01;															// Small threshold value
+			const real c_verySmall = c_small / (real)50.0;											// Even smaller threshold value
+			const real c_collisionMargin = (real)0.045;												// Margin for collision detection with polytopes to avoid glitches
+			const real c_friction = (real)300.;														// Amount of friction when colliding with polytopes or the ground
+			const real c_damping = (real)0.1;														// Amount of damping
 
 		public:
 			/// <summary>
@@ -2788,8 +6401,8 @@ namespace vpe {
 			/// </summary>
 			/// <param name="pos"> Initial position of the mass point. </param>
 			/// <param name="isFixed"> Whether the point is fixed. </param>
-			ClothMassPoint(glm::vec3 pos, bool isFixed = false) : pos{ pos }, prevPos{ pos },
-				initialPos{ pos }, vel{ glmvec3(0._real) }, isFixed{ isFixed }, invMass{ 0 } {}
+			ClothMassPoint(glmvec3 pos, bool isFixed = false) : pos{ pos }, prevPos{ pos },
+				initialPos{ pos }, vel{ glmvec3((real)0.) }, isFixed{ isFixed }, invMass{ 0 } {}
 
 			/// <summary>
 			/// Apply some external force like gravity or wind.
@@ -2810,11 +6423,12 @@ namespace vpe {
 			/// Pushes the mass point slightly above the ground if it was below.
 			/// </summary>
 			/// <param name="dt"> Delta time. </param>
-			void resolveGroundCollision(real dt)
+			/// <param name="groundHeight"> Height of the ground plane. </param>
+			void resolveGroundCollision(real dt, real groundHeight = 0)
 			{
-				if (pos.y < 0)
+				if (pos.y < groundHeight)
 				{
-					pos.y = 0 + c_small;
+					pos.y = groundHeight + c_small;
 					vel.y = 0;
 					vel -= vel * c_friction * dt;
 				}
@@ -2827,14 +6441,26 @@ namespace vpe {
 			/// <param name="dt"> Delta time. Only affects how much friction is applied in case
 			/// of a collision. Can be 0 to apply no friction. </param>
 			void resolvePolytopeCollisions(const std::vector<std::shared_ptr<Body>>& bodies,
-				real dt = 0._real)
+				real dt = (real)0.)
 			{
 				if (isFixed)																		// Fixed point can go through bodies so that the cloth is always where you expect it to be.
 					return;																			// For example attached as a cape to an avatar.
 
 				for (auto body : bodies)
 				{
-					glmvec3 massPointLocalPos = body->m_model_inv * glmvec4(pos, 1);				// Transform the mass point's position into the body's local space
+					if (!body->m_parts.empty())														// Compounds are handled part by part
+					{
+						resolvePolytopeCollisions(body->m_parts, dt);
+						continue;
+					}
+
+					if (!body->m_polytope)															// Spheres and capsules are handled in world space
+					{
+						resolveRoundCollision(body, dt);
+						continue;
+					}
+
+					glmvec3 massPointLocalPos = body->m_model_inv.point(pos);				// Transform the mass point's position into the body's local space
 
 					if (glm::length(massPointLocalPos) < body->boundingSphereRadius())				// Check if the mass point is within the body's bounding sphere	
 						resolvePolytopeCollision(body, massPointLocalPos, dt);						// Resolve possible collision
@@ -2849,7 +6475,7 @@ namespace vpe {
 			void damp(real dt)
 			{
 				if (vel.x + vel.y + vel.z > c_verySmall)
-					vel -= vel * c_damping * std::min(dt, 1._real);
+					vel -= vel * c_damping * std::min(dt, (real)1.);
 			}
 
 		private:
@@ -2881,7 +6507,30 @@ namespace vpe {
 				}
 				// Possible simulation improvement: don't correct straight towards the face 
 				prevPos = pos;																		// but a bit towards the general movement of the cloth
-				pos = body->m_model * (glmvec4(nearestProjectionPoint.first, 1));					// Set the mass point's position which was inside the polytope to the projection point
+				pos = body->m_model.point(nearestProjectionPoint.first);					// Set the mass point's position which was inside the polytope to the projection point
+				vel -= vel * c_friction * dt;														// Apply friction
+			}
+
+			/// <summary>
+			/// Check if the mass point is within a sphere or capsule and push it to the nearest
+			/// point outside if so.
+			/// </summary>
+			/// <param name="body"> Body that might collide. </param>
+			/// <param name="dt"> Delta time. Only affects how much friction is applied in case
+			/// of a collision. Can be 0 to apply no friction. </param>
+			void resolveRoundCollision(const std::shared_ptr<Body> body, real dt)
+			{
+				auto core = body->roundCore(body->m_model);
+				glmvec3 closest = closestPointSegment(pos, core.m_aW, core.m_bW);					// Closest point on the segment of the shape
+				glmvec3 diff = pos - closest;
+				real dist = glm::length(diff);
+				real radius = core.m_radius + c_collisionMargin;									// Extra margin so that cloth is in front of the shape
+
+				if (dist >= radius || dist < c_verySmall)											// Outside, or exactly on the segment with no direction to push
+					return;
+
+				prevPos = pos;
+				pos = closest + diff * (radius / dist);												// Push the mass point onto the surface
 				vel -= vel * c_friction * dt;														// Apply friction
 			}
 		};
@@ -2898,7 +6547,7 @@ namespace vpe {
 			ClothMassPoint* point1;
 			real length;																			// The inital legnth between the points
 			real compliance;																		// The inverse of stiffness. So if compliance is 0, the cloth is infinitely stiff
-			const real c_threshold = 0.0001_real;													// Points are only modified if the length difference is greater tthan this
+			const real c_threshold = (real)0.0001;													// Points are only modified if the length difference is greater tthan this
 
 			/// <summary>
 			/// Constructor that calculates the length of the constraint and sets the compliance.
@@ -2981,7 +6630,7 @@ namespace vpe {
 			callback_erase_cloth m_on_erase;						// Called if the cloth is erased
 
 		private:
-			VPEWorld* m_physics;									// Pointer to the physics world to access parameters
+			BasicVPEWorld* m_physics;								// Pointer to the physics world to access parameters
 			std::vector<ClothMassPoint> m_massPoints{};				// All mass points of the cloth
 			std::vector<ClothConstraint> m_constraints{};			// All constraints (bending and stretching) of the cloth
 			std::vector<glmvec3> m_vertices;						// The vertices of the mesh that was used to create the cloth
@@ -3017,7 +6666,7 @@ namespace vpe {
 			/// (higher = less stretchy). </param>
 			/// <param name="movementSimulation"> How much mass points not fixed should be moved by
 			/// transformation (0 to 1). </param>
-			Cloth(VPEWorld* physics, std::string name, void* owner, callback_move_cloth on_move,
+			Cloth(BasicVPEWorld* physics, std::string name, void* owner, callback_move_cloth on_move,
 				callback_erase_cloth on_erase, std::vector<glmvec3> vertices,
 				std::vector<uint32_t> indices, std::vector<glmvec3> fixedPointsPositions,
 				real bendingCompliance = 1, int substeps = 4, real movementSimulation = 0.8)
@@ -3030,7 +6679,7 @@ namespace vpe {
 				generateConstraints(createTriangles(indices), bendingCompliance);
 				calcMaxMassPointDistance();
 				applyTransformation(glm::rotate(													// Apply a slight rotation to give the sim a degree of freedom for all three dimensions
-					glm::mat4(1.0f), glm::radians(0.1f), glm::vec3(0.0f, 1.0f, 0.0f)), true);
+					glmmat4((real)1.0), glm::radians((real)0.1), glmvec3((real)0.0, (real)1.0, (real)0.0)), true);
 			}
 
 			/// <summary>
@@ -3063,9 +6712,9 @@ namespace vpe {
 						for (ClothMassPoint& massPoint : m_massPoints)								// iterate over each mass point
 							massPoint.resolvePolytopeCollisions(m_bodiesNearby, rDt);				// and do collision checks and resolve them if there are any
 
-					if (m_massPoints[0].pos.y < m_maxMassPointDistance)								// If the ground is near
+					if (m_massPoints[0].pos.y - m_physics->m_ground_height < m_maxMassPointDistance)	// If the ground is near
 						for (ClothMassPoint& massPoint : m_massPoints)								// iterate over each mass point
-							massPoint.resolveGroundCollision(rDt);									// and do a collision check and resolve it if there is one
+							massPoint.resolveGroundCollision(rDt, m_physics->m_ground_height);		// and do a collision check and resolve it if there is one
 				}
 			}
 
@@ -3116,6 +6765,20 @@ namespace vpe {
 				}
 			}
 
+			/// <summary>
+			/// Move all mass points if the origin of the world is shifted. The initial positions are
+			/// left untouched, since they are relative to the transformation given to setTransformation.
+			/// </summary>
+			/// <param name="offset"> Position of the new origin in old world coordinates. </param>
+			void shiftOrigin(glmvec3 offset)
+			{
+				for (ClothMassPoint& massPoint : m_massPoints)
+				{
+					massPoint.pos -= offset;
+					massPoint.prevPos -= offset;
+				}
+			}
+
 			/// <summary>
 			/// Apply a transformation to the initial position of the cloth.
 			/// </summary>
@@ -3178,7 +6841,7 @@ namespace vpe {
 				while (it != m_bodiesNearby.end())													// additional check if the bodies are near enough to collide; This is cheaper than
 				{																					// iterating through all mass points for a body that can't collide anyway														
 					glmvec3 clothLocalPos =
-						(*it)->m_model_inv * glmvec4(m_massPoints[0].pos, 1);						// Tranform position of cloth into bodies local space
+						(*it)->m_model_inv.point(m_massPoints[0].pos);						// Tranform position of cloth into bodies local space
 
 					if (glm::length(clothLocalPos) > ((*it)->boundingSphereRadius() +				// Remove nearby body if it cannot touch cloth
 						m_maxMassPointDistance) * 2)
@@ -3221,7 +6884,7 @@ namespace vpe {
 					{
 						alreadyAddedPositions[vertexPos] = (int) m_massPoints.size();
 
-						glm::vec3 vertexPosGlm = { vertexPos[0], vertexPos[1], vertexPos[2] };		// Convert from std::vector back to glm::vec3
+						glmvec3 vertexPosGlm = { vertexPos[0], vertexPos[1], vertexPos[2] };		// Convert from std::vector back to glm::vec3
 
 						ClothMassPoint massPoint(vertexPosGlm);
 
@@ -3392,6 +7055,8 @@ namespace vpe {
 
 	};
 
+	using VPEWorld = BasicVPEWorld<real>;	//The default world, its accuracy is chosen by VPE_SINGLE_ACCURACY or VPE_DOUBLE_ACCURACY
+
 };
 
 //-------------------------------------------------------------------------------------------------------
@@ -3401,7 +7066,8 @@ namespace geometry {
 
 
 	//https://box2d.org/posts/2014/02/computing-a-basis/
-	inline void computeBasis(const glmvec3& a, glmvec3& b, glmvec3& c)
+	template<typename T>
+	inline void computeBasis(const glm::vec<3, T>& a, glm::vec<3, T>& b, glm::vec<3, T>& c)
 	{
 		// Suppose vector a has all equal components and is a unit vector:
 		// a = (s, s, s)
@@ -3410,9 +7076,9 @@ namespace geometry {
 		// to 0.57735.
 
 		if (fabs(a.x) >= 0.57735)
-			b = glmvec3(a.y, -a.x, 0.0);
+			b = glm::vec<3, T>(a.y, -a.x, 0.0);
 		else
-			b = glmvec3(0.0, a.z, -a.y);
+			b = glm::vec<3, T>(0.0, a.z, -a.y);
 
 		b = glm::normalize(b);
 		c = glm::cross(a, b);
@@ -3425,34 +7091,46 @@ namespace geometry {
 	using namespace std;
 
 	// check if a point is on the RIGHT side of an edge
-	inline bool inside(glmvec2 p, glmvec2 p1, glmvec2 p2) {
+	template<typename T>
+	inline bool inside(glm::vec<2, T> p, glm::vec<2, T> p1, glm::vec<2, T> p2) {
 		return (p2.y - p1.y) * p.x + (p1.x - p2.x) * p.y + (p2.x * p1.y - p1.x * p2.y) >= 0;
 	}
 
 	// calculate intersection point
-	inline glmvec2 intersection(glmvec2 cp1, glmvec2 cp2, glmvec2 s, glmvec2 e) {
-		glmvec2 dc = { cp1.x - cp2.x, cp1.y - cp2.y };
-		glmvec2 dp = { s.x - e.x, s.y - e.y };
+	template<typename T>
+	inline glm::vec<2, T> intersection(glm::vec<2, T> cp1, glm::vec<2, T> cp2, glm::vec<2, T> s, glm::vec<2, T> e) {
+		glm::vec<2, T> dc = { cp1.x - cp2.x, cp1.y - cp2.y };
+		glm::vec<2, T> dp = { s.x - e.x, s.y - e.y };
 
-		real n1 = cp1.x * cp2.y - cp1.y * cp2.x;
-		real n2 = s.x * e.y - s.y * e.x;
-		real n3 = 1.0_real / (dc.x * dp.y - dc.y * dp.x);
+		T n1 = cp1.x * cp2.y - cp1.y * cp2.x;
+		T n2 = s.x * e.y - s.y * e.x;
+		T n3 = (T)1.0 / (dc.x * dp.y - dc.y * dp.x);
 
 		return { (n1 * dp.x - n2 * dc.x) * n3, (n1 * dp.y - n2 * dc.y) * n3 };
 	}
 
 	// Sutherland-Hodgman clipping
 	//https://rosettacode.org/wiki/Sutherland-Hodgman_polygon_clipping#C.2B.2B
-	inline void SutherlandHodgman(auto& subjectPolygon, auto& clipPolygon, auto& newPolygon) {
-		glmvec2 cp1, cp2, s, e;
-		std::vector<glmvec2> inputPolygon;
+	//also returns the feature of each point of the new polygon
+	inline void SutherlandHodgman(auto& subjectPolygon, auto& clipPolygon, auto& newPolygon, std::vector<clip_feature_t>& newFeatures) {
+		using vec2_t = std::remove_cvref_t<decltype(subjectPolygon[0])>;	//2D vector type of the polygons
+		vec2_t cp1, cp2, s, e;
+		std::vector<vec2_t> inputPolygon;
+		std::vector<clip_feature_t> inputFeatures;
 		newPolygon = subjectPolygon;
+		newFeatures.clear();
+		for (uint16_t i = 0; i < subjectPolygon.size(); ++i) {
+			newFeatures.push_back({ (uint16_t)((i + subjectPolygon.size() - 1) % subjectPolygon.size()), i });
+		}
 
 		for (int j = 0; j < clipPolygon.size(); j++)
 		{
 			// copy new polygon to input polygon & set counter to 0
 			inputPolygon = newPolygon;
+			inputFeatures = newFeatures;
 			newPolygon.clear();
+			newFeatures.clear();
+			uint16_t clip_edge = c_clip_edge + (uint16_t)j;
 
 			// get clipping polygon edge
 			cp1 = clipPolygon[j];
@@ -3463,11 +7141,14 @@ namespace geometry {
 				// get subject polygon edge
 				s = inputPolygon[i];
 				e = inputPolygon[(i + 1) % inputPolygon.size()];
+				auto& fs = inputFeatures[i];
+				auto& fe = inputFeatures[(i + 1) % inputPolygon.size()];
 
 				// Case 1: Both vertices are inside:
 				// Only the second vertex is added to the output list
 				if (inside(s, cp1, cp2) && inside(e, cp1, cp2)) {
 					newPolygon.emplace_back(e);
+					newFeatures.push_back(fe);
 				}
 
 				// Case 2: First vertex is outside while second one is inside:
@@ -3475,7 +7156,9 @@ namespace geometry {
 				// and the second vertex are added to the output list
 				else if (!inside(s, cp1, cp2) && inside(e, cp1, cp2)) {
 					newPolygon.emplace_back(intersection(cp1, cp2, s, e));
+					newFeatures.push_back({ clip_edge, fs.m_out });	//enter along the clip edge, leave along the subject edge
 					newPolygon.emplace_back(e);
+					newFeatures.push_back(fe);
 				}
 
 				// Case 3: First vertex is inside while second one is outside:
@@ -3483,6 +7166,7 @@ namespace geometry {
 				// is added to the output list
 				else if (inside(s, cp1, cp2) && !inside(e, cp1, cp2)) {
 					newPolygon.emplace_back(intersection(cp1, cp2, s, e));
+					newFeatures.push_back({ fs.m_out, clip_edge });	//enter along the subject edge, leave along the clip edge
 				}
 				// Case 4: Both vertices are outside
 				else if (!inside(s, cp1, cp2) && !inside(e, cp1, cp2)) {
@@ -3495,13 +7179,14 @@ namespace geometry {
 	/// <summary>
 	/// Returns a unit vector that is orthogonal to vec
 	/// </summary>
-	inline glmvec3 orthoUnitVector(const glmvec3& vec) {
-		assert(glm::length(vec) > c_eps);
-		glmvec3 vec_abs = glm::abs(vec);
+	template<typename T>
+	inline glm::vec<3, T> orthoUnitVector(const glm::vec<3, T>& vec) {
+		assert(glm::length(vec) > (T)c_eps);
+		glm::vec<3, T> vec_abs = glm::abs(vec);
 		int min_index = vec_abs.x < vec_abs.y ? (vec_abs.x < vec_abs.z ? 0 : 2) : (vec_abs.y < vec_abs.z ? 1 : 2);
 
-		intpair_t indices(min_index == 0 ? intpair_t{1, 2} : (min_index == 1 ? intpair_t{0, 2} : std::pair<int, int>{ 0, 1 }));
-		glmvec3 ortho(0.0_real);
+		intpair_t indices(min_index == 0 ? intpair_t{1, 2} : (min_index == 1 ? intpair_t{0, 2} : intpair_t{ 0, 1 }));
+		glm::vec<3, T> ortho((T)0.0);
 		ortho[indices.first] = -vec[indices.second];
 		ortho[indices.second] = vec[indices.first];
 
@@ -3516,14 +7201,15 @@ namespace geometry {
 	/// 2d vector).
 	/// https://en.wikipedia.org/wiki/Alpha_max_plus_beta_min_algorithm
 	/// </summary>
-	inline real alphaMaxPlusBetaMin(real a, real b)
+	template<typename T>
+	inline T alphaMaxPlusBetaMin(T a, T b)
 	{
-		real absA = fabs(a);
-		real absB = fabs(b);
+		T absA = fabs(a);
+		T absB = fabs(b);
 		if (absA > absB)
-			return (real)(0.96043387010342 * absA + 0.397824734759316 * absB);
+			return (T)(0.96043387010342 * absA + 0.397824734759316 * absB);
 
-		return (real)(0.96043387010342 * absB + 0.397824734759316 * absA);
+		return (T)(0.96043387010342 * absB + 0.397824734759316 * absA);
 	}
 
 	/// <summary>
@@ -3531,17 +7217,18 @@ namespace geometry {
 	/// https://math.stackexchange.com/questions/1282435/
 	/// https://stackoverflow.com/questions/1582356/
 	/// </summary>
-	inline real alphaMaxPlusBetaMedPlusGammaMin(real a, real b, real c)
+	template<typename T>
+	inline T alphaMaxPlusBetaMedPlusGammaMin(T a, T b, T c)
 	{
-		real absA = fabs(a);
-		real absB = fabs(b);
-		real absC = fabs(c);
+		T absA = fabs(a);
+		T absB = fabs(b);
+		T absC = fabs(c);
 
-		real min = std::min(absA, std::min(absB, absC));
-		real max = std::max(absA, std::max(absB, absC));
-		real med = std::max(std::min(absA, absB), std::min(std::max(absA, absB), absC));
+		T min = std::min(absA, std::min(absB, absC));
+		T max = std::max(absA, std::max(absB, absC));
+		T med = std::max(std::min(absA, absB), std::min(std::max(absA, absB), absC));
 
-		return (real)(0.939808635172325 * max + 0.389281482723725 * med + 0.29870618761438 * min);
+		return (T)(0.939808635172325 * max + 0.389281482723725 * med + 0.29870618761438 * min);
 	}
 	//---------------------------------End-Cloth-Simulation-Stuff-----------------------------------
 }
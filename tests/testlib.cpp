@@ -16,9 +16,9 @@
 #include <cstdlib>
 #include <random>
 
-//#include "VPE.hpp"
+#include "VPE.hpp"
 
-//using namespace vpe;
+using namespace vpe;
 
 
 /*
@@ -756,9 +756,1085 @@
 */
 
 //--------------------------------------------------------------------------------------------------
+//behaviour tests, each prints the checks that fail
+
+int g_failures = 0;	//number of failed checks
+
+/// <summary>
+/// Count and report a failed check.
+/// </summary>
+/// <param name="condition">The check passes if this is true.</param>
+/// <param name="test">Name of the test.</param>
+/// <param name="what">Description of the check.</param>
+void check(bool condition, const char* test, const char* what) {
+	if (condition) return;
+	std::cout << test << ": " << what << " failed\n";
+	++g_failures;
+}
 
+/// <summary>
+/// Advance a world in debug mode by a number of simulation steps.
+/// </summary>
+template<typename W>
+void simulate(W& world, int steps) {
+	world.m_mode = W::SIMULATION_MODE_DEBUG;
+	for (int i = 0; i < steps; ++i) {
+		world.m_current_time += world.m_sim_delta_time;
+		world.tick(0.0);
+	}
+}
 
-int main() {
+/// <summary>
+/// Description of a dynamic unit box with mass 1.
+/// </summary>
+template<typename W>
+typename W::BodyDesc boxDesc(uintptr_t owner, typename W::glmvec3 positionW) {
+	typename W::BodyDesc desc;
+	desc.m_owner = (void*)owner;
+	desc.m_positionW = positionW;
+	desc.m_mass_inv = 1;
+	return desc;
+}
+
+/// <summary>
+/// Add bodies and let gravity pull on them.
+/// </summary>
+template<typename W>
+std::vector<std::shared_ptr<typename W::Body>> addFalling(W& world, std::span<const typename W::BodyDesc> descs) {
+	auto bodies = world.addBodies(descs);
+	for (auto& body : bodies) body->setForce(0ul, typename W::Force{ { 0, world.c_gravity, 0 } });
+	return bodies;
+}
+
+/// <summary>
+/// Worlds in float and double precision can be used side by side. A dropped box comes to rest on the ground in both.
+/// </summary>
+template<typename W>
+void testScalarType(const char* test) {
+	W world;
+	std::vector<typename W::BodyDesc> descs{ boxDesc<W>(1, { 0, 2, 0 }) };
+	auto box = addFalling(world, std::span{ descs })[0];
+	simulate(world, 180);
+	check(std::abs(box->m_positionW.y - 0.5) < 0.01, test, "box rests on the ground");
+	check(box->m_sleeping, test, "box falls asleep");
+}
+
+/// <summary>
+/// A stack far away from the origin is moved close to it by rebasing when the focus gets too far away. The absolute 
+/// positions are kept in double, and the stack keeps resting.
+/// </summary>
+void testOriginRebasing() {
+	const char* test = "origin rebasing";
+	VPEWorld world;
+	glmvec3 shifted{ 0 };
+	world.m_on_shift_origin = [&](glmvec3 offset) { shifted += offset; };
+	world.m_origin_rebase_distance = 1000;
+	world.setOriginFocus({ 20000, 0, 0 });
+	std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(1, { 20000, 0.5, 0 }), boxDesc<VPEWorld>(2, { 20000, 1.5, 0 }) };
+	auto bodies = addFalling(world, std::span{ descs });
+	simulate(world, 120);
+	check(world.m_origin == glm::dvec3{ 20000, 0, 0 }, test, "origin moves to the focus");
+	check(shifted == glmvec3{ 20000, 0, 0 }, test, "the owner is told about the shift");
+	check(std::abs(bodies[0]->m_positionW.x) < 0.01 && std::abs(bodies[1]->m_positionW.x) < 0.01, test, "bodies move with the origin");
+	check(std::abs(bodies[1]->m_positionW.y - 1.5) < 0.02, test, "stack keeps resting");
+}
+
+/// <summary>
+/// Bodies created in bulk are registered in order. Erasing in bulk calls the erase callbacks once, also for duplicates, 
+/// and removes the contacts of the erased bodies. The rest of the stack falls down and rests again. 
+/// Erasing by owner and clearing the world leave no bodies or contacts behind.
+/// </summary>
+void testBulkBodies() {
+	const char* test = "bulk bodies";
+	VPEWorld world;
+	int erased = 0;
+	std::vector<VPEWorld::BodyDesc> descs;
+	for (uintptr_t i = 0; i < 6; ++i) {
+		descs.push_back(boxDesc<VPEWorld>(i + 1, { 0, 0.5 + i, 0 }));
+		descs.back().m_on_erase = [&](std::shared_ptr<VPEWorld::Body>) { ++erased; };
+	}
+	auto bodies = addFalling(world, std::span{ descs });
+	bool registered = bodies.size() == descs.size() && world.m_bodies.size() == descs.size();
+	for (size_t i = 0; i < bodies.size(); ++i) registered = registered && world.getBody(descs[i].m_owner) == bodies[i];
+	check(registered, test, "bodies are registered in order");
+	simulate(world, 60);
+
+	std::vector<std::shared_ptr<VPEWorld::Body>> erase{ bodies[1], bodies[3], bodies[1] };
+	world.eraseBodies(erase);
+	check(erased == 2 && world.m_bodies.size() == 4, test, "erasing two bodies, one of them twice");
+	bool dangling = false;
+	for (auto& contact : world.m_contacts) {
+		for (auto* body : { contact.second.m_body_ref.m_body.get(), contact.second.m_body_inc.m_body.get() }) {
+			dangling = dangling || body == bodies[1].get() || body == bodies[3].get();
+		}
+	}
+	check(!dangling, test, "contacts of erased bodies are removed");
+	simulate(world, 180);
+	check(std::abs(bodies[5]->m_positionW.y - 3.5) < 0.05, test, "the rest of the stack falls down and rests");
+
+	world.eraseBody(descs[5].m_owner);
+	check(erased == 3 && world.m_bodies.size() == 3 && !world.m_contacts.contains({ descs[4].m_owner, descs[5].m_owner }), test, "erase by owner");
+	world.clear();
+	simulate(world, 2);
+	check(world.m_bodies.size() == 0 && world.m_contacts.size() == 0 && world.m_active_bodies.empty(), test, "clear");
+}
+
+/// <summary>
+/// Memory resource that counts the bytes allocated from it.
+/// </summary>
+struct CountingResource : std::pmr::memory_resource {
+	size_t m_live{ 0 };	//bytes currently allocated
+
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		m_live += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+		m_live -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+/// <summary>
+/// Bodies and contacts come from the memory resource of the world. Creating, simulating and erasing the same stacks 
+/// again reuses the pooled memory instead of growing, and all memory is returned when the world is destroyed.
+/// </summary>
+void testPooledAllocation() {
+	const char* test = "pooled allocation";
+	CountingResource resource;
+	{
+		VPEWorld world{ &resource };
+		std::vector<size_t> live;
+		for (int cycle = 0; cycle < 3; ++cycle) {
+			std::vector<VPEWorld::BodyDesc> descs;
+			for (uintptr_t i = 0; i < 50; ++i) descs.push_back(boxDesc<VPEWorld>(i + 1, { (real)(i % 5) * 1.01, 0.5 + (real)(i / 5), 0 }));
+			auto bodies = addFalling(world, std::span{ descs });
+			simulate(world, 30);
+			world.eraseBodies(bodies);
+			live.push_back(resource.m_live);
+		}
+		check(live[0] > 0, test, "the world allocates from its resource");
+		check(live[2] <= live[0], test, "memory is reused");
+	}
+	check(resource.m_live == 0, test, "all memory is returned");
+}
+
+/// <summary>
+/// The closed form inverse and the composition of rigid transforms with non uniform scale agree with generic 4x4 matrices, 
+/// and transformed normals stay perpendicular to transformed tangents.
+/// </summary>
+void testTransform() {
+	const char* test = "transform";
+	using W = BasicVPEWorld<double>;
+	using Transform = W::Transform;
+	std::mt19937 rnd_gen{ 1 };
+	std::uniform_real_distribution<double> rnd_unif{ -1.0, 1.0 };
+	auto rnd_vec = [&]() { return glm::dvec3{ rnd_unif(rnd_gen), rnd_unif(rnd_gen), rnd_unif(rnd_gen) }; };
+	auto rnd_transform = [&]() {
+		glm::dquat orient = glm::angleAxis(3.0 * rnd_unif(rnd_gen), glm::normalize(rnd_vec()));
+		return Transform::fromTRS(10.0 * rnd_vec(), orient, 1.5 + rnd_vec());
+	};
+	auto close = [](const glm::dmat4& a, const glm::dmat4& b) {
+		for (int i = 0; i < 4; ++i) if (glm::length(a[i] - b[i]) > 1.0e-9 * (1.0 + glm::length(b[i]))) return false;
+		return true;
+	};
+
+	bool inverse = true, compose = true, normals = true;
+	for (int i = 0; i < 100; ++i) {
+		Transform a = rnd_transform(), b = rnd_transform();
+		glm::dvec3 p = rnd_vec();
+		inverse = inverse && close(a.inverse().matrix(), glm::inverse(a.matrix())) && glm::length(a.inverse().point(a.point(p)) - p) < 1.0e-9;
+		compose = compose && close((a * b).matrix(), a.matrix() * b.matrix()) && close(glm::dmat4{ (a * b).m_normal }, glm::dmat4{ glm::transpose(glm::inverse((a * b).m_linear)) });
+		glm::dvec3 n = glm::normalize(rnd_vec());
+		glm::dvec3 t = glm::cross(n, rnd_vec());
+		normals = normals && std::abs(glm::dot(a.normal(n), a.vector(t))) < 1.0e-9;
+	}
+	check(inverse, test, "inverse");
+	check(compose, test, "composition");
+	check(normals, test, "normals");
+}
+
+/// <summary>
+/// Check that the active body list holds exactly the bodies that are awake, each at its index.
+/// </summary>
+bool activeListConsistent(VPEWorld& world) {
+	size_t awake = 0;
+	for (auto& body : world.m_bodies) {
+		if (!world.isAwake(body.second.get())) continue;
+		++awake;
+		auto idx = body.second->m_active_idx;
+		if (idx >= world.m_active_bodies.size() || world.m_active_bodies[idx] != body.second.get()) return false;
+	}
+	return awake == world.m_active_bodies.size();
+}
+
+/// <summary>
+/// Resting bodies fall asleep and leave the active list, so they are not moved. Applying a force wakes a body again.
+/// </summary>
+void testActiveBodies() {
+	const char* test = "active bodies";
+	VPEWorld world;
+	std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(1, { 0, 0.5, 0 }), boxDesc<VPEWorld>(2, { 5, 0.5, 0 }), boxDesc<VPEWorld>(3, { 10, 3, 0 }) };
+	auto bodies = addFalling(world, std::span{ descs });
+	bool consistent = true;
+	for (int i = 0; i < 12; ++i) {
+		simulate(world, 10);
+		consistent = consistent && activeListConsistent(world);
+	}
+	check(world.m_active_bodies.empty(), test, "resting bodies fall asleep");
+	auto positionW = bodies[0]->m_positionW;
+	simulate(world, 10);
+	check(bodies[0]->m_positionW == positionW, test, "sleeping bodies do not move");
+
+	bodies[1]->setForce(1ul, VPEWorld::Force{ { 0, -world.c_gravity * 3, 0 } });
+	simulate(world, 20);
+	consistent = consistent && activeListConsistent(world);
+	check(world.isAwake(bodies[1].get()) && !world.isAwake(bodies[0].get()), test, "a force wakes only its body");
+	check(bodies[1]->m_positionW.y > 1.0, test, "the woken body moves");
+	check(consistent, test, "active list holds the awake bodies");
+}
+
+/// <summary>
+/// Moving bodies write their interpolated transform into their slot of the output buffer, and the dirty list names 
+/// each written slot once. Bodies that fell asleep are written once more at their final pose, then not again.
+/// Slots of erased bodies are reused.
+/// </summary>
+void testTransformOutput() {
+	const char* test = "transform output";
+	VPEWorld world;
+	world.m_mode = VPEWorld::SIMULATION_MODE_DEBUG;
+	std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(1, { 0, 0.5, 0 }), boxDesc<VPEWorld>(2, { 5, 4, 0 }) };
+	auto bodies = addFalling(world, std::span{ descs });
+	std::vector<glmmat4> buffer(world.numSlots());
+	world.setTransformBuffer(buffer);
+
+	bool unique = true, between = true, final_pose = true;
+	for (int i = 0; i < 200; ++i) {
+		world.m_current_time += world.m_sim_delta_time;
+		world.tick(0.0);
+		auto dirty = world.m_dirty_slots;
+		std::ranges::sort(dirty);
+		unique = unique && std::ranges::adjacent_find(dirty) == dirty.end();
+		for (auto slot : world.m_dirty_slots) {
+			auto* body = world.m_slot_bodies[slot];
+			real y = buffer[slot][3].y;
+			between = between && y >= std::min(body->m_prev_positionW.y, body->m_positionW.y) - 1.0e-5 
+				&& y <= std::max(body->m_prev_positionW.y, body->m_positionW.y) + 1.0e-5;
+			if (body->m_sleeping) final_pose = final_pose && glmvec3{ buffer[slot][3] } == body->m_positionW;
+		}
+	}
+	check(unique, test, "dirty slots are unique");
+	check(between, test, "written transforms are interpolated");
+	check(final_pose, test, "sleeping bodies are written at their final pose");
+	simulate(world, 1);
+	check(world.m_active_bodies.empty() && world.m_dirty_slots.empty(), test, "sleeping bodies are not written again");
+
+	auto slot = bodies[1]->m_slot;
+	world.eraseBody(bodies[1]);
+	std::vector<VPEWorld::BodyDesc> more{ boxDesc<VPEWorld>(3, { -5, 0.5, 0 }) };
+	auto added = world.addBodies(more);
+	check(added[0]->m_slot == slot && world.numSlots() == 2, test, "slots are reused");
+}
 
-	return 0;
+/// <summary>
+/// A box that lands, rests and is lifted off again reports one begin event, persist events while it rests, and one end event.
+/// A box that only wants begin events gets no other events.
+/// </summary>
+void testContactEvents() {
+	const char* test = "contact events";
+	VPEWorld world;
+	std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(1, { 0, 1, 0 }), boxDesc<VPEWorld>(2, { 5, 1, 0 }) };
+	auto bodies = addFalling(world, std::span{ descs });
+	bodies[0]->m_event_flags = VPEWorld::CONTACT_EVENT_ALL;
+	bodies[1]->m_event_flags = VPEWorld::CONTACT_EVENT_BEGIN;
+
+	std::vector<VPEWorld::ContactEvent> events;
+	auto run = [&](int steps) {
+		for (int i = 0; i < steps; ++i) {
+			simulate(world, 1);
+			events.insert(events.end(), world.m_contact_events.begin(), world.m_contact_events.end());
+		}
+	};
+	run(60);
+	bodies[0]->setForce(1ul, VPEWorld::Force{ { 0, -world.c_gravity * 3, 0 } });
+	bodies[1]->setForce(1ul, VPEWorld::Force{ { 0, -world.c_gravity * 3, 0 } });
+	run(30);
+
+	std::vector<VPEWorld::contact_event_flags_t> types[2];
+	bool landed = true;
+	for (auto& event : events) {
+		int b = event.m_body_ref == bodies[1] || event.m_body_inc == bodies[1] ? 1 : 0;
+		types[b].push_back(event.m_type);
+		if (event.m_type == VPEWorld::CONTACT_EVENT_BEGIN) landed = landed && event.m_impulse > 0 && std::abs(event.m_normalW.y) > 0.99 && event.m_positionW.y < 0.1;
+	}
+	auto count = [&](int b, auto type) { return std::ranges::count(types[b], type); };
+	check(!types[0].empty() && types[0].front() == VPEWorld::CONTACT_EVENT_BEGIN && types[0].back() == VPEWorld::CONTACT_EVENT_END, test, "begin first, end last");
+	check(count(0, VPEWorld::CONTACT_EVENT_BEGIN) == 1 && count(0, VPEWorld::CONTACT_EVENT_END) == 1 && count(0, VPEWorld::CONTACT_EVENT_PERSIST) > 10, test, "one begin, persists, one end");
+	check(landed, test, "begin events carry the landing");
+	check(count(1, VPEWorld::CONTACT_EVENT_BEGIN) == 1 && types[1].size() == 1, test, "only the wanted events");
+}
+
+/// <summary>
+/// Add static boxes, spheres and capsules with random poses, spread over many broadphase cells.
+/// </summary>
+std::vector<std::shared_ptr<VPEWorld::Body>> addScattered(VPEWorld& world, int num, std::mt19937& rnd_gen) {
+	std::uniform_real_distribution<real> rnd_unif{ -1.0, 1.0 };
+	std::vector<VPEWorld::BodyDesc> descs;
+	for (int i = 0; i < num; ++i) {
+		VPEWorld::BodyDesc desc;
+		desc.m_owner = (void*)(uintptr_t)(1000 + i);
+		desc.m_collider = i % 3 == 0 ? (VPEWorld::Collider*)&VPEWorld::g_cube : i % 3 == 1 ? (VPEWorld::Collider*)&VPEWorld::g_sphere : &VPEWorld::g_capsule;
+		desc.m_scale = i % 3 == 0 ? glmvec3{ (real)1.2 + rnd_unif(rnd_gen), (real)1.2 + rnd_unif(rnd_gen), (real)1.2 + rnd_unif(rnd_gen) } : glmvec3{ (real)1.5 + rnd_unif(rnd_gen) };
+		desc.m_positionW = { 40 * rnd_unif(rnd_gen), 3 + 3 * rnd_unif(rnd_gen), 40 * rnd_unif(rnd_gen) };
+		desc.m_orientationLW = glm::angleAxis(3 * rnd_unif(rnd_gen), glm::normalize(glmvec3{ rnd_unif(rnd_gen), rnd_unif(rnd_gen), rnd_unif(rnd_gen) }));
+		descs.push_back(desc);
+	}
+	return world.addBodies(descs);
+}
+
+/// <summary>
+/// Random rays through the region of addScattered(), including vertical rays and rays with a very large range.
+/// </summary>
+std::vector<VPEWorld::Ray> scatteredRays(int num, std::mt19937& rnd_gen) {
+	std::uniform_real_distribution<real> rnd_unif{ -1.0, 1.0 };
+	std::vector<VPEWorld::Ray> rays;
+	for (int i = 0; i < num; ++i) {
+		VPEWorld::Ray ray;
+		ray.m_originW = { 45 * rnd_unif(rnd_gen), 4 + 4 * rnd_unif(rnd_gen), 45 * rnd_unif(rnd_gen) };
+		ray.m_dirW = i % 10 == 0 ? glmvec3{ 0, -1, 0 } : glmvec3{ rnd_unif(rnd_gen), 0.3 * rnd_unif(rnd_gen), rnd_unif(rnd_gen) };
+		ray.m_max_dist = i % 7 == 0 ? (real)1.0e6 : 60;
+		rays.push_back(ray);
+	}
+	return rays;
+}
+
+/// <summary>
+/// Closest hit of a ray, found by testing the ground and every body.
+/// </summary>
+VPEWorld::RaycastHit raycastBruteForce(VPEWorld& world, const VPEWorld::Ray& ray, const VPEWorld::raycast_filter& filter = nullptr) {
+	VPEWorld::RaycastHit hit{};
+	hit.m_distance = ray.m_max_dist;
+	glmvec3 dirW = glm::normalize(ray.m_dirW);
+	world.raycastBody(world.m_ground, ray.m_originW, dirW, hit);
+	for (auto& body : world.m_bodies) {
+		if (!filter || filter(*body.second)) world.raycastBody(body.second, ray.m_originW, dirW, hit);
+	}
+	return hit;
+}
+
+/// <summary>
+/// Two hits are the same if they hit the same body at the same distance.
+/// </summary>
+bool sameHit(const VPEWorld::RaycastHit& a, const VPEWorld::RaycastHit& b) {
+	return a.m_body == b.m_body && (!a.m_body || std::abs(a.m_distance - b.m_distance) < 1.0e-4 * (1 + a.m_distance));
+}
+
+/// <summary>
+/// The ray cast that walks the broadphase grid finds the same closest hit as testing all bodies.
+/// </summary>
+void testRaycast() {
+	const char* test = "raycast";
+	VPEWorld world;
+	std::mt19937 rnd_gen{ 2 };
+	addScattered(world, 300, rnd_gen);
+	int hits = 0;
+	bool same = true;
+	for (auto& ray : scatteredRays(1000, rnd_gen)) {
+		auto hit = world.raycast(ray.m_originW, ray.m_dirW, ray.m_max_dist);
+		same = same && sameHit(hit, raycastBruteForce(world, ray));
+		hits += hit.m_body && hit.m_body != world.m_ground;
+	}
+	check(same, test, "same hits as brute force");
+	check(hits > 100, test, "rays hit bodies");
+
+	VPEWorld::RaycastHit down = world.raycast({ 100, 5, 100 }, { 0, -1, 0 }, 100);
+	check(down.m_body == world.m_ground && std::abs(down.m_distance - 5) < 1.0e-4 && down.m_normalW.y > 0.99, test, "ground");
+}
+
+/// <summary>
+/// Batched ray casts on several threads give the same hits as single ray casts, also with a filter.
+/// </summary>
+void testRaycastBatch() {
+	const char* test = "raycast batch";
+	VPEWorld world;
+	std::mt19937 rnd_gen{ 3 };
+	addScattered(world, 300, rnd_gen);
+	auto rays = scatteredRays(1000, rnd_gen);
+	VPEWorld::raycast_filter no_spheres = [](const VPEWorld::Body& body) { return body.m_collider->m_shape != VPEWorld::SHAPE_SPHERE; };
+
+	std::vector<VPEWorld::RaycastHit> hits(rays.size()), filtered(rays.size());
+	world.raycastBatch(rays, hits, nullptr, 4);
+	world.raycastBatch(rays, filtered, no_spheres, 3);
+	bool same = true, same_filtered = true, spheres = false;
+	for (size_t i = 0; i < rays.size(); ++i) {
+		same = same && sameHit(hits[i], world.raycast(rays[i].m_originW, rays[i].m_dirW, rays[i].m_max_dist));
+		same_filtered = same_filtered && sameHit(filtered[i], raycastBruteForce(world, rays[i], no_spheres));
+		spheres = spheres || (filtered[i].m_body && filtered[i].m_body->m_collider->m_shape == VPEWorld::SHAPE_SPHERE);
+	}
+	check(same, test, "same hits as single ray casts");
+	check(same_filtered && !spheres, test, "filter");
+}
+
+/// <summary>
+/// Distance between a sphere and a box, sphere or capsule body, computed directly from the body pose. Negative if they overlap.
+/// </summary>
+real sphereDistance(VPEWorld& world, const VPEWorld::Body& body, glmvec3 centerW, real radius) {
+	if (body.m_polytope) {	//closest point of the box in its rotated frame
+		glmvec3 half = (real)0.5 * body.m_scale;
+		glmvec3 local = glm::inverse(body.m_orientationLW) * (centerW - body.m_positionW);
+		return glm::length(local - glm::clamp(local, -half, half)) - radius;
+	}
+	auto core = body.roundCore(body.m_model);
+	return glm::length(centerW - world.closestPointSegment(centerW, core.m_aW, core.m_bW)) - core.m_radius - radius;
+}
+
+/// <summary>
+/// Sphere queries find exactly the bodies that overlap the sphere. Box queries find the same bodies as testing all bodies.
+/// A buffer that is too small gets the first results, and the count of all results is returned.
+/// </summary>
+void testOverlapQueries() {
+	const char* test = "overlap queries";
+	VPEWorld world;
+	std::mt19937 rnd_gen{ 4 };
+	std::uniform_real_distribution<real> rnd_unif{ -1.0, 1.0 };
+	addScattered(world, 300, rnd_gen);
+	std::vector<std::shared_ptr<VPEWorld::Body>> result(300);
+
+	bool spheres = true, boxes = true;
+	size_t found = 0;
+	for (int i = 0; i < 300; ++i) {
+		glmvec3 centerW{ 45 * rnd_unif(rnd_gen), 3 + 3 * rnd_unif(rnd_gen), 45 * rnd_unif(rnd_gen) };
+		real radius = 3.5 + 2.5 * rnd_unif(rnd_gen);
+		size_t num = world.overlapSphere(centerW, radius, result);
+		found += num;
+		for (auto& body : world.m_bodies) {
+			real dist = sphereDistance(world, *body.second, centerW, radius);
+			if (std::abs(dist) < 1.0e-3) continue;
+			bool reported = std::find(result.begin(), result.begin() + num, body.second) != result.begin() + num;
+			spheres = spheres && reported == (dist < 0);
+		}
+
+		glmvec3 half_extents{ 3 + 2 * rnd_unif(rnd_gen), 3 + 2 * rnd_unif(rnd_gen), 3 + 2 * rnd_unif(rnd_gen) };
+		glmquat orientationLW = glm::angleAxis(3 * rnd_unif(rnd_gen), glm::normalize(glmvec3{ rnd_unif(rnd_gen), rnd_unif(rnd_gen), rnd_unif(rnd_gen) }));
+		num = world.overlapBox(centerW, half_extents, orientationLW, result);
+		auto model = VPEWorld::Transform::fromTRS(centerW, orientationLW, (real)2.0 * half_extents);
+		size_t expected = 0;
+		for (auto& body : world.m_bodies) {
+			auto& b = *body.second;
+			bool overlap = b.m_polytope ? world.overlapPolytopes(VPEWorld::g_cube, model, *b.m_polytope, b.m_model)
+				: world.separation(VPEWorld::g_cube, model, b.roundCore(b.m_model)) <= 0;
+			expected += overlap;
+			boxes = boxes && overlap == (std::find(result.begin(), result.begin() + num, body.second) != result.begin() + num);
+		}
+		boxes = boxes && num == expected;
+	}
+	check(spheres && found > 300, test, "sphere queries find the overlapping bodies");
+	check(boxes, test, "box queries find the same bodies as testing all bodies");
+
+	std::vector<std::shared_ptr<VPEWorld::Body>> small(2);
+	size_t num = world.overlapSphere({ 0, 3, 0 }, 30, result);
+	check(world.overlapSphere({ 0, 3, 0 }, 30, small) == num && num > 2 && small[0] == result[0] && small[1] == result[1], test, "small buffer");
+}
+
+/// <summary>
+/// Fast boxes and spheres with CCD hit a thin wall instead of passing through it. Without CCD they pass through.
+/// A fast box falling onto the ground with CCD stops on the ground.
+/// </summary>
+void testContinuousCollision() {
+	const char* test = "continuous collision";
+	auto shoot = [](bool ccd, VPEWorld::Collider* collider) {
+		VPEWorld world;
+		VPEWorld::BodyDesc wall;
+		wall.m_owner = (void*)1;
+		wall.m_scale = { 0.1, 4, 4 };
+		wall.m_positionW = { 0, 2, 0 };
+		VPEWorld::BodyDesc projectile = boxDesc<VPEWorld>(2, { -3, 2, 0 });
+		projectile.m_collider = collider;
+		projectile.m_scale = glmvec3{ 0.3 };
+		projectile.m_linear_velocityW = { 300, 0, 0 };
+		projectile.m_ccd = ccd;
+		std::vector<VPEWorld::BodyDesc> descs{ wall, projectile };
+		auto bodies = world.addBodies(descs);
+		simulate(world, 30);
+		return bodies[1]->m_positionW.x;
+	};
+	check(shoot(true, &VPEWorld::g_cube) < 0 && shoot(true, &VPEWorld::g_sphere) < 0, test, "CCD bodies hit the wall");
+	check(shoot(false, &VPEWorld::g_cube) > 0 && shoot(false, &VPEWorld::g_sphere) > 0, test, "bodies without CCD pass through");
+
+	VPEWorld world;
+	VPEWorld::BodyDesc desc = boxDesc<VPEWorld>(1, { 0, 30, 0 });
+	desc.m_linear_velocityW = { 0, -400, 0 };
+	desc.m_ccd = true;
+	std::vector<VPEWorld::BodyDesc> descs{ desc };
+	auto box = addFalling(world, std::span{ descs })[0];
+	simulate(world, 120);
+	check(std::abs(box->m_positionW.y - 0.5) < 0.02, test, "fast box stops on the ground");
+}
+
+/// <summary>
+/// A tall stack solved with substeps stays upright and settles, and a heavy box on a light one does not sink into it.
+/// </summary>
+void testSubsteps() {
+	const char* test = "substeps";
+	VPEWorld world;
+	world.m_substeps = 8;
+	std::vector<VPEWorld::BodyDesc> descs;
+	for (int i = 0; i < 10; ++i) descs.push_back(boxDesc<VPEWorld>(1 + i, { 0, 0.5 + 1.01 * i, 0 }));
+	descs.push_back(boxDesc<VPEWorld>(20, { 5, 0.5, 0 }));
+	descs.push_back(boxDesc<VPEWorld>(21, { 5, 1.5, 0 }));
+	descs.back().m_mass_inv = 0.01;
+	auto bodies = addFalling(world, std::span{ descs });
+	simulate(world, 300);
+
+	bool upright = true, settled = true;
+	for (int i = 0; i < 10; ++i) {
+		upright = upright && std::abs(bodies[i]->m_positionW.y - (0.5 + i)) < 0.05 && std::abs(bodies[i]->m_positionW.x) < 0.05 && std::abs(bodies[i]->m_positionW.z) < 0.05;
+		settled = settled && glm::length(bodies[i]->m_linear_velocityW) < 0.1 && glm::length(bodies[i]->m_angular_velocityW) < 0.1;
+	}
+	check(upright, test, "stack stays upright");
+	check(settled, test, "stack settles");
+	check(std::abs(bodies[11]->m_positionW.y - 1.5) < 0.05, test, "heavy box on a light box");
+}
+
+/// <summary>
+/// The contact points between two resting boxes keep their feature IDs from step to step. Warm starting the persistent 
+/// points lets a stack stand with few solver loops, and without warm starting it falls over.
+/// </summary>
+void testWarmStart() {
+	const char* test = "warm start";
+	auto stack = [&](int warmstart, bool check_ids) {
+		VPEWorld world;
+		world.m_use_warmstart = warmstart;
+		world.m_loops = 8;
+		std::vector<VPEWorld::BodyDesc> descs;
+		for (int i = 0; i < 8; ++i) descs.push_back(boxDesc<VPEWorld>(1 + i, { 0, 0.5 + 1.01 * i, 0 }));
+		auto bodies = addFalling(world, std::span{ descs });
+
+		simulate(world, 30);
+		std::vector<uint64_t> ids, last_ids;
+		bool same = true;
+		for (int i = 0; i < 30; ++i) {
+			simulate(world, 1);
+			ids.clear();
+			for (auto& c : world.m_contacts) {
+				if (c.first != std::pair{ (void*)1, (void*)2 } && c.first != std::pair{ (void*)2, (void*)1 }) continue;
+				for (auto& cp : c.second.m_contact_points) ids.push_back(cp.m_id);
+			}
+			std::ranges::sort(ids);
+			same = same && ids.size() == 4 && std::ranges::adjacent_find(ids) == ids.end() && (i == 0 || ids == last_ids);
+			last_ids = ids;
+		}
+		if (check_ids) check(same, test, "feature IDs persist");
+		simulate(world, 240);
+		auto& top = bodies.back()->m_positionW;
+		return std::abs(top.y - 7.5) < 0.1 && std::abs(top.x) < 0.2 && std::abs(top.z) < 0.2;
+	};
+	check(stack(1, true), test, "stack stands with warm starting");
+	check(!stack(0, false), test, "stack falls without warm starting");
+}
+
+/// <summary>
+/// With few solver loops, a box on a slope below its friction angle stays in place, and a box on a slope above it slides down.
+/// </summary>
+void testFriction() {
+	const char* test = "friction";
+	auto slide = [](real friction) {
+		VPEWorld world;
+		world.m_use_sleeping = 0;
+		world.m_loops = 4;
+		glmquat tilt = glm::angleAxis(glm::radians((real)35.0), glmvec3{ 0, 0, 1 });
+		VPEWorld::BodyDesc slope;
+		slope.m_owner = (void*)1;
+		slope.m_scale = { 20, 1, 20 };
+		slope.m_positionW = { 0, 5, 0 };
+		slope.m_orientationLW = tilt;
+		VPEWorld::BodyDesc box = boxDesc<VPEWorld>(2, slope.m_positionW + tilt * glmvec3{ 0, 1.05, 0 });
+		box.m_orientationLW = tilt;
+		box.m_friction = friction;
+		std::vector<VPEWorld::BodyDesc> descs{ slope, box };
+		auto bodies = world.addBodies(descs);
+		bodies[1]->setForce(0ul, VPEWorld::Force{ { 0, world.c_gravity, 0 } });
+		simulate(world, 60);
+		glmvec3 positionW = bodies[1]->m_positionW;
+		simulate(world, 300);
+		return glm::length(bodies[1]->m_positionW - positionW);
+	};
+	check(slide(1) < 0.01, test, "box holds below the friction angle");
+	check(slide(0.3) > 1, test, "box slides above the friction angle");
+}
+
+/// <summary>
+/// Spheres and capsules rest on the ground and on boxes at the height of their radius. Two spheres colliding head on
+/// stop touching each other and keep their momentum.
+/// </summary>
+void testRoundShapes() {
+	const char* test = "round shapes";
+	VPEWorld world;
+	VPEWorld::BodyDesc table;
+	table.m_owner = (void*)1;
+	table.m_scale = { 4, 1, 4 };
+	table.m_positionW = { 10, 0.5, 0 };
+	std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(2, { 0, 2, 0 }), boxDesc<VPEWorld>(3, { 3, 2, 0 }), boxDesc<VPEWorld>(4, { 10, 3, 0 }), boxDesc<VPEWorld>(5, { 10, 3, 1.5 }) };
+	descs[0].m_collider = &VPEWorld::g_sphere;
+	descs[0].m_scale = glmvec3{ 2 };
+	descs[1].m_collider = &VPEWorld::g_capsule;
+	descs[1].m_orientationLW = glm::angleAxis(glm::radians((real)90.0), glmvec3{ 0, 0, 1 });
+	descs[2].m_collider = &VPEWorld::g_sphere;
+	descs[3].m_collider = &VPEWorld::g_capsule;
+	descs[3].m_orientationLW = glm::angleAxis(glm::radians((real)90.0), glmvec3{ 1, 0, 0 });
+	world.addBodies(std::span{ &table, 1 });
+	auto bodies = addFalling(world, std::span{ descs });
+	simulate(world, 180);
+	check(std::abs(bodies[0]->m_positionW.y - 1) < 0.02, test, "sphere rests on the ground");
+	check(std::abs(bodies[1]->m_positionW.y - 0.5) < 0.02, test, "lying capsule rests on the ground");
+	check(std::abs(bodies[2]->m_positionW.y - 1.5) < 0.02, test, "sphere rests on a box");
+	check(std::abs(bodies[3]->m_positionW.y - 1.5) < 0.02, test, "lying capsule rests on a box");
+
+	std::vector<VPEWorld::BodyDesc> balls{ boxDesc<VPEWorld>(6, { -2, 5, 20 }), boxDesc<VPEWorld>(7, { 2, 5, 20 }) };
+	for (auto& ball : balls) ball.m_collider = &VPEWorld::g_sphere;
+	balls[0].m_linear_velocityW = { 3, 0, 0 };
+	balls[1].m_linear_velocityW = { -3, 0, 0 };
+	auto spheres = world.addBodies(balls);
+	simulate(world, 60);
+	glmvec3 momentum = spheres[0]->m_linear_velocityW + spheres[1]->m_linear_velocityW;
+	real gap = spheres[1]->m_positionW.x - spheres[0]->m_positionW.x;
+	check(gap > 0.99 && gap < 1.02, test, "spheres stop touching");
+	check(glm::length(momentum) < 0.01, test, "spheres keep their momentum");
+}
+
+/// <summary>
+/// True if all points lie inside a polytope or on its surface. The points are given in the coordinates the polytope was built from.
+/// </summary>
+bool containsPoints(const VPEWorld::Polytope& polytope, const std::vector<glmvec3>& points, real eps) {
+	for (auto& face : polytope.m_faces) {
+		for (auto& p : points) {
+			if (glm::dot(face.m_normalL, p - polytope.m_center_of_massL - face.m_face_vertex_ptrs[0]->m_positionL) > eps) return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// The hull of the corners of a box and points inside it is the box, with the volume, center of mass and inertia tensor of the box.
+/// Random clouds give hulls that contain all points. Clouds that cannot enclose a volume are rejected.
+/// </summary>
+void testConvexHull() {
+	const char* test = "convex hull";
+	std::mt19937 rnd_gen{ 5 };
+	std::uniform_real_distribution<real> rnd_unif{ -1.0, 1.0 };
+	glmvec3 centerL{ 3, 1, -2 }, size{ 2, 1, 4 };
+	std::vector<glmvec3> points;
+	for (int i = 0; i < 8; ++i) points.push_back(centerL + (real)0.5 * size * glmvec3{ i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1 });
+	for (int i = 0; i < 100; ++i) points.push_back(centerL + (real)0.49 * size * glmvec3{ rnd_unif(rnd_gen), rnd_unif(rnd_gen), rnd_unif(rnd_gen) });
+	std::shuffle(points.begin(), points.end(), rnd_gen);
+
+	auto box = VPEWorld::Polytope::fromPointCloud(points);
+	check(box.m_vertices.size() == 8 && box.m_faces.size() == 6 && box.m_edges.size() == 12, test, "box topology");
+	check(std::abs(box.m_volume - 8) < 1.0e-4 && glm::length(box.m_center_of_massL - centerL) < 1.0e-5, test, "box volume and center of mass");
+	glmvec3 scale{ 1 };
+	glmmat3 inertia = box.inertiaTensor(12, scale);
+	glmmat3 expected{ { 1 + 16, 0, 0 }, { 0, 4 + 16, 0 }, { 0, 0, 4 + 1 } };
+	bool same = true;
+	for (int c = 0; c < 3; ++c) same = same && glm::length(inertia[c] - expected[c]) < 1.0e-3;
+	check(same, test, "box inertia tensor");
+	check(containsPoints(box, points, 1.0e-5), test, "box contains the points");
+
+	bool contained = true;
+	for (int n = 0; n < 20; ++n) {
+		std::vector<glmvec3> cloud;
+		for (int i = 0; i < 200; ++i) cloud.push_back(glmvec3{ rnd_unif(rnd_gen), rnd_unif(rnd_gen), rnd_unif(rnd_gen) } * glmvec3{ 1, 2, 3 });
+		auto hull = VPEWorld::Polytope::fromPointCloud(cloud);
+		contained = contained && hull.m_volume > 0 && hull.m_volume < 48 && containsPoints(hull, cloud, 1.0e-4);
+	}
+	check(contained, test, "random hulls contain their points");
+
+	auto rejected = [](std::vector<glmvec3> cloud) {
+		try { VPEWorld::Polytope::fromPointCloud(cloud); }
+		catch (const std::invalid_argument&) { return true; }
+		return false;
+	};
+	check(rejected({ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } }), test, "too few points");
+	check(rejected({ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 }, { 0.5, 0.5, 0 } }), test, "points in a plane");
+	check(rejected({ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, std::numeric_limits<real>::quiet_NaN() } }), test, "point not finite");
+	check(rejected({ { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } }), test, "points in one place");
+}
+
+/// <summary>
+/// Coplanar triangles of a hull are merged into polygons, and points on its edges and close duplicates are dropped.
+/// A face budget or merge angle gives fewer faces, and the hull still contains all points.
+/// </summary>
+void testHullSimplification() {
+	const char* test = "hull simplification";
+	std::mt19937 rnd_gen{ 6 };
+	std::uniform_real_distribution<real> rnd_unif{ -1.0, 1.0 };
+	std::vector<glmvec3> grid;	//points on the surface of a cube, including edges and corners
+	for (int x = 0; x <= 4; ++x) for (int y = 0; y <= 4; ++y) for (int z = 0; z <= 4; ++z) {
+		if (x % 4 == 0 || y % 4 == 0 || z % 4 == 0) grid.push_back(glmvec3{ x, y, z } / (real)4.0);
+	}
+	auto cube = VPEWorld::Polytope::fromPointCloud(grid);
+	check(cube.m_vertices.size() == 8 && cube.m_faces.size() == 6 && cube.m_edges.size() == 12, test, "coplanar faces are merged");
+
+	std::vector<glmvec3> jittered = grid;
+	for (auto& p : grid) jittered.push_back(p + (real)1.0e-4 * glmvec3{ rnd_unif(rnd_gen), rnd_unif(rnd_gen), rnd_unif(rnd_gen) });
+	auto welded = VPEWorld::Polytope::fromPointCloud(jittered, { .m_weld_distance = 1.0e-3 });
+	check(welded.m_vertices.size() == 8 && welded.m_faces.size() == 6, test, "close points are welded");
+
+	std::vector<glmvec3> sphere;
+	for (int i = 0; i < 500; ++i) sphere.push_back(glm::normalize(glmvec3{ rnd_unif(rnd_gen), rnd_unif(rnd_gen), rnd_unif(rnd_gen) }));
+	auto full = VPEWorld::Polytope::fromPointCloud(sphere);
+	auto budget = VPEWorld::Polytope::fromPointCloud(sphere, { .m_max_faces = 40 });
+	auto angle = VPEWorld::Polytope::fromPointCloud(sphere, { .m_merge_angle = 0.3 });
+	check(full.m_faces.size() > 400 && budget.m_faces.size() <= 40 && angle.m_faces.size() < full.m_faces.size() / 4, test, "fewer faces");
+	check(containsPoints(budget, sphere, 1.0e-4) && containsPoints(angle, sphere, 1.0e-4), test, "simplified hulls contain the points");
+	check(budget.m_volume >= full.m_volume && budget.m_volume < 1.5 * full.m_volume, test, "simplified hull stays close");
+}
+
+/// <summary>
+/// A compound puts its center of mass at the local origin and adds up the inertia of its children. A dumbbell made of two 
+/// spheres and a bar rests on its spheres, and queries report the compound body.
+/// </summary>
+void testCompound() {
+	const char* test = "compound";
+	VPEWorld::Compound weights{ { { &VPEWorld::g_sphere, { -1, 0, 0 }, { 1, 0, 0, 0 }, { 1, 1, 1 }, 1 }, { &VPEWorld::g_sphere, { 1, 0, 0 }, { 1, 0, 0, 0 }, { 1, 1, 1 }, 3 } } };
+	glmvec3 scale{ 1 };
+	glmmat3 inertia = weights.inertiaTensor(4, scale);
+	glmmat3 expected{ { 0.4, 0, 0 }, { 0, 3.4, 0 }, { 0, 0, 3.4 } };	//0.4*m*r^2 per sphere, and m*d^2 for the offsets -1.5 and 0.5
+	bool same = true;
+	for (int c = 0; c < 3; ++c) same = same && glm::length(inertia[c] - expected[c]) < 1.0e-4;
+	check(glm::length(weights.m_center_of_massL - glmvec3{ 0.5, 0, 0 }) < 1.0e-5, test, "center of mass");
+	check(same, test, "inertia tensor");
+
+	VPEWorld::Compound dumbbell{ { { &VPEWorld::g_sphere, { -1, 0, 0 } }, { &VPEWorld::g_sphere, { 1, 0, 0 } }, { &VPEWorld::g_cube, { 0, 0, 0 }, { 1, 0, 0, 0 }, { 2, 0.2, 0.2 } } } };
+	VPEWorld world;
+	std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(1, { 0, 2, 0 }) };
+	descs[0].m_collider = &dumbbell;
+	descs[0].m_orientationLW = glm::angleAxis(glm::radians((real)30.0), glmvec3{ 0, 1, 0 });
+	auto body = addFalling(world, std::span{ descs })[0];
+	simulate(world, 180);
+	check(std::abs(body->m_positionW.y - 0.5) < 0.02 && std::abs((body->m_orientationLW * glmvec3{ 1, 0, 0 }).y) < 0.01, test, "dumbbell rests on its spheres");
+
+	auto hit = world.raycast(body->m_positionW + glmvec3{ 0, 5, 0 }, { 0, -1, 0 }, 10);
+	std::vector<std::shared_ptr<VPEWorld::Body>> result(4);
+	check(hit.m_body == body && std::abs(hit.m_positionW.y - 0.6) < 0.01, test, "raycast hits the bar");
+	check(world.overlapSphere(body->m_positionW + body->m_orientationLW * glmvec3{ 1, 0, 0 }, 0.1, result) == 1 && result[0] == body, test, "overlap reports the compound");
+}
+
+/// <summary>
+/// Boxes and spheres rest on a static triangle mesh, and a box sliding over it does not catch on the inner edges. 
+/// Rays and overlap queries find the mesh.
+/// </summary>
+void testTriangleMesh() {
+	const char* test = "triangle mesh";
+	std::vector<glmvec3> positions;
+	std::vector<std::array<uint_t, 3>> triangles;
+	for (int x = 0; x <= 10; ++x) for (int z = 0; z <= 10; ++z) positions.push_back({ 4 * x - 20, 0, 4 * z - 20 });
+	for (uint_t x = 0; x < 10; ++x) for (uint_t z = 0; z < 10; ++z) {
+		uint_t i = x * 11 + z;
+		triangles.push_back({ i, i + 1, i + 12 });
+		triangles.push_back({ i, i + 12, i + 11 });
+	}
+	VPEWorld::TriangleMesh floor{ positions, triangles };
+
+	VPEWorld::BodyDesc mesh;
+	mesh.m_owner = (void*)1;
+	mesh.m_collider = &floor;
+	mesh.m_positionW = { 0, 2, 0 };
+	mesh.m_friction = 0;
+
+	VPEWorld world;
+	auto mesh_body = world.addBodies(std::span{ &mesh, 1 })[0];
+	std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(2, { 2, 4, 2 }), boxDesc<VPEWorld>(3, { -6, 4, 2 }) };
+	descs[1].m_collider = &VPEWorld::g_sphere;
+	auto bodies = addFalling(world, std::span{ descs });
+	simulate(world, 120);
+	check(std::abs(bodies[0]->m_positionW.y - 2.5) < 0.02, test, "box rests on the mesh");
+	check(std::abs(bodies[1]->m_positionW.y - 2.5) < 0.02, test, "sphere rests on the mesh");
+
+	VPEWorld slide_world;	//frictionless, with the separate normal and tangent solver so that the box keeps sliding
+	slide_world.m_solver = 1;
+	slide_world.m_use_sleeping = 0;
+	slide_world.addBodies(std::span{ &mesh, 1 });
+	std::vector<VPEWorld::BodyDesc> slider{ boxDesc<VPEWorld>(2, { -15, 2.5, -6 }) };
+	slider[0].m_friction = 0;
+	slider[0].m_linear_velocityW = { 8, 0, 0 };
+	auto box = addFalling(slide_world, std::span{ slider })[0];
+	real highest = 0, spin = 0;
+	for (int i = 0; i < 90; ++i) {
+		simulate(slide_world, 1);
+		highest = std::max(highest, box->m_positionW.y);
+		spin = std::max(spin, glm::length(box->m_angular_velocityW));
+	}
+	check(box->m_positionW.x > -5 && highest < 2.51 && spin < 0.01, test, "box slides over inner edges");
+
+	auto hit = world.raycast({ 7, 10, -7 }, { 0, -1, 0 }, 20);
+	check(hit.m_body == mesh_body && std::abs(hit.m_positionW.y - 2) < 1.0e-4 && hit.m_normalW.y > 0.999, test, "ray hits the mesh");
+	std::vector<std::shared_ptr<VPEWorld::Body>> result(4);
+	check(world.overlapSphere({ 7, 2.2, -7 }, 0.5, result) == 1 && result[0] == mesh_body, test, "overlap finds the mesh");
+	check(world.overlapSphere({ 7, 3, -7 }, 0.5, result) == 0, test, "overlap misses the mesh");
+}
+
+/// <summary>
+/// GJK/EPA finds the same contact as SAT for two cubes with a gap or overlap, and no contact if the gap is larger than the
+/// collision margin. Stacks of cubes that use GJK and of cylinders with many faces, which select it automatically, come to rest.
+/// </summary>
+void testGJK() {
+	const char* test = "GJK";
+	std::vector<glmvec3> corners;
+	for (int i = 0; i < 8; ++i) corners.push_back((real)0.5 * glmvec3{ i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1 });
+	auto contactPoints = [&](VPEWorld::Polytope::narrow_phase_t narrow_phase, real gap) {
+		auto cube = VPEWorld::Polytope::fromPointCloud(corners);
+		cube.m_narrow_phase = narrow_phase;
+		VPEWorld world;
+		std::vector<VPEWorld::BodyDesc> descs{ boxDesc<VPEWorld>(1, { 0, 5, 0 }), boxDesc<VPEWorld>(2, { 0.2, 6 + gap, 0.1 }) };
+		descs[0].m_mass_inv = 0;
+		descs[1].m_orientationLW = glm::angleAxis((real)0.3, glmvec3{ 0, 1, 0 });
+		for (auto& desc : descs) desc.m_collider = &cube;
+		world.addBodies(descs);
+		simulate(world, 2);
+		std::vector<VPEWorld::Contact::ContactPoint> points;
+		for (auto& c : world.m_contacts) if (c.first == std::pair{ (void*)1, (void*)2 } || c.first == std::pair{ (void*)2, (void*)1 }) points = c.second.m_contact_points;
+		return points;
+	};
+	bool same = true;
+	for (real gap : { 0.003, 0.0, -0.02, -0.1 }) {
+		auto sat = contactPoints(VPEWorld::Polytope::NARROW_PHASE_SAT, gap);
+		auto gjk = contactPoints(VPEWorld::Polytope::NARROW_PHASE_GJK, gap);
+		same = same && gjk.size() == 4 && sat.size() == gjk.size();
+		for (size_t i = 0; same && i < gjk.size(); ++i) {
+			same = std::abs(gjk[i].m_separation - (gap - (real)0.001)) < 1.0e-4 && std::abs(gjk[i].m_separation - sat[i].m_separation) < 1.0e-4
+				&& std::abs(gjk[i].m_normalW.y) > 0.9999 && glm::length(gjk[i].m_positionW - sat[i].m_positionW) < 1.0e-4;
+		}
+	}
+	check(same, test, "same contact as SAT");
+	check(contactPoints(VPEWorld::Polytope::NARROW_PHASE_GJK, 0.02).empty(), test, "no contact beyond the margin");
+
+	auto cube = VPEWorld::Polytope::fromPointCloud(corners);
+	cube.m_narrow_phase = VPEWorld::Polytope::NARROW_PHASE_GJK;
+	std::vector<glmvec3> rim;
+	for (int i = 0; i < 32; ++i) {
+		real angle = 2 * VPEWorld::pi * i / 32;
+		rim.push_back({ std::cos(angle), -0.5, std::sin(angle) });
+		rim.push_back({ std::cos(angle), 0.5, std::sin(angle) });
+	}
+	auto cylinder = VPEWorld::Polytope::fromPointCloud(rim);
+	VPEWorld world;
+	std::vector<VPEWorld::BodyDesc> descs;
+	for (int i = 0; i < 4; ++i) {
+		descs.push_back(boxDesc<VPEWorld>(1 + i, { 0, 0.5 + 1.01 * i, 0 }));
+		descs.back().m_collider = &cube;
+		descs.push_back(boxDesc<VPEWorld>(10 + i, { 5, 0.5 + 1.01 * i, 0 }));
+		descs.back().m_collider = &cylinder;
+	}
+	auto bodies = addFalling(world, std::span{ descs });
+	simulate(world, 240);
+	bool resting = true;
+	for (int i = 0; i < 4; ++i) {
+		resting = resting && std::abs(bodies[2 * i]->m_positionW.y - (0.5 + i)) < 0.05 && std::abs(bodies[2 * i]->m_positionW.x) < 0.05;
+		resting = resting && std::abs(bodies[2 * i + 1]->m_positionW.y - (0.5 + i)) < 0.05 && std::abs(bodies[2 * i + 1]->m_positionW.x - 5) < 0.05;
+	}
+	check(resting, test, "stacks rest");
+}
+
+/// <summary>
+/// A stack whose top box spins moves the same with and without the SAT feature cache, and the cache is used.
+/// </summary>
+void testFeatureCache() {
+	const char* test = "feature cache";
+	VPEWorld worlds[2];
+	worlds[1].m_feature_cache_distance = 0;
+	worlds[1].m_feature_cache_rotation = 0;
+	std::vector<std::shared_ptr<VPEWorld::Body>> bodies[2];
+	for (int w = 0; w < 2; ++w) {
+		std::vector<VPEWorld::BodyDesc> descs;
+		for (int i = 0; i < 4; ++i) {
+			descs.push_back(boxDesc<VPEWorld>(1 + i, { 0, 0.5 + 1.01 * i, 0 }));
+			descs.back().m_orientationLW = glm::angleAxis((real)0.2 * i, glmvec3{ 0, 1, 0 });
+		}
+		descs.back().m_angular_velocityW = { 0, 3, 0 };
+		bodies[w] = addFalling(worlds[w], std::span{ descs });
+	}
+
+	real difference = 0;
+	size_t cached = 0;
+	for (int i = 0; i < 120; ++i) {
+		for (auto& world : worlds) simulate(world, 1);
+		for (int j = 0; j < 4; ++j) difference = std::max(difference, glm::distance(bodies[0][j]->m_positionW, bodies[1][j]->m_positionW));
+		cached += std::ranges::count_if(worlds[0].m_contacts, [](auto& c) { return c.second.m_feature.m_type != VPEWorld::Contact::FeatureCache::FEATURE_NONE; });
+	}
+	check(difference < 1.0e-4, test, "same motion with and without the cache");
+	check(cached > 0, test, "cache is used");
+	check(std::abs(bodies[0][3]->m_positionW.y - 3.5) < 0.02, test, "stack rests");
+}
+
+/// <summary>
+/// A box falls through another box if their categories and masks do not match, or the pair filter rejects them,
+/// and through the ground if its mask excludes the ground. Other boxes stack as usual.
+/// </summary>
+void testCollisionFiltering() {
+	const char* test = "collision filtering";
+	VPEWorld world;
+	world.m_pair_filter = [](const VPEWorld::Body& body0, const VPEWorld::Body& body1) {
+		return !(body0.m_owner == (void*)5 && body1.m_owner == (void*)6) && !(body0.m_owner == (void*)6 && body1.m_owner == (void*)5);
+	};
+	std::vector<VPEWorld::BodyDesc> descs;
+	for (int i = 0; i < 4; ++i) {
+		descs.push_back(boxDesc<VPEWorld>(1 + 2 * i, { 3 * i, 0.5, 0 }));
+		descs.push_back(boxDesc<VPEWorld>(2 + 2 * i, { 3 * i, 1.6, 0 }));
+	}
+	descs[3].m_collision_category = 2;		//the lower box does not collide with category 2
+	descs[2].m_collision_mask = ~2u;
+	descs[7].m_collision_mask = 0;			//collides with nothing, not even the ground
+	auto bodies = addFalling(world, std::span{ descs });
+	simulate(world, 60);
+	check(std::abs(bodies[1]->m_positionW.y - 1.5) < 0.02, test, "boxes stack");
+	check(std::abs(bodies[3]->m_positionW.y - 0.5) < 0.02, test, "category not in the mask");
+	check(std::abs(bodies[5]->m_positionW.y - 0.5) < 0.02, test, "pair filter");
+	check(bodies[7]->m_positionW.y < -2 && std::abs(bodies[6]->m_positionW.y - 0.5) < 0.02, test, "mask excludes the ground");
+}
+
+/// <summary>
+/// Handles of removed constraints become invalid, and their slots are reused with a new generation. The constraints 
+/// that remain keep their bodies and still hold them, and a box whose constraint was removed falls.
+/// </summary>
+void testConstraintHandles() {
+	const char* test = "constraint handles";
+	VPEWorld world;
+	std::vector<VPEWorld::BodyDesc> anchors, boxes;
+	for (int i = 0; i < 4; ++i) {
+		anchors.push_back(boxDesc<VPEWorld>(1 + i, { 3 * i, 8, 0 }));
+		anchors.back().m_mass_inv = 0;
+		boxes.push_back(boxDesc<VPEWorld>(11 + i, { 3 * i + 1, 6, 0 }));
+	}
+	auto fixed = world.addBodies(anchors);
+	auto hanging = addFalling(world, std::span{ boxes });
+	std::vector<VPEWorld::ConstraintHandle> handles;
+	for (int i = 0; i < 3; ++i) handles.push_back(world.addConstraint(VPEWorld::DistanceConstraint(fixed[i], hanging[i], 2)));
+	handles.push_back(world.addConstraint(VPEWorld::HingeJoint(fixed[3], hanging[3], fixed[3]->m_positionW, { 0, 0, 1 })));
+
+	check(world.getConstraint<VPEWorld::HingeJoint>(handles[3]) && !world.getConstraint<VPEWorld::DistanceConstraint>(handles[3]), test, "handles are typed");
+	world.removeConstraint(handles[0]);
+	world.removeConstraint(handles[0]);		//removing twice does nothing
+	auto* second = world.getConstraint<VPEWorld::DistanceConstraint>(handles[1]);
+	auto* third = world.getConstraint<VPEWorld::DistanceConstraint>(handles[2]);
+	check(!world.getConstraint<VPEWorld::DistanceConstraint>(handles[0]), test, "removed handle is invalid");
+	check(second && second->body2() == hanging[1].get() && third && third->body2() == hanging[2].get(), test, "other handles stay valid");
+
+	auto reused = world.addConstraint(VPEWorld::DistanceConstraint(fixed[0], hanging[0], 3));
+	check(reused.m_slot == handles[0].m_slot && reused.m_generation != handles[0].m_generation, test, "slot is reused");
+	check(!world.getConstraint<VPEWorld::DistanceConstraint>(handles[0]) && world.getConstraint<VPEWorld::DistanceConstraint>(reused), test, "old handle stays invalid");
+	world.removeConstraint(reused);
+
+	simulate(world, 120);
+	check(hanging[0]->m_positionW.y < 1, test, "box falls without its constraint");
+	bool held = true;
+	for (int i = 1; i < 3; ++i) held = held && std::abs(glm::distance(fixed[i]->m_positionW, hanging[i]->m_positionW) - 2) < 0.05;
+	check(held, test, "distance constraints hold");
+	check(std::abs(glm::distance(fixed[3]->m_positionW, hanging[3]->m_positionW) - std::sqrt((real)5.0)) < 0.05 && std::abs(hanging[3]->m_positionW.z) < 0.01, test, "hinge holds");
+}
+
+/// <summary>
+/// True if the contacts and constraints of each body are exactly those of the world that involve the body, 
+/// and each contact knows its index in the lists of its bodies.
+/// </summary>
+bool adjacencyConsistent(VPEWorld& world) {
+	std::vector<std::shared_ptr<VPEWorld::Body>> bodies{ world.m_ground };
+	for (auto& body : world.m_bodies) bodies.push_back(body.second);
+	size_t num_contacts = 0, num_constraints = 0;
+	for (auto& body : bodies) {
+		auto& contacts = world.bodyContacts(body);
+		for (size_t i = 0; i < contacts.size(); ++i) {
+			auto it = world.m_contacts.find({ contacts[i]->m_body_ref.m_body->m_owner, contacts[i]->m_body_inc.m_body->m_owner });
+			if (it == world.m_contacts.end() || &it->second != contacts[i]) return false;
+			auto& ptr = contacts[i]->m_body_ref.m_body == body ? contacts[i]->m_body_ref : contacts[i]->m_body_inc;
+			if (ptr.m_body != body || ptr.m_adjacency != i) return false;
+		}
+		for (auto& handle : world.bodyConstraints(body)) {
+			bool found = false;
+			world.forEachConstraint([&](auto& constraint) {
+				auto* c = world.getConstraint<std::remove_cvref_t<decltype(constraint)>>(handle);
+				found = found || (c == &constraint && constraint.containsBody(body));
+			});
+			if (!found) return false;
+		}
+		num_contacts += contacts.size();
+		num_constraints += world.bodyConstraints(body).size();
+	}
+	size_t world_constraints = 0;
+	world.forEachConstraint([&](auto&) { ++world_constraints; });
+	return num_contacts == 2 * world.m_contacts.size() && num_constraints == 2 * world_constraints;
+}
+
+/// <summary>
+/// Contacts and constraints of bodies stay consistent with the world while stacks settle, and when bodies are erased one 
+/// by one, in bulk, or all together. Erasing a body ends its touching contacts, and the box resting on it falls down.
+/// </summary>
+void testAdjacency() {
+	const char* test = "adjacency";
+	VPEWorld world;
+	std::vector<VPEWorld::BodyDesc> descs;
+	for (int s = 0; s < 3; ++s) for (int i = 0; i < 4; ++i) descs.push_back(boxDesc<VPEWorld>(1 + 4 * s + i, { 3 * s, 0.5 + 1.01 * i, 0 }));
+	auto bodies = addFalling(world, std::span{ descs });
+	bodies[0]->m_event_flags = VPEWorld::CONTACT_EVENT_ALL;
+	auto hinge = world.addConstraint(VPEWorld::HingeJoint(bodies[4], bodies[8], { 4.5, 0.5, 0 }, { 0, 0, 1 }));
+	world.addConstraint(VPEWorld::BallSocketJoint(bodies[7], bodies[11], { 4.5, 3.5, 0 }));
+	simulate(world, 60);
+	check(adjacencyConsistent(world) && world.bodyContacts(bodies[1]).size() >= 2 && world.bodyConstraints(bodies[4]).size() == 1, test, "stacks");
+
+	world.eraseBody((void*)2);
+	bool ended = false;
+	simulate(world, 1);
+	for (auto& event : world.m_contact_events) ended = ended || (event.m_type == VPEWorld::CONTACT_EVENT_END && (event.m_body_ref == bodies[1] || event.m_body_inc == bodies[1]));
+	check(ended, test, "erased body ends its contacts");
+	check(adjacencyConsistent(world) && world.bodyContacts(bodies[1]).empty(), test, "eraseBody");
+	simulate(world, 60);
+	check(std::abs(bodies[2]->m_positionW.y - 1.5) < 0.02 && std::abs(bodies[3]->m_positionW.y - 2.5) < 0.02, test, "boxes above fall down");
+
+	world.removeConstraint(hinge);
+	check(adjacencyConsistent(world) && world.bodyConstraints(bodies[4]).empty() && world.bodyConstraints(bodies[8]).empty(), test, "removeConstraint");
+	std::vector<std::shared_ptr<VPEWorld::Body>> erase{ bodies[5], bodies[7], bodies[9] };
+	world.eraseBodies(erase);
+	check(adjacencyConsistent(world) && world.bodyConstraints(bodies[11]).empty() && world.m_bodies.size() == 8, test, "eraseBodies");
+	simulate(world, 60);
+	check(adjacencyConsistent(world), test, "after erasing");
+
+	world.clear();
+	check(world.m_bodies.size() == 0 && world.m_contacts.size() == 0 && adjacencyConsistent(world), test, "clear");
+	std::vector<VPEWorld::BodyDesc> again{ boxDesc<VPEWorld>(1, { 0, 2, 0 }) };
+	auto box = addFalling(world, std::span{ again })[0];
+	simulate(world, 120);
+	check(std::abs(box->m_positionW.y - 0.5) < 0.02 && adjacencyConsistent(world), test, "world is usable after clear");
+}
+
+
+int main() {
+	testScalarType<BasicVPEWorld<float>>("scalar type float");
+	testScalarType<BasicVPEWorld<double>>("scalar type double");
+	testOriginRebasing();
+	testBulkBodies();
+	testPooledAllocation();
+	testTransform();
+	testActiveBodies();
+	testTransformOutput();
+	testContactEvents();
+	testRaycast();
+	testRaycastBatch();
+	testOverlapQueries();
+	testContinuousCollision();
+	testSubsteps();
+	testWarmStart();
+	testFriction();
+	testRoundShapes();
+	testConvexHull();
+	testHullSimplification();
+	testCompound();
+	testTriangleMesh();
+	testGJK();
+	testFeatureCache();
+	testCollisionFiltering();
+	testConstraintHandles();
+	testAdjacency();
+
+	std::cout << (g_failures == 0 ? "all tests passed\n" : "some tests failed\n");
+	return g_failures == 0 ? 0 : 1;
 }